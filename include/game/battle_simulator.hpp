@@ -1,5 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
 #include <vector>
 
 #include "game/types.hpp"
@@ -13,10 +20,298 @@ struct BattleSummary {
     double expectedRounds = 0.0;
 };
 
+// How dice are scored against a fleet whose ships carry different shields.
+enum class ShieldModel {
+    Averaged,  // every die rolls against the fleet's mean shield, rounded
+    PerTarget  // a hit can only be assigned to ships whose shield it beats
+};
+
+// Outcome when fleets may withdraw. humanRetreat/alienRetreat are the chances
+// that the battle ends with that fleet escaping; all five probabilities sum to 1.
+struct RetreatSummary {
+    double humanWin = 0.0;
+    double alienWin = 0.0;
+    double draw = 0.0;
+    double humanRetreat = 0.0;
+    double alienRetreat = 0.0;
+    double expectedRounds = 0.0;
+};
+
+enum class RetreatRule {
+    Never,
+    Threshold,  // withdraw once the chance to win without retreats falls below threshold
+    Optimal     // withdraw whenever that raises the fleet's expected value
+};
+
+// For Optimal, holding the field (the enemy destroyed or fled) is worth 1,
+// escaping is worth escapeValue, and losing or drawing is worth 0.
+struct RetreatPolicy {
+    RetreatRule rule = RetreatRule::Never;
+    double threshold = 0.25;
+    double escapeValue = 0.5;
+};
+
+// How a fleet in a battle of three or more picks the enemy fleet for each
+// volley. All of its hits in that volley go to the chosen fleet, where they are
+// assigned smallest ship first as in a two-sided battle. Ties go to the fleet
+// listed first.
+enum class TargetRule {
+    Threat,  // the fleet with the most weapon dice
+    Weakest  // the fleet with the least hull left
+};
+
+struct CombatSide {
+    std::vector<ShipLoadout> fleet;
+    TargetRule targeting = TargetRule::Threat;
+};
+
+// Outcome of a battle between any number of fleets. win[i] is the chance that
+// side i is the last fleet standing; draw covers mutual destruction and
+// stalemates. Together they sum to 1.
+struct MultiBattleSummary {
+    std::vector<double> win;
+    double draw = 0.0;
+    double expectedRounds = 0.0;
+};
+
+// Outcome after at most a fixed number of regular rounds; the missile volley
+// does not count against the horizon. stillFighting is the chance that both
+// fleets are still fighting when it is reached, and expectedRounds counts only
+// the rounds fought within it.
+struct HorizonSummary {
+    double humanWin = 0.0;
+    double alienWin = 0.0;
+    double draw = 0.0;
+    double stillFighting = 0.0;
+    double expectedRounds = 0.0;
+};
+
+// Monte Carlo estimate from sample(); roundsVariance is the sample variance of
+// the number of rounds, for confidence intervals on expectedRounds.
+struct SampledSummary {
+    BattleSummary estimate;
+    double roundsVariance = 0.0;
+    std::uint64_t trials = 0;
+};
+
+// Battles still undecided after this many rounds count as draws when sampling.
+inline constexpr int kSampleRoundLimit = 1000;
+
+// Work done by one simulate() call.
+struct SolveStats {
+    std::uint64_t statesExpanded = 0;  // states whose transitions were enumerated
+    std::uint64_t transitions = 0;     // distinct successor states generated
+    std::uint64_t memoHits = 0;        // answered from the call's own memo
+    std::uint64_t sharedHits = 0;      // answered from the shared cache
+    std::uint64_t storeHits = 0;       // answered from the solution store
+};
+
+// Where one ship stands part-way through a battle.
+struct ShipStatus {
+    std::optional<int> hull;  // hits it can still take, 0 or less once destroyed; empty: undamaged
+    bool fluxSpent = false;   // its flux shield no longer absorbs damage for the rest of the battle
+};
+
+// A battle part-way through. Statuses apply to the ships of the same index;
+// ships without one are undamaged. With missilesResolved false the missile
+// volley is still to come, as at the start of simulate().
+struct BattlePosition {
+    std::vector<ShipLoadout> humans;
+    std::vector<ShipLoadout> aliens;
+    std::vector<ShipStatus> humanStatus;
+    std::vector<ShipStatus> alienStatus;
+    bool missilesResolved = true;
+};
+
+// Live counters of one simulator, written by whichever thread runs its
+// simulate() calls and readable from any other thread without locking, e.g. by
+// a HUD while a solve runs in the background. The solver publishes its
+// SolveStats with relaxed stores every kProgressInterval expanded states and
+// once more when the call returns; nothing is updated per state, so the
+// counters are cheap enough to leave on. Values are individually atomic, not a
+// consistent snapshot.
+struct SolveProgress {
+    std::atomic<std::uint64_t> statesExpanded{0};  // of the call in flight, else the last call
+    std::atomic<std::uint64_t> memoHits{0};
+    std::atomic<std::uint64_t> sharedHits{0};
+    std::atomic<std::uint64_t> storeHits{0};
+    std::atomic<std::uint64_t> memoBytes{0};        // estimated heap held by that call's memo
+    std::atomic<std::uint64_t> sharedCacheBytes{0};  // estimated heap held by the shared cache
+    std::atomic<std::uint64_t> completedSolves{0};
+    std::atomic<std::uint64_t> lastSolveMicros{0};  // wall time of the last call that returned
+    std::atomic<bool> solving{false};
+};
+
+inline constexpr std::uint64_t kProgressInterval = 1024;
+
+// Bump whenever the solver's state encoding or the meaning of a solved state
+// changes. Solution stores written under another version are discarded on open.
+inline constexpr std::uint32_t kSolutionStateVersion = 1;
+
+// Stable 128-bit key of a canonical battle state. Unlike the in-memory hash it
+// is independent of the build, so it can be persisted.
+struct StateKey {
+    std::uint64_t lo = 0;
+    std::uint64_t hi = 0;
+
+    bool operator==(const StateKey&) const = default;
+    auto operator<=>(const StateKey&) const = default;
+};
+
+// Thrown by simulate() when its stop token is triggered mid-solve. States that
+// were fully solved before the stop remain in the shared cache and store.
+class SimulationCancelled : public std::runtime_error {
+public:
+    SimulationCancelled();
+};
+
+class SolutionStore;
+class SolveCache;
+
 class BattleSimulator {
 public:
+    BattleSimulator() = default;
+    // Solved sub-battles are looked up in the store before being computed and
+    // appended to it after each simulate() call.
+    explicit BattleSimulator(std::shared_ptr<SolutionStore> store);
+
+    void setSolutionStore(std::shared_ptr<SolutionStore> store);
+    const std::shared_ptr<SolutionStore>& solutionStore() const { return store_; }
+
+    // Memo shared with other simulators (typically on other threads); consulted
+    // before the solution store.
+    void setSharedCache(std::shared_ptr<SolveCache> cache);
+    const std::shared_ptr<SolveCache>& sharedCache() const { return sharedCache_; }
+
+    // Averaged by default. Per-target solving is exact for fleets that mix
+    // shield values and costs more only for the volleys where they differ;
+    // its solved states are keyed apart from averaged ones in the shared cache
+    // and the solution store.
+    void setShieldModel(ShieldModel model) { shields_ = model; }
+    ShieldModel shieldModel() const { return shields_; }
+
     BattleSummary simulate(const std::vector<ShipLoadout>& humans,
-                           const std::vector<ShipLoadout>& aliens);
+                           const std::vector<ShipLoadout>& aliens,
+                           std::stop_token stop = {});
+
+    // Outcome from a mid-battle position, e.g. the fleets left after round
+    // two. The position is canonicalized into the solver's state, so with a
+    // shared cache attached any position an earlier solve passed through is a
+    // single lookup, and the rest is solved as simulate() would from there.
+    // expectedRounds counts the rounds still to be fought.
+    BattleSummary simulateFrom(const BattlePosition& position, std::stop_token stop = {});
+
+    // Retreat-aware solve. A fleet may withdraw at the start of any round after
+    // the missile volley: it holds fire that round, the enemy shoots at it once
+    // more, and the survivors escape. Fleets with a starbase never withdraw.
+    // Threshold policies consult the regular solver. Retreat values are shared
+    // through the cache and the solution store as well, keyed by the state and
+    // both policies, so a repeated or concurrent solve with the same policies
+    // reuses them. With both policies Never this is simulate().
+    RetreatSummary simulate(const std::vector<ShipLoadout>& humans,
+                            const std::vector<ShipLoadout>& aliens,
+                            const RetreatPolicy& humanPolicy,
+                            const RetreatPolicy& alienPolicy,
+                            std::stop_token stop = {});
+
+    // Battle between any number of fleets, e.g. three factions meeting in one
+    // sector. Once two fleets are left the rest is solved as a regular
+    // two-sided battle, sharing its cache and store; with exactly two sides
+    // this is simulate(sides[0].fleet, sides[1].fleet).
+    MultiBattleSummary simulate(const std::vector<CombatSide>& sides, std::stop_token stop = {});
+
+    // Truncated-horizon solve: only states reachable within maxRounds rounds are
+    // expanded, so a short lookahead costs a fraction of simulate(). Solved from
+    // scratch each call; the shared cache and solution store are not consulted.
+    HorizonSummary simulateRounds(const std::vector<ShipLoadout>& humans,
+                                  const std::vector<ShipLoadout>& aliens,
+                                  int maxRounds,
+                                  std::stop_token stop = {});
+
+    // Plays the battle out with individually rolled dice, trials times. An
+    // independent check on simulate(), which must agree within sampling error.
+    static SampledSummary sample(const std::vector<ShipLoadout>& humans,
+                                 const std::vector<ShipLoadout>& aliens,
+                                 std::uint64_t trials,
+                                 std::uint64_t seed,
+                                 ShieldModel shields = ShieldModel::Averaged);
+
+    // Statistics of the most recent simulate() call, including a cancelled one.
+    const SolveStats& lastStats() const { return lastStats_; }
+
+    // Counters published by the simulate() calls of this simulator; safe to
+    // read from other threads while one runs.
+    const SolveProgress& progress() const { return *progress_; }
+
+    // Key under which simulate() stores and looks up the whole matchup.
+    static StateKey matchupKey(const std::vector<ShipLoadout>& humans,
+                               const std::vector<ShipLoadout>& aliens,
+                               ShieldModel shields = ShieldModel::Averaged);
+    // Key under which that position is stored and looked up.
+    static StateKey positionKey(const BattlePosition& position, ShieldModel shields = ShieldModel::Averaged);
+
+private:
+    BattleSummary solveFrom(const std::vector<ShipLoadout>& humans,
+                            const std::vector<ShipLoadout>& aliens,
+                            const std::vector<ShipStatus>* humanStatus,
+                            const std::vector<ShipStatus>* alienStatus,
+                            bool missilesResolved,
+                            std::stop_token stop);
+
+    std::shared_ptr<SolutionStore> store_;
+    std::shared_ptr<SolveCache> sharedCache_;
+    ShieldModel shields_ = ShieldModel::Averaged;
+    SolveStats lastStats_;
+    std::unique_ptr<SolveProgress> progress_ = std::make_unique<SolveProgress>();
+};
+
+// Compact reference to a canonical battle state interned by a RoundTransitions.
+using StateHandle = std::uint32_t;
+
+struct Transition {
+    StateHandle state;
+    double probability;
+};
+
+enum class BattleOutcome { Fighting, HumansWin, AliensWin, Draw };
+
+// One-step successor distributions for AI lookahead. Positions are interned
+// into canonical states addressed by dense handles, and each state's
+// transitions are computed once and kept, so searching the same tree again
+// costs a lookup and no allocation. Spans stay valid until clear(). Not
+// thread-safe; give each search thread its own.
+class RoundTransitions {
+public:
+    explicit RoundTransitions(ShieldModel shields = ShieldModel::Averaged);
+    ~RoundTransitions();
+
+    RoundTransitions(const RoundTransitions&) = delete;
+    RoundTransitions& operator=(const RoundTransitions&) = delete;
+
+    StateHandle intern(const BattlePosition& position);
+
+    // States after exactly one round, most likely first; with the missile
+    // volley still to come that volley is the step. A finished or stalemated
+    // state leads back to itself.
+    std::span<const Transition> round(StateHandle state);
+    // States after only the weapons of one initiative fire. Firing the
+    // initiatives() of a state in order composes to its round().
+    std::span<const Transition> volley(StateHandle state, int initiative);
+    // Initiatives that fire in a regular round from the state, highest first.
+    std::span<const int> initiatives(StateHandle state);
+
+    BattleOutcome outcome(StateHandle state) const;
+    bool missilesResolved(StateHandle state) const;
+    // Same key as BattleSimulator::positionKey(), for SolveCache and
+    // SolutionStore lookups of a state's value.
+    StateKey key(StateHandle state) const;
+
+    std::size_t size() const;  // states interned
+    void clear();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
 };
 
 }  // namespace eclipse
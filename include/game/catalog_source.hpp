@@ -0,0 +1,68 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "game/tech_catalog.hpp"
+
+namespace eclipse {
+
+// A catalog loaded at runtime instead of the built-in constexpr tables.
+//
+// Text format: one directive per line, '#' starts a comment, blocks are indented.
+//
+//   module ION_CANNON
+//     label ION
+//     name Ion Cannon
+//     slot weapon
+//     energy 1                 # also: power dice computer shield hull drive
+//     hit 6                    #       initiative sides missile oneshot flux blueprint
+//   design HUM_INT
+//     name Human Interceptor
+//     faction human
+//     class interceptor
+//     hull 1                   # also: computer shield dice energy initiative
+//     drives forbidden         # optional; 'drives optional' drops the engine rule
+//     slot weapon ION_CANNON
+//     slot support             # free slot without preprint
+//     extra BASIC_REACTOR
+//   variant ORI                # derives ORI_* designs from already defined ones
+//     from HUM
+//     faction orion
+//     name Orion               # replaces the first word of the base design name
+//     initiative interceptor 3
+//     extra ships IMPROVED_REACTOR
+//     extras starbase ELECTRON_COMPUTER BLUEPRINT_REACTOR_5
+//     fill-empty all ORION_SHIELD_MALUS
+//     clear-preprint ships BASIC_REACTOR else-except ION_CANNON NUCLEAR_DRIVE
+//
+// Variant selectors are 'all', 'ships' (everything but starbases) or a class name.
+//
+// The binary format is a flat little-endian image of the flattened records (variants
+// already expanded). It is memory-mapped on load and its strings are used in place.
+class CatalogSource {
+public:
+    ~CatalogSource();
+
+    // All loaders throw std::runtime_error describing the first problem found.
+    static std::unique_ptr<CatalogSource> parseText(std::string text);
+    static std::unique_ptr<CatalogSource> loadTextFile(const std::string& path);
+    static std::unique_ptr<CatalogSource> loadBinaryFile(const std::string& path);
+    static std::unique_ptr<CatalogSource> loadFile(const std::string& path);
+
+    const CatalogView& view() const;
+
+private:
+    struct Storage;
+
+    explicit CatalogSource(std::unique_ptr<Storage> storage);
+
+    std::unique_ptr<Storage> storage_;
+};
+
+void writeCatalogText(const CatalogView& catalog, std::ostream& out);
+void writeCatalogBinary(const CatalogView& catalog, const std::string& path);
+
+}  // namespace eclipse
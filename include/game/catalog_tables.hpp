@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "game/types.hpp"
+
+// Built-in module and hull data as compile-time tables. Nothing here is constructed
+// at startup: TechCatalog serves views of these arrays, and any translation unit can
+// fold lookups such as catalog::moduleById("ION_CANNON")->dice into constants.
+
+namespace eclipse::catalog {
+
+namespace detail {
+
+constexpr ModuleSpec weapon(std::string_view id, std::string_view shortLabel, std::string_view name,
+                            int energyCost, int dice, int baseToHit, int initiative, int dieSides,
+                            bool missile = false, bool oneShot = false) {
+    ModuleSpec spec;
+    spec.id = id;
+    spec.shortLabel = shortLabel;
+    spec.name = name;
+    spec.slot = SlotType::Weapon;
+    spec.energyCost = energyCost;
+    spec.dice = dice;
+    spec.baseToHit = baseToHit;
+    spec.weaponInitiative = initiative;
+    spec.weaponDieSides = dieSides;
+    spec.missile = missile;
+    spec.oneShot = oneShot;
+    return spec;
+}
+
+constexpr ModuleSpec computer(std::string_view id, std::string_view shortLabel, std::string_view name,
+                              int energyCost, int bonus) {
+    ModuleSpec spec;
+    spec.id = id;
+    spec.shortLabel = shortLabel;
+    spec.name = name;
+    spec.slot = SlotType::Computer;
+    spec.energyCost = energyCost;
+    spec.accuracyBonus = bonus;
+    return spec;
+}
+
+constexpr ModuleSpec shield(std::string_view id, std::string_view shortLabel, std::string_view name,
+                            int energyCost, int bonus) {
+    ModuleSpec spec;
+    spec.id = id;
+    spec.shortLabel = shortLabel;
+    spec.name = name;
+    spec.slot = SlotType::Shield;
+    spec.energyCost = energyCost;
+    spec.shieldBonus = bonus;
+    return spec;
+}
+
+constexpr ModuleSpec hull(std::string_view id, std::string_view shortLabel, std::string_view name,
+                          int energyCost, int bonus) {
+    ModuleSpec spec;
+    spec.id = id;
+    spec.shortLabel = shortLabel;
+    spec.name = name;
+    spec.slot = SlotType::Support;
+    spec.energyCost = energyCost;
+    spec.hullBonus = bonus;
+    return spec;
+}
+
+constexpr ModuleSpec support(std::string_view id, std::string_view shortLabel, std::string_view name,
+                             SlotType slot, int energyCost, int energyProvided, int drivePower = 0,
+                             bool flux = false) {
+    ModuleSpec spec;
+    spec.id = id;
+    spec.shortLabel = shortLabel;
+    spec.name = name;
+    spec.slot = slot;
+    spec.energyCost = energyCost;
+    spec.energyProvided = energyProvided;
+    spec.drivePower = drivePower;
+    spec.grantsFluxShield = flux;
+    return spec;
+}
+
+constexpr ModuleSpec blueprintSupport(std::string_view id, std::string_view shortLabel, std::string_view name,
+                                      SlotType slot, int energyCost, int energyProvided) {
+    ModuleSpec spec = support(id, shortLabel, name, slot, energyCost, energyProvided);
+    spec.blueprintOnly = true;
+    return spec;
+}
+
+constexpr ModuleSpec blueprintShield(std::string_view id, std::string_view shortLabel, std::string_view name,
+                                     int bonus) {
+    ModuleSpec spec = shield(id, shortLabel, name, 0, bonus);
+    spec.blueprintOnly = true;
+    return spec;
+}
+
+}  // namespace detail
+
+inline constexpr std::array kModules{
+    // Weapons
+    detail::weapon("ION_CANNON", "ION", "Ion Cannon", 1, 1, 6, 1, 6),
+    detail::weapon("PLASMA_CANNON", "PLAS", "Plasma Cannon", 2, 1, 6, 2, 6),
+    detail::weapon("POSITRON_CANNON", "POSC", "Positron Cannon", 3, 1, 6, 2, 8),
+    detail::weapon("ANTIMATTER_CANNON", "ANTI", "Antimatter Cannon", 3, 1, 5, 3, 6),
+    detail::weapon("NUCLEAR_MISSILE", "NMIS", "Nuclear Missile", 2, 1, 6, 0, 6, true, true),
+    detail::weapon("PLASMA_MISSILE", "PMIS", "Plasma Missile", 3, 1, 6, 0, 8, true, true),
+    detail::weapon("ANCIENT_CANNON", "ACAN", "Ancient Technology Cannon", 0, 1, 5, 2, 6),
+    detail::weapon("ANCIENT_TURRET", "ATUR", "Ancient Ion Turret", 0, 1, 6, 1, 6),
+    detail::weapon("ANCIENT_MISSILE", "AMIS", "Ancient Missile", 0, 1, 5, 0, 6, true, true),
+
+    // Drives
+    detail::support("NUCLEAR_DRIVE", "NUKE", "Nuclear Drive", SlotType::Drive, 0, 0, 1),
+    detail::support("FUSION_DRIVE", "FUSN", "Fusion Drive", SlotType::Drive, 1, 0, 2),
+    detail::support("ION_DRIVE", "IOND", "Ion Drive", SlotType::Drive, 2, 0, 2),
+
+    // Computers
+    detail::computer("ELECTRON_COMPUTER", "EC+1", "Electron Computer", 1, 1),
+    detail::computer("POSITRON_COMPUTER", "PC+2", "Positron Computer", 2, 2),
+    detail::computer("GLUON_COMPUTER", "GC+3", "Gluon Computer", 3, 3),
+    detail::computer("ANCIENT_COMPUTER", "AC+2", "Ancient Computer", 0, 2),
+
+    // Shields
+    detail::shield("GAUSS_SHIELD", "SH+1", "Gauss Shield", 1, 1),
+    detail::shield("PHASE_SHIELD", "SH+2", "Phase Shield", 2, 2),
+    detail::shield("ADVANCED_SHIELD", "SH+3", "Advanced Shield", 3, 3),
+    detail::shield("ANCIENT_SHIELD", "ASH+2", "Ancient Shield", 0, 2),
+
+    // Hull & support
+    detail::hull("HULL", "H+1", "Hull", 1, 1),
+    detail::hull("IMPROVED_HULL", "H+2", "Improved Hull", 2, 2),
+    detail::hull("ANCIENT_HULL", "AH+1", "Ancient Hull", 0, 1),
+    detail::support("FLUX_SHIELD", "FLUX", "Flux Shield", SlotType::Support, 2, 0, 0, true),
+
+    // Power sources / reactors / grids
+    detail::support("FUSION_SOURCE", "PWR2", "Fusion Source", SlotType::Power, 0, 2),
+    detail::support("ANTIMATTER_REACTOR", "PWR3", "Antimatter Reactor", SlotType::Power, 0, 3),
+    detail::support("DARK_MATRIX", "DMAT", "Dark Energy Matrix", SlotType::Power, 0, 4),
+    detail::support("IMPROVED_REACTOR", "PWR1", "Improved Reactor", SlotType::Power, 0, 1),
+    detail::support("QUANTUM_GRID", "QGRD", "Quantum Grid", SlotType::Support, 0, 1),
+
+    // Blueprint-only printed parts
+    detail::blueprintSupport("BASIC_REACTOR", "PWR3", "Basic Reactor", SlotType::Power, 0, 3),
+    detail::blueprintSupport("BLUEPRINT_REACTOR_5", "E+5", "Blueprint Energy +5", SlotType::Power, 0, 5),
+    detail::blueprintShield("ORION_SHIELD_MALUS", "SH-1", "Orion Shield Debt", -1),
+};
+
+// Resolves a module at compile time; an unknown ID fails the build instead of throwing.
+consteval const ModuleSpec* moduleById(std::string_view id) {
+    for (const ModuleSpec& spec : kModules) {
+        if (spec.id == id) {
+            return &spec;
+        }
+    }
+    throw "unknown module id";
+}
+
+namespace detail {
+
+inline constexpr const ModuleSpec* kIon = moduleById("ION_CANNON");
+inline constexpr const ModuleSpec* kDrive = moduleById("NUCLEAR_DRIVE");
+inline constexpr const ModuleSpec* kBasicReactor = moduleById("BASIC_REACTOR");
+inline constexpr const ModuleSpec* kElectron = moduleById("ELECTRON_COMPUTER");
+inline constexpr const ModuleSpec* kHull = moduleById("HULL");
+inline constexpr const ModuleSpec* kImprovedReactor = moduleById("IMPROVED_REACTOR");
+inline constexpr const ModuleSpec* kFusionSource = moduleById("FUSION_SOURCE");
+inline constexpr const ModuleSpec* kReactorFive = moduleById("BLUEPRINT_REACTOR_5");
+inline constexpr const ModuleSpec* kShieldPenalty = moduleById("ORION_SHIELD_MALUS");
+
+constexpr SlotBlueprint slot(SlotType type, const ModuleSpec* preprint = nullptr) {
+    SlotBlueprint blueprint;
+    blueprint.preferredType = type;
+    blueprint.preprint = preprint;
+    return blueprint;
+}
+
+inline constexpr std::array kTerranInterceptorSlots{
+    slot(SlotType::Weapon, kIon),
+    slot(SlotType::Drive, kDrive),
+    slot(SlotType::Power, kBasicReactor),
+    slot(SlotType::Support),
+};
+
+inline constexpr std::array kTerranCruiserSlots{
+    slot(SlotType::Weapon, kIon),
+    slot(SlotType::Drive, kDrive),
+    slot(SlotType::Power, kBasicReactor),
+    slot(SlotType::Computer, kElectron),
+    slot(SlotType::Support, kHull),
+    slot(SlotType::Support),
+};
+
+inline constexpr std::array kTerranDreadSlots{
+    slot(SlotType::Weapon, kIon),
+    slot(SlotType::Weapon, kIon),
+    slot(SlotType::Drive, kDrive),
+    slot(SlotType::Power, kBasicReactor),
+    slot(SlotType::Computer, kElectron),
+    slot(SlotType::Support, kHull),
+    slot(SlotType::Support, kHull),
+    slot(SlotType::Support),
+};
+
+inline constexpr std::array kTerranStarbaseSlots{
+    slot(SlotType::Computer, kElectron),
+    slot(SlotType::Weapon, kIon),
+    slot(SlotType::Support, kHull),
+    slot(SlotType::Support, kHull),
+    slot(SlotType::Support),
+};
+
+// Planta swaps one printed part for a free slot: the first hull on the starbase, the
+// basic reactor elsewhere (falling back to the first non-weapon, non-drive preprint).
+template <std::size_t N>
+constexpr std::array<SlotBlueprint, N> plantaSlots(std::array<SlotBlueprint, N> slots, bool starbase) {
+    const ModuleSpec* target = starbase ? kHull : kBasicReactor;
+    for (auto& entry : slots) {
+        if (entry.preprint == target) {
+            entry.preprint = nullptr;
+            return slots;
+        }
+    }
+    if (!starbase) {
+        for (auto& entry : slots) {
+            if (entry.preprint && entry.preprint != kIon && entry.preprint != kDrive) {
+                entry.preprint = nullptr;
+                break;
+            }
+        }
+    }
+    return slots;
+}
+
+// Orion blueprints print a -1 shield into every free slot.
+template <std::size_t N>
+constexpr std::array<SlotBlueprint, N> orionSlots(std::array<SlotBlueprint, N> slots) {
+    for (auto& entry : slots) {
+        if (!entry.preprint) {
+            entry.preprint = kShieldPenalty;
+        }
+    }
+    return slots;
+}
+
+inline constexpr auto kPlantaInterceptorSlots = plantaSlots(kTerranInterceptorSlots, false);
+inline constexpr auto kPlantaCruiserSlots = plantaSlots(kTerranCruiserSlots, false);
+inline constexpr auto kPlantaDreadSlots = plantaSlots(kTerranDreadSlots, false);
+inline constexpr auto kPlantaStarbaseSlots = plantaSlots(kTerranStarbaseSlots, true);
+
+inline constexpr auto kOrionInterceptorSlots = orionSlots(kTerranInterceptorSlots);
+inline constexpr auto kOrionCruiserSlots = orionSlots(kTerranCruiserSlots);
+inline constexpr auto kOrionDreadSlots = orionSlots(kTerranDreadSlots);
+inline constexpr auto kOrionStarbaseSlots = orionSlots(kTerranStarbaseSlots);
+
+inline constexpr std::array<const ModuleSpec*, 1> kBasicReactorExtras{kBasicReactor};
+inline constexpr std::array<const ModuleSpec*, 1> kImprovedReactorExtras{kImprovedReactor};
+inline constexpr std::array<const ModuleSpec*, 1> kFusionSourceExtras{kFusionSource};
+inline constexpr std::array<const ModuleSpec*, 2> kPlantaShipExtras{kElectron, kImprovedReactor};
+inline constexpr std::array<const ModuleSpec*, 2> kPlantaStarbaseExtras{kElectron, kReactorFive};
+
+constexpr ShipDesign design(std::string_view id, std::string_view name, Faction faction, ShipClass cls,
+                            int baseHull, int baseComputer, int baseShield, int initiativeBonus,
+                            bool drivesAllowed, bool requiresDrive,
+                            std::span<const SlotBlueprint> slots,
+                            std::span<const ModuleSpec* const> extras = {}) {
+    ShipDesign result;
+    result.id = id;
+    result.name = name;
+    result.faction = faction;
+    result.shipClass = cls;
+    result.baseHull = baseHull;
+    result.baseComputer = baseComputer;
+    result.baseShield = baseShield;
+    result.baseInitiativeBonus = initiativeBonus;
+    result.drivesAllowed = drivesAllowed;
+    result.requiresDrive = requiresDrive;
+    result.slots = slots;
+    result.extras = extras;
+    return result;
+}
+
+}  // namespace detail
+
+// Designs are grouped by faction in Faction enum order.
+inline constexpr std::array kDesigns{
+    detail::design("HUM_INT", "Human Interceptor", Faction::Human, ShipClass::Interceptor,
+                   1, 0, 0, 2, true, true, detail::kTerranInterceptorSlots),
+    detail::design("HUM_CRU", "Human Cruiser", Faction::Human, ShipClass::Cruiser,
+                   2, 0, 0, 1, true, true, detail::kTerranCruiserSlots),
+    detail::design("HUM_DRE", "Human Dreadnought", Faction::Human, ShipClass::Dreadnought,
+                   3, 0, 0, 0, true, true, detail::kTerranDreadSlots),
+    detail::design("HUM_STA", "Human Starbase", Faction::Human, ShipClass::Starbase,
+                   4, 0, 0, 5, false, false, detail::kTerranStarbaseSlots, detail::kBasicReactorExtras),
+
+    // Eridani Empire: Terran layouts, +1 energy on every non-starbase hull.
+    detail::design("ERI_INT", "Eridani Interceptor", Faction::Eridani, ShipClass::Interceptor,
+                   1, 0, 0, 2, true, true, detail::kTerranInterceptorSlots, detail::kImprovedReactorExtras),
+    detail::design("ERI_CRU", "Eridani Cruiser", Faction::Eridani, ShipClass::Cruiser,
+                   2, 0, 0, 1, true, true, detail::kTerranCruiserSlots, detail::kImprovedReactorExtras),
+    detail::design("ERI_DRE", "Eridani Dreadnought", Faction::Eridani, ShipClass::Dreadnought,
+                   3, 0, 0, 0, true, true, detail::kTerranDreadSlots, detail::kImprovedReactorExtras),
+    detail::design("ERI_STA", "Eridani Starbase", Faction::Eridani, ShipClass::Starbase,
+                   4, 0, 0, 5, false, false, detail::kTerranStarbaseSlots, detail::kBasicReactorExtras),
+
+    // Planta: one printed part cleared, +1 computer and extra energy, initiative 0 (starbase 2).
+    detail::design("PLA_INT", "Planta Interceptor", Faction::Planta, ShipClass::Interceptor,
+                   1, 0, 0, 0, true, true, detail::kPlantaInterceptorSlots, detail::kPlantaShipExtras),
+    detail::design("PLA_CRU", "Planta Cruiser", Faction::Planta, ShipClass::Cruiser,
+                   2, 0, 0, 0, true, true, detail::kPlantaCruiserSlots, detail::kPlantaShipExtras),
+    detail::design("PLA_DRE", "Planta Dreadnought", Faction::Planta, ShipClass::Dreadnought,
+                   3, 0, 0, 0, true, true, detail::kPlantaDreadSlots, detail::kPlantaShipExtras),
+    detail::design("PLA_STA", "Planta Starbase", Faction::Planta, ShipClass::Starbase,
+                   4, 0, 0, 2, false, false, detail::kPlantaStarbaseSlots, detail::kPlantaStarbaseExtras),
+
+    // Orion Hegemony: -1 shield in free slots, initiative 3/2/1/5, extra energy per hull.
+    detail::design("ORI_INT", "Orion Interceptor", Faction::Orion, ShipClass::Interceptor,
+                   1, 0, 0, 3, true, true, detail::kOrionInterceptorSlots, detail::kImprovedReactorExtras),
+    detail::design("ORI_CRU", "Orion Cruiser", Faction::Orion, ShipClass::Cruiser,
+                   2, 0, 0, 2, true, true, detail::kOrionCruiserSlots, detail::kFusionSourceExtras),
+    detail::design("ORI_DRE", "Orion Dreadnought", Faction::Orion, ShipClass::Dreadnought,
+                   3, 0, 0, 1, true, true, detail::kOrionDreadSlots, detail::kBasicReactorExtras),
+    detail::design("ORI_STA", "Orion Starbase", Faction::Orion, ShipClass::Starbase,
+                   4, 0, 0, 5, false, false, detail::kOrionStarbaseSlots, detail::kBasicReactorExtras),
+};
+
+namespace detail {
+
+template <typename Handle, typename Item, std::size_t N>
+constexpr std::array<std::pair<std::string_view, Handle>, N> sortedIndex(const std::array<Item, N>& items) {
+    std::array<std::pair<std::string_view, Handle>, N> index{};
+    for (std::size_t i = 0; i < N; ++i) {
+        index[i] = {items[i].id, static_cast<Handle>(i)};
+    }
+    std::sort(index.begin(), index.end());
+    return index;
+}
+
+template <typename Handle, std::size_t N>
+constexpr Handle lookupSorted(const std::array<std::pair<std::string_view, Handle>, N>& index,
+                              std::string_view id, Handle invalid) {
+    auto it = std::lower_bound(index.begin(), index.end(), id,
+                               [](const auto& entry, std::string_view key) { return entry.first < key; });
+    if (it == index.end() || it->first != id) {
+        return invalid;
+    }
+    return it->second;
+}
+
+constexpr std::size_t countDesigns(Faction faction) {
+    std::size_t count = 0;
+    for (const ShipDesign& entry : kDesigns) {
+        count += entry.faction == faction ? 1 : 0;
+    }
+    return count;
+}
+
+template <Faction F>
+constexpr std::array<const ShipDesign*, countDesigns(F)> designsOf() {
+    std::array<const ShipDesign*, countDesigns(F)> result{};
+    std::size_t next = 0;
+    for (const ShipDesign& entry : kDesigns) {
+        if (entry.faction == F) {
+            result[next++] = &entry;
+        }
+    }
+    return result;
+}
+
+inline constexpr auto kHumanDesigns = designsOf<Faction::Human>();
+inline constexpr auto kEridaniDesigns = designsOf<Faction::Eridani>();
+inline constexpr auto kPlantaDesigns = designsOf<Faction::Planta>();
+inline constexpr auto kOrionDesigns = designsOf<Faction::Orion>();
+
+}  // namespace detail
+
+inline constexpr auto kModuleIndex = detail::sortedIndex<ModuleId>(kModules);
+inline constexpr auto kDesignIndex = detail::sortedIndex<DesignId>(kDesigns);
+
+// Indexed by Faction.
+inline constexpr std::array<std::span<const ShipDesign* const>, 4> kFactionDesigns{
+    detail::kHumanDesigns, detail::kEridaniDesigns, detail::kPlantaDesigns, detail::kOrionDesigns};
+
+constexpr ModuleId moduleId(std::string_view id) {
+    return detail::lookupSorted(kModuleIndex, id, kInvalidModuleId);
+}
+
+constexpr DesignId designId(std::string_view id) {
+    return detail::lookupSorted(kDesignIndex, id, kInvalidDesignId);
+}
+
+}  // namespace eclipse::catalog
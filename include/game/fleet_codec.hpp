@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/types.hpp"
+#include "io/mapped_file.hpp"
+
+namespace eclipse {
+
+// Serialized forms of loadouts, fleets and matchups.
+//
+// Text: a ship is a design id optionally followed by the slots that differ from the
+// blueprint, e.g. HUM_INT[0=PLASMA_CANNON,3=GAUSS_SHIELD]; a fleet is a space-separated
+// list of ships and a matchup is "<fleet> vs <fleet>". Text refers to the catalog by
+// id and survives catalog reordering. A matchup file starts with the line
+// "eclipse-fleets <version>" followed by one matchup per line; blank lines and lines
+// starting with '#' are ignored.
+//
+// Binary: catalog indices instead of ids, all fields little-endian uint16.
+//
+//   header   "ESFL" version:u16 reserved:u16 catalog:u32 matchups:u32
+//   matchup  humans:u16 aliens:u16 ship...
+//   ship     design:u16 slots:u16 module:u16... (kInvalidModuleId: blueprint tile)
+//
+// The header records a fingerprint of the catalog the indices refer to, and
+// archives written against another catalog are rejected on open.
+
+inline constexpr std::uint16_t kFleetTextVersion = 1;
+inline constexpr std::uint16_t kFleetBinaryVersion = 1;
+
+struct Matchup {
+    std::vector<ShipLoadout> humans;
+    std::vector<ShipLoadout> aliens;
+};
+
+// All parse and load functions throw std::runtime_error naming the offending input.
+std::string formatLoadout(const ShipLoadout& ship);
+std::string formatFleet(const std::vector<ShipLoadout>& fleet);
+std::string formatMatchup(const Matchup& matchup);
+ShipLoadout parseLoadout(std::string_view token);
+std::vector<ShipLoadout> parseFleet(std::string_view text);
+Matchup parseMatchup(std::string_view text);
+
+void writeMatchupsText(std::ostream& out, std::span<const Matchup> matchups);
+std::vector<Matchup> parseMatchupsText(std::string_view document);
+
+// Identifies the installed catalog's module and design numbering.
+std::uint32_t catalogFingerprint();
+
+void appendMatchupBinary(std::vector<std::byte>& out, const Matchup& matchup);
+std::vector<std::byte> encodeMatchups(std::span<const Matchup> matchups);
+void writeMatchupsBinary(const std::string& path, std::span<const Matchup> matchups);
+
+// Views into an encoded archive. They borrow the archive's bytes and decode fields
+// on access; nothing is copied until toLoadout()/toFleet()/toMatchup().
+class LoadoutView {
+public:
+    DesignId design() const { return field(0); }
+    std::size_t slotCount() const { return field(1); }
+    ModuleId module(std::size_t slot) const { return field(2 + slot); }
+    std::size_t byteSize() const { return (2 + slotCount()) * sizeof(std::uint16_t); }
+
+    ShipLoadout toLoadout() const;
+
+private:
+    friend class FleetView;
+    explicit LoadoutView(const std::byte* data) : data_(data) {}
+    std::uint16_t field(std::size_t index) const;
+
+    const std::byte* data_ = nullptr;
+};
+
+class FleetView {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = LoadoutView;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        LoadoutView operator*() const { return LoadoutView(data_); }
+        iterator& operator++() {
+            data_ += LoadoutView(data_).byteSize();
+            ++index_;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+
+    private:
+        friend class FleetView;
+        iterator(const std::byte* data, std::size_t index) : data_(data), index_(index) {}
+
+        const std::byte* data_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    iterator begin() const { return iterator(data_, 0); }
+    iterator end() const { return iterator(nullptr, size_); }
+
+    std::vector<ShipLoadout> toFleet() const;
+
+private:
+    friend class MatchupView;
+    FleetView(const std::byte* data, std::size_t size) : data_(data), size_(size) {}
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+class MatchupView {
+public:
+    FleetView humans() const;
+    FleetView aliens() const;
+    std::size_t byteSize() const { return byteSize_; }
+
+    Matchup toMatchup() const { return {humans().toFleet(), aliens().toFleet()}; }
+
+private:
+    friend class MatchupArchive;
+    MatchupView(const std::byte* data, std::size_t byteSize) : data_(data), byteSize_(byteSize) {}
+
+    const std::byte* data_ = nullptr;
+    std::size_t byteSize_ = 0;
+};
+
+// A validated binary archive. Construction checks the header, bounds and indices
+// once, so iterating afterwards needs no further checks.
+class MatchupArchive {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = MatchupView;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        MatchupView operator*() const;
+        iterator& operator++() {
+            data_ += (**this).byteSize();
+            ++index_;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const iterator& other) const { return index_ == other.index_; }
+
+    private:
+        friend class MatchupArchive;
+        iterator(const std::byte* data, std::size_t index) : data_(data), index_(index) {}
+
+        const std::byte* data_ = nullptr;
+        std::size_t index_ = 0;
+    };
+
+    // Borrows bytes, which must outlive the archive.
+    explicit MatchupArchive(std::span<const std::byte> bytes);
+    // Maps the file and keeps the mapping alive.
+    static MatchupArchive open(const std::string& path);
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    iterator begin() const;
+    iterator end() const { return iterator(nullptr, size_); }
+
+    std::vector<Matchup> toMatchups() const;
+
+private:
+    MappedFile file_;
+    std::span<const std::byte> bytes_;
+    std::size_t size_ = 0;
+};
+
+// Reads a text or binary matchup file, telling them apart by the binary magic.
+std::vector<Matchup> loadMatchups(const std::string& path);
+
+}  // namespace eclipse
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/types.hpp"
+
+namespace eclipse {
+
+class SolutionStore;
+class SolveCache;
+
+// One row (fighting as the humans) and column (as the aliens) of a matchup matrix.
+struct MatrixEntry {
+    std::string label;
+    std::vector<ShipLoadout> fleet;
+};
+
+struct MatrixCell {
+    std::size_t row = 0;
+    std::size_t column = 0;
+    BattleSummary summary;
+    SolveStats stats;
+    double milliseconds = 0.0;
+};
+
+struct MatrixOptions {
+    unsigned threads = 0;                  // 0: one per hardware thread
+    std::shared_ptr<SolveCache> cache;     // shared by every cell; a fresh one when empty
+    std::shared_ptr<SolutionStore> store;  // optional
+    ShieldModel shields = ShieldModel::Averaged;
+};
+
+// Every blueprint of the four factions as a one-ship fleet, labelled with its
+// design id, in faction then catalog order.
+std::vector<MatrixEntry> factionDesignEntries();
+
+// Solves every ordered pairing of entries, each entry against itself included,
+// on a thread pool whose simulators all share one SolveCache, so sub-battles
+// that recur between cells are solved once. Cells are queued row by row and
+// onCell runs on the worker thread as each one finishes; it must be
+// thread-safe. Once stop is requested the cells in flight are abandoned and
+// the rest skipped. If a solve or onCell throws, the other cells are stopped
+// the same way and the first exception is rethrown once the pool has drained.
+// Returns the number of cells solved.
+std::size_t solveMatrix(const std::vector<MatrixEntry>& entries,
+                        const MatrixOptions& options,
+                        const std::function<void(const MatrixCell&)>& onCell,
+                        std::stop_token stop = {});
+
+}  // namespace eclipse
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <stop_token>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/types.hpp"
+
+namespace eclipse {
+
+class SolutionStore;
+class SolveCache;
+
+enum class BattleSide { Humans, Aliens };
+
+struct SensitivityOptions {
+    BattleSide side = BattleSide::Humans;  // the fleet whose slots are varied
+    bool requireValid = true;              // skip changes that leave the ship invalid
+    unsigned threads = 0;                  // 0: one per hardware thread
+    std::shared_ptr<SolveCache> cache;     // shared by the baseline and every variant; fresh when empty
+    std::shared_ptr<SolutionStore> store;  // optional
+    ShieldModel shields = ShieldModel::Averaged;
+};
+
+// One single-slot edit and its effect. `after` null means clearing the slot
+// back to the blueprint's preprinted tile.
+struct SlotChange {
+    std::size_t ship = 0;
+    std::size_t slot = 0;
+    const ModuleSpec* before = nullptr;  // the module the slot holds, null if only the preprint
+    const ModuleSpec* after = nullptr;
+    BattleSummary summary;
+    double delta = 0.0;  // change in the varied side's win chance
+};
+
+struct SensitivityReport {
+    BattleSummary baseline;
+    std::vector<SlotChange> changes;  // largest delta first
+    std::size_t solved = 0;           // distinct variant battles actually solved
+};
+
+// Win-chance delta of every legal single-slot change to one fleet: each catalog
+// module the slot accepts (ShipLoadout::isSlotCompatible) other than the one
+// fitted, except blueprint-only tiles that cannot be built, and clearing a
+// fitted slot. The baseline is solved first into a
+// SolveCache that every variant then consults, so sub-battles the edit does
+// not touch (typically everything after the edited ship is destroyed) come
+// from the baseline's memo. Variants that canonicalize to the same battle,
+// such as the same edit to identical ships, are solved once; the rest run in
+// parallel on a thread pool. Throws SimulationCancelled if stop is requested;
+// any other failure of a variant stops the rest and is rethrown once the pool
+// has drained.
+SensitivityReport slotSensitivity(const std::vector<ShipLoadout>& humans,
+                                  const std::vector<ShipLoadout>& aliens,
+                                  const SensitivityOptions& options = {},
+                                  std::stop_token stop = {});
+
+}  // namespace eclipse
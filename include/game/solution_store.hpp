@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "game/battle_simulator.hpp"
+
+namespace eclipse {
+
+// On-disk table of solved sub-battles shared across runs.
+//
+// The file is a sorted run of fixed-size records followed by an unsorted tail
+// of records appended since the last compact(). The sorted run is memory-mapped
+// on first lookup and binary-searched in place, so a large store costs nothing
+// until it is used; only the tail is read into memory. New solutions collect in
+// memory until flush(), which appends them to the file. Once the tail grows past
+// tailLimit records, flush() (or opening a file left that way) folds it into
+// the sorted run, so the memory held stays bounded however the store is grown.
+//
+// All members are safe to call from several threads.
+class SolutionStore {
+public:
+    static constexpr std::size_t kDefaultTailLimit = std::size_t{1} << 16;
+
+    explicit SolutionStore(std::string path, std::size_t tailLimit = kDefaultTailLimit);
+    ~SolutionStore();
+
+    SolutionStore(const SolutionStore&) = delete;
+    SolutionStore& operator=(const SolutionStore&) = delete;
+
+    // Convenience for the common case of a single shared store per process.
+    static std::shared_ptr<SolutionStore> open(const std::string& path);
+
+    const std::string& path() const { return path_; }
+
+    bool find(const StateKey& key, BattleSummary& result) const;
+    void insert(const StateKey& key, const BattleSummary& result);
+
+    // Appends pending solutions to the file. Throws std::runtime_error on I/O failure.
+    void flush();
+    // Rewrites the file as one sorted run, folding in the tail and pending
+    // entries. Streams the mapped run, so it needs memory only for the tail.
+    void compact();
+    // Adds every solution known to other that this store does not already hold.
+    void merge(const SolutionStore& other);
+
+    // Number of distinct solutions known, including unflushed ones.
+    std::size_t size() const;
+    // Solutions held in memory rather than mapped: the flushed tail and pending.
+    std::size_t tailSize() const;
+
+private:
+    struct Storage;
+
+    std::string path_;
+    std::size_t tailLimit_;
+    std::unique_ptr<Storage> storage_;
+};
+
+}  // namespace eclipse
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "game/battle_simulator.hpp"
+
+namespace eclipse {
+
+// In-memory memo of solved states that several simulators, possibly on
+// different threads, consult and fill together. Keys are spread over
+// independently locked shards; a shard that outgrows its share of the capacity
+// is cleared wholesale rather than tracking recency per entry.
+class SolveCache {
+public:
+    explicit SolveCache(std::size_t capacity = std::size_t{1} << 20);
+    ~SolveCache();
+
+    SolveCache(const SolveCache&) = delete;
+    SolveCache& operator=(const SolveCache&) = delete;
+
+    bool find(const StateKey& key, BattleSummary& result) const;
+    void insert(const StateKey& key, const BattleSummary& result);
+    void clear();
+
+    std::size_t size() const;
+    std::size_t capacity() const { return capacity_; }
+    // Estimated heap held by the entries, read without taking any shard lock.
+    std::size_t memoryBytes() const;
+
+private:
+    struct Shard;
+
+    std::size_t capacity_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<std::size_t> entries_{0};  // kept next to the shards for memoryBytes()
+};
+
+}  // namespace eclipse
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
 #include <vector>
 #include <string_view>
 
@@ -7,13 +12,56 @@
 
 namespace eclipse {
 
+class CatalogSource;
+
+// Compact identity of a loadout: the design handle plus one module handle per slot
+// (kInvalidModuleId where no tile is installed). Equal signatures mean identical ships.
+struct LoadoutSignature {
+    DesignId design = kInvalidDesignId;
+    std::vector<ModuleId> modules;
+
+    bool operator==(const LoadoutSignature& other) const = default;
+};
+
+// Everything TechCatalog serves, as views into whichever source backs it.
+struct CatalogView {
+    std::span<const ModuleSpec> modules;
+    std::span<const ShipDesign> designs;
+    std::span<const std::pair<std::string_view, ModuleId>> moduleIndex;  // sorted by ID
+    std::span<const std::pair<std::string_view, DesignId>> designIndex;  // sorted by ID
+    std::array<std::span<const ShipDesign* const>, 4> factionDesigns;    // indexed by Faction
+};
+
 class TechCatalog {
 public:
-    static const std::vector<ModuleSpec>& modules();
+    static std::span<const ModuleSpec> modules();
     static const ModuleSpec* findModule(std::string_view id);
 
-    static const std::vector<ShipDesign>& shipDesigns();
-    static std::vector<const ShipDesign*> factionDesigns(Faction faction);
+    static ModuleId moduleId(std::string_view id);
+    static ModuleId moduleId(const ModuleSpec* spec);
+    static const ModuleSpec* module(ModuleId id);
+
+    static std::span<const ShipDesign> shipDesigns();
+    static const ShipDesign* findDesign(std::string_view id);
+    static std::span<const ShipDesign* const> factionDesigns(Faction faction);
+
+    static DesignId designId(std::string_view id);
+    static DesignId designId(const ShipDesign* design);
+    static const ShipDesign* design(DesignId id);
+
+    static LoadoutSignature signature(const ShipLoadout& loadout);
+    static ShipLoadout loadout(const LoadoutSignature& signature);
+
+    // The built-in tables back the catalog until another source is installed. Replaced
+    // sources stay alive for the rest of the process, so loadouts built against them
+    // keep valid pointers; swap sources at startup, before building fleets.
+    static const CatalogView& view();
+    static void use(std::unique_ptr<CatalogSource> source);
+    static void useBuiltin();
+
+    // Loads a text or compiled binary catalog (detected from the file header) and makes
+    // it active. Throws std::runtime_error on I/O or format errors.
+    static void loadFromFile(const std::string& path);
 };
 
 }  // namespace eclipse
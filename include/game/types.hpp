@@ -1,12 +1,21 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <string_view>
 #include <vector>
 #include <optional>
 
 namespace eclipse {
 
+// Dense catalog handles: index of the entry in TechCatalog::modules() / shipDesigns().
+using ModuleId = std::uint16_t;
+using DesignId = std::uint16_t;
+
+inline constexpr ModuleId kInvalidModuleId = 0xFFFF;
+inline constexpr DesignId kInvalidDesignId = 0xFFFF;
+
 enum class Faction {
     Human,
     Eridani,
@@ -31,11 +40,24 @@ enum class ShipClass {
     Other
 };
 
+// Most ships of one class a fleet may field; Other is unlimited.
+inline constexpr int shipClassLimit(ShipClass shipClass) {
+    switch (shipClass) {
+        case ShipClass::Interceptor: return 8;
+        case ShipClass::Cruiser: return 4;
+        case ShipClass::Dreadnought: return 2;
+        case ShipClass::Starbase: return 1;
+        default: return std::numeric_limits<int>::max();
+    }
+}
+
+// Catalog records only view their strings and arrays; the storage belongs to the
+// catalog source (compile-time tables by default), which outlives every loadout.
 struct ModuleSpec {
-    std::string id;
-    std::string shortLabel;
-    std::string name;
-    SlotType slot;
+    std::string_view id;
+    std::string_view shortLabel;
+    std::string_view name;
+    SlotType slot = SlotType::Support;
     int energyCost = 0;
     int energyProvided = 0;
     int dice = 0;
@@ -58,8 +80,8 @@ struct SlotBlueprint {
 };
 
 struct ShipDesign {
-    std::string id;
-    std::string name;
+    std::string_view id;
+    std::string_view name;
     Faction faction = Faction::Human;
     ShipClass shipClass = ShipClass::Interceptor;
     int baseHull = 1;
@@ -73,8 +95,8 @@ struct ShipDesign {
     int baseInitiativeBonus = 0;
     bool drivesAllowed = true;
     bool requiresDrive = true;
-    std::vector<SlotBlueprint> slots;
-    std::vector<const ModuleSpec*> extras;
+    std::span<const SlotBlueprint> slots;
+    std::span<const ModuleSpec* const> extras;
 };
 
 struct ShipDerivedStats {
@@ -90,14 +112,17 @@ struct ShipDerivedStats {
 
 class ShipLoadout {
 public:
-    ShipLoadout() = default;
+    ShipLoadout() { refresh(); }
 
     explicit ShipLoadout(const ShipDesign* design)
-        : design_(design), modules_(design ? design->slots.size() : 0, nullptr) {}
+        : design_(design), modules_(design ? design->slots.size() : 0, nullptr) {
+        refresh();
+    }
 
     void setDesign(const ShipDesign* design) {
         design_ = design;
         modules_.assign(design ? design->slots.size() : 0, nullptr);
+        refresh();
     }
 
     const ShipDesign* design() const { return design_; }
@@ -115,8 +140,9 @@ public:
         if (!module || !isSlotCompatible(index, *module)) {
             return;
         }
-        if (index < modules_.size()) {
+        if (index < modules_.size() && modules_[index] != module) {
             modules_[index] = module;
+            refresh();
         }
     }
 
@@ -156,8 +182,9 @@ public:
     }
 
     void clearModule(size_t index) {
-        if (index < modules_.size()) {
+        if (index < modules_.size() && modules_[index]) {
             modules_[index] = nullptr;
+            refresh();
         }
     }
 
@@ -171,109 +198,43 @@ public:
         return true;
     }
 
-    ShipDerivedStats derivedStats() const {
-        ShipDerivedStats stats;
-        if (!design_) {
-            return stats;
-        }
-        stats.hull = design_->baseHull;
-        stats.dice = design_->baseDice;
-        stats.computer = design_->baseComputer;
-        stats.shield = design_->baseShield;
-        stats.energyAvailable = design_->baseEnergy;
-        stats.energyUsed = 0;
-        stats.driveCount = 0;
-        stats.initiativeBonus = design_->baseInitiativeBonus;
-
-        auto accumulate = [&](const ModuleSpec* module) {
-            if (!module) {
-                return;
-            }
-            stats.hull += module->hullBonus;
-            stats.dice += module->dice;
-            stats.computer += module->accuracyBonus;
-            stats.shield += module->shieldBonus;
-            stats.energyAvailable += module->energyProvided;
-            stats.energyUsed += module->energyCost;
-            if (module->drivePower > 0) {
-                stats.driveCount += module->drivePower;
-            } else if (module->slot == SlotType::Drive) {
-                stats.driveCount += 1;
-            }
-        };
-
-        for (const ModuleSpec* extra : design_->extras) {
-            accumulate(extra);
-        }
-        for (size_t i = 0; i < modules_.size(); ++i) {
-            accumulate(activeModuleAt(i));
-        }
-        return stats;
-    }
+    // Derived stats and validation are recomputed whenever the design or a slot
+    // changes, so the accessors below are plain reads (the UI polls them every frame).
+    const ShipDerivedStats& derivedStats() const { return stats_; }
 
-    bool hasEngine() const {
-        if (!design_) {
-            return false;
-        }
-        if (!design_->requiresDrive) {
-            return true;
-        }
-        auto drivePresent = [](const ModuleSpec* module) {
-            return module && (module->slot == SlotType::Drive || module->drivePower > 0);
-        };
-        for (const ModuleSpec* extra : design_->extras) {
-            if (drivePresent(extra)) {
-                return true;
-            }
-        }
-        for (size_t i = 0; i < modules_.size(); ++i) {
-            if (drivePresent(activeModuleAt(i))) {
-                return true;
-            }
-        }
-        return false;
-    }
+    bool hasEngine() const { return hasEngine_; }
 
-    bool satisfiesEnergy() const {
-        ShipDerivedStats stats = derivedStats();
-        return stats.energyAvailable >= stats.energyUsed;
-    }
+    bool satisfiesEnergy() const { return stats_.energyAvailable >= stats_.energyUsed; }
 
-    bool isValid() const {
-        if (!design_) {
-            return false;
-        }
-        if (hasIllegalDrive()) {
-            return false;
-        }
-        if (design_->requiresDrive && !hasEngine()) {
-            return false;
-        }
-        return satisfiesEnergy();
-    }
+    bool isValid() const { return issue_ == Issue::None; }
 
-    std::string validationError() const {
-        if (!design_) {
-            return "SELECT A DESIGN";
-        }
-        if (hasIllegalDrive()) {
-            return "NO DRIVES ON STARBASE";
-        }
-        if (design_->requiresDrive && !hasEngine()) {
-            return "NEEDS ENGINE";
-        }
-        if (!satisfiesEnergy()) {
-            return "LOW ENERGY";
+    std::string_view validationError() const {
+        switch (issue_) {
+            case Issue::None: return "";
+            case Issue::NoDesign: return "SELECT A DESIGN";
+            case Issue::IllegalDrive: return "NO DRIVES ON STARBASE";
+            case Issue::NeedsEngine: return "NEEDS ENGINE";
+            case Issue::LowEnergy: return "LOW ENERGY";
         }
         return "";
     }
 
     const std::vector<const ModuleSpec*>& modules() const { return modules_; }
-    std::vector<const ModuleSpec*>& modules() { return modules_; }
 
 private:
+    enum class Issue {
+        None,
+        NoDesign,
+        IllegalDrive,
+        NeedsEngine,
+        LowEnergy
+    };
+
     const ShipDesign* design_ = nullptr;
     std::vector<const ModuleSpec*> modules_;
+    ShipDerivedStats stats_;
+    bool hasEngine_ = false;
+    Issue issue_ = Issue::NoDesign;
 
     const SlotBlueprint* slotBlueprint(size_t index) const {
         if (!design_ || index >= design_->slots.size()) {
@@ -282,17 +243,64 @@ private:
         return &design_->slots[index];
     }
 
-    bool hasIllegalDrive() const {
-        if (!design_ || design_->drivesAllowed) {
-            return false;
+    static bool providesDrive(const ModuleSpec* module) {
+        return module && (module->slot == SlotType::Drive || module->drivePower > 0);
+    }
+
+    // Single pass over extras and active slots; replaces the separate scans the
+    // stat, engine and illegal-drive checks used to make.
+    void refresh() {
+        stats_ = ShipDerivedStats{};
+        hasEngine_ = false;
+        if (!design_) {
+            issue_ = Issue::NoDesign;
+            return;
+        }
+        stats_.hull = design_->baseHull;
+        stats_.dice = design_->baseDice;
+        stats_.computer = design_->baseComputer;
+        stats_.shield = design_->baseShield;
+        stats_.energyAvailable = design_->baseEnergy;
+        stats_.initiativeBonus = design_->baseInitiativeBonus;
+
+        bool slotDrive = false;
+        auto accumulate = [&](const ModuleSpec* module) {
+            if (!module) {
+                return;
+            }
+            stats_.hull += module->hullBonus;
+            stats_.dice += module->dice;
+            stats_.computer += module->accuracyBonus;
+            stats_.shield += module->shieldBonus;
+            stats_.energyAvailable += module->energyProvided;
+            stats_.energyUsed += module->energyCost;
+            if (module->drivePower > 0) {
+                stats_.driveCount += module->drivePower;
+            } else if (module->slot == SlotType::Drive) {
+                stats_.driveCount += 1;
+            }
+        };
+
+        for (const ModuleSpec* extra : design_->extras) {
+            accumulate(extra);
+            hasEngine_ = hasEngine_ || providesDrive(extra);
         }
         for (size_t i = 0; i < modules_.size(); ++i) {
             const ModuleSpec* module = activeModuleAt(i);
-            if (module && (module->slot == SlotType::Drive || module->drivePower > 0)) {
-                return true;
-            }
+            accumulate(module);
+            slotDrive = slotDrive || providesDrive(module);
+        }
+        hasEngine_ = !design_->requiresDrive || hasEngine_ || slotDrive;
+
+        if (!design_->drivesAllowed && slotDrive) {
+            issue_ = Issue::IllegalDrive;
+        } else if (design_->requiresDrive && !hasEngine_) {
+            issue_ = Issue::NeedsEngine;
+        } else if (!satisfiesEnergy()) {
+            issue_ = Issue::LowEnergy;
+        } else {
+            issue_ = Issue::None;
         }
-        return false;
     }
 };
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/fleet_codec.hpp"
+
+namespace eclipse {
+
+// Captured simulate() calls, for replaying real sessions against later builds.
+//
+// Text, one request per line after an "eclipse-workload <version> <catalog>"
+// header, where <catalog> is the hex catalogFingerprint() at capture time:
+//
+//   <outcome> <ms> <states> <transitions> <memo> <shared> <store> <human> <alien> <draw> <rounds> | <matchup>
+//
+// <outcome> is ok, cancelled or error; the time and counters of a request that
+// did not finish cover the work done until it stopped, and its result is zero.
+// The matchup uses the text notation of game/fleet_codec.hpp. Results are
+// written with full double precision so a replay can compare them exactly.
+// Version 1 logs, which only held finished requests, lack the outcome field.
+
+inline constexpr std::uint16_t kWorkloadLogVersion = 2;
+
+enum class WorkloadOutcome { Ok, Cancelled, Error };
+
+struct WorkloadEntry {
+    Matchup matchup;
+    BattleSummary summary;
+    SolveStats stats;
+    double milliseconds = 0.0;
+    WorkloadOutcome outcome = WorkloadOutcome::Ok;
+};
+
+struct Workload {
+    std::uint32_t catalog = 0;
+    std::vector<WorkloadEntry> entries;
+};
+
+std::string formatWorkloadEntry(const WorkloadEntry& entry);
+// Throws std::runtime_error on malformed lines.
+WorkloadEntry parseWorkloadEntry(std::string_view line, std::uint16_t version = kWorkloadLogVersion);
+Workload loadWorkload(const std::string& path);
+
+// Appends entries to a log, writing the header when the file is new. Every
+// entry is flushed immediately so a crash loses at most the request in flight.
+// Thread-safe.
+class WorkloadRecorder {
+public:
+    // Throws std::runtime_error if the file cannot be opened for appending, or
+    // holds a log of another version.
+    explicit WorkloadRecorder(const std::string& path);
+
+    void record(const WorkloadEntry& entry);
+
+private:
+    std::mutex mutex_;
+    std::ofstream out_;
+};
+
+}  // namespace eclipse
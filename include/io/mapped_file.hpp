@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace eclipse {
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first access, so
+// opening a large file costs no more than the open/mmap calls themselves.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Throws std::runtime_error if the file cannot be opened or mapped.
+    static MappedFile openReadOnly(const std::string& path);
+
+    std::span<const std::byte> bytes() const { return {data_, size_}; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    void reset();
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace eclipse
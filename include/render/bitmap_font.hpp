@@ -1,34 +1,73 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 #include <SDL.h>
 
+#include "render/render_batch.hpp"
+
 namespace eclipse {
 
 class BitmapFont {
 public:
     static BitmapFont& instance();
 
-    void drawText(SDL_Renderer* renderer, const std::string& text,
+    // Draws `text` as textured quads cut from a glyph atlas, one geometry call
+    // per string. The atlas is rasterized once per renderer at scale 1 and
+    // scaled at copy time; if it cannot be created, lit pixels are filled
+    // one by one.
+    void drawText(SDL_Renderer* renderer, std::string_view text,
+                  int x, int y, SDL_Color color, int scale = 2) const;
+
+    // Records the glyph quads into `batch` instead of drawing immediately.
+    void drawText(RenderBatch& batch, std::string_view text,
                   int x, int y, SDL_Color color, int scale = 2) const;
 
-    int measureTextWidth(const std::string& text, int scale = 2) const;
+    // Points the batch's untextured primitives at a solid cell of the atlas
+    // so panels and text share one geometry run.
+    void shareAtlas(RenderBatch& batch) const;
+
+    int measureTextWidth(std::string_view text, int scale = 2) const;
     int lineHeight(int scale = 2) const;
 
+    // Drops the atlas texture; call before destroying the renderer it was
+    // created for.
+    void releaseAtlas();
+
 private:
     BitmapFont();
 
+    static constexpr int kGlyphCount = 128;
+    static constexpr int kGlyphRows = 7;
+    static constexpr int kCellSize = 8;  // atlas cell, leaves a blank border so scaled copies never bleed
+    static constexpr int kAtlasColumns = 16;
+    static constexpr int kSolidCell = 0;  // code 0 has no glyph; its cell is filled white
+
     struct Glyph {
-        int width;
-        std::vector<uint8_t> rows;
+        int width = 0;  // 0 marks a character the font does not cover
+        std::array<uint8_t, kGlyphRows> rows{};
+    };
+
+    struct Quad {
+        SDL_Rect source;  // glyph cell in the atlas
+        SDL_Rect target;
     };
 
     const Glyph* glyphFor(char c) const;
+    SDL_Texture* atlasFor(SDL_Renderer* renderer) const;
+    void layoutQuads(std::string_view text, int x, int y, int scale) const;
+
+    std::array<Glyph, kGlyphCount> glyphs_{};
 
-    std::unordered_map<char, Glyph> glyphs_;
+    mutable SDL_Renderer* atlasRenderer_ = nullptr;
+    mutable SDL_Texture* atlas_ = nullptr;
+    mutable bool atlasFailed_ = false;
+    mutable std::vector<Quad> quads_;
+    mutable RenderBatch immediate_;  // backs the SDL_Renderer overload of drawText
 };
 
 }  // namespace eclipse
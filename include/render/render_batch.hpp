@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <SDL.h>
+
+namespace eclipse {
+
+// Collects a frame's filled rects, outlines, lines and textured quads and
+// submits them with one SDL_RenderGeometry call per run of primitives sharing
+// a texture. Draw order is preserved. Untextured primitives can borrow a
+// solid white texel from another texture (the font atlas) so that panels and
+// text end up in the same run.
+class RenderBatch {
+public:
+    // Starts a frame on `renderer`, dropping anything recorded since the last flush.
+    void begin(SDL_Renderer* renderer);
+    SDL_Renderer* renderer() const { return renderer_; }
+
+    // Untextured primitives sample `texel` (normalized) from `texture`, which
+    // must be opaque white there. Without one they form their own runs.
+    void setSolidSource(SDL_Texture* texture, SDL_FPoint texel);
+
+    void fillRect(const SDL_Rect& rect, SDL_Color color);
+    void drawRect(const SDL_Rect& rect, SDL_Color color);  // one-pixel outline, like SDL_RenderDrawRect
+    void drawLine(SDL_Point from, SDL_Point to, SDL_Color color);
+    void copy(SDL_Texture* texture, const SDL_Rect& source, const SDL_Rect& target, SDL_Color color);
+
+    // Submits everything recorded since begin(). Falls back to the plain
+    // SDL_Render* calls, one per primitive, where geometry is unavailable.
+    void flush();
+
+    // Render calls issued by the last flush().
+    int drawCalls() const { return drawCalls_; }
+    size_t primitives() const { return primitives_.size(); }
+
+private:
+    enum class Kind { Fill, Line, Copy };
+
+    struct Primitive {
+        Kind kind;
+        SDL_Texture* texture;  // null for Fill and Line
+        SDL_Rect source;       // Copy: texel rect
+        SDL_Rect target;       // Fill/Copy: destination; Line: endpoints as x,y -> w,h
+        SDL_Color color;
+    };
+
+    void appendQuad(const SDL_FPoint (&corners)[4], const SDL_FPoint (&texels)[4], SDL_Color color);
+    void appendPrimitive(const Primitive& primitive);
+    void replay(const Primitive& primitive);
+
+    SDL_Renderer* renderer_ = nullptr;
+    SDL_Texture* solidTexture_ = nullptr;
+    SDL_FPoint solidTexel_{0.0f, 0.0f};
+    std::vector<Primitive> primitives_;
+    std::vector<SDL_Vertex> vertices_;
+    std::vector<int> indices_;
+    int drawCalls_ = 0;
+};
+
+}  // namespace eclipse
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/types.hpp"
+
+namespace eclipse::protocol {
+
+// Line-oriented request/response protocol of the simulation server.
+//
+//   request:  <id> solve <deadline-ms> <fleet> vs <fleet>
+//             <id> stats
+//   response: <id> ok <human-win> <alien-win> <draw> <expected-rounds>
+//             <id> timeout
+//             <id> error <message>
+//             <id> stats <key>=<value> ...
+//
+// Fleets use the text notation of game/fleet_codec.hpp, e.g.
+// HUM_INT[0=PLASMA_CANNON,3=GAUSS_SHIELD] HUM_CRU. A deadline of 0 uses the server
+// default.
+
+enum class Verb {
+    Solve,
+    Stats
+};
+
+struct Request {
+    std::string id;
+    Verb verb = Verb::Solve;
+    std::uint32_t deadlineMs = 0;
+    std::vector<ShipLoadout> humans;
+    std::vector<ShipLoadout> aliens;
+};
+
+// Throws std::runtime_error; the id is filled in first whenever the line has one
+// so the error can still be addressed to the caller.
+void parseRequest(std::string_view line, Request& request);
+
+std::string formatSolveRequest(std::string_view id, std::uint32_t deadlineMs,
+                               const std::vector<ShipLoadout>& humans,
+                               const std::vector<ShipLoadout>& aliens);
+std::string formatResult(std::string_view id, const BattleSummary& summary);
+std::string formatTimeout(std::string_view id);
+std::string formatError(std::string_view id, std::string_view message);
+
+}  // namespace eclipse::protocol
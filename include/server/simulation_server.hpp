@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace eclipse {
+
+class SolveCache;
+class SolutionStore;
+
+struct ServerOptions {
+    std::string unixPath;                      // empty: no Unix domain socket
+    int tcpPort = 0;                           // 0: no TCP listener (binds 127.0.0.1 only)
+    unsigned threads = 0;                      // 0: one per hardware thread
+    std::chrono::milliseconds defaultDeadline{30000};
+    std::size_t cacheCapacity = std::size_t{1} << 21;
+    std::shared_ptr<SolutionStore> store;      // optional persistent store
+};
+
+struct ServerStats {
+    std::uint64_t requests = 0;
+    std::uint64_t cacheHits = 0;
+    std::uint64_t coalesced = 0;
+    std::uint64_t solved = 0;
+    std::uint64_t timeouts = 0;
+    std::uint64_t cancelled = 0;
+    std::uint64_t errors = 0;
+    std::size_t cacheEntries = 0;
+};
+
+// Long-running simulation service speaking server/protocol.hpp over local
+// stream sockets.
+//
+// One I/O thread multiplexes every connection with poll(); solves run on a
+// thread pool. Requests for a matchup that is already being solved join the
+// in-flight solve instead of starting another, and all solves share one
+// SolveCache, so sub-battles common to different requests are solved once.
+// A request still waiting at its deadline is answered "timeout"; once no caller
+// is waiting on a solve it is cancelled through its stop token.
+class SimulationServer {
+public:
+    explicit SimulationServer(ServerOptions options);
+    ~SimulationServer();
+
+    SimulationServer(const SimulationServer&) = delete;
+    SimulationServer& operator=(const SimulationServer&) = delete;
+
+    // Binds the listeners; throws std::runtime_error on failure.
+    void listen();
+    // Serves until stop() is called. Calls listen() first if needed.
+    void run();
+    // Thread- and signal-safe.
+    void stop();
+
+    ServerStats stats() const;
+    int tcpPort() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace eclipse
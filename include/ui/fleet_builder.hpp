@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include <SDL.h>
+
+namespace eclipse {
+
+class SolutionStore;
+class WorkloadRecorder;
+
+enum class FleetSide { Human, Alien };
+
+struct FleetBuilderOptions {
+    std::shared_ptr<SolutionStore> store;  // optional persistent store for the simulator
+    WorkloadRecorder* recorder = nullptr;  // optional capture of simulate() requests
+    std::size_t shipsPerSide = 3;
+    // Solve on a worker thread and report back through an SDL user event (needs
+    // the SDL event queue), or solve inside handleEvent() for scripted runs.
+    bool backgroundSolves = true;
+};
+
+// The fleet builder screen: palette, both fleets, drag state and the battle
+// simulator. It turns SDL events into edits and draws itself into whatever
+// renderer it is given, so the window loop in main() and the headless UI
+// benchmark drive the same code.
+class FleetBuilder {
+public:
+    explicit FleetBuilder(FleetBuilderOptions options = {});
+    ~FleetBuilder();
+
+    FleetBuilder(const FleetBuilder&) = delete;
+    FleetBuilder& operator=(const FleetBuilder&) = delete;
+
+    // Applies one event. Returns false once the user asked to quit.
+    bool handleEvent(const SDL_Event& event);
+
+    // True when something on screen changed since the last render(), including
+    // the status message running out.
+    bool needsRedraw() const;
+    // Time until the screen must be redrawn without any input: the visible
+    // status message expires, or the overlay refreshes during a solve.
+    std::optional<Uint32> millisUntilTimeout() const;
+
+    // Clears and draws the whole screen (no present) in one batch.
+    void render(SDL_Renderer* renderer);
+    // Render calls issued by the last render(), excluding the clear.
+    int lastDrawCalls() const;
+
+    // Performance overlay with frame times, draw calls and the simulator's
+    // published solve counters; F3 toggles it.
+    void setHudVisible(bool visible);
+    bool hudVisible() const;
+
+    bool solving() const;
+    bool summaryReady() const;
+
+    // Centres of on-screen controls, for scripted input. Empty when the index
+    // is out of range for the current layout.
+    std::size_t paletteSize() const;
+    std::size_t categoryCount() const;
+    std::size_t slotCount(FleetSide side, std::size_t ship) const;
+    std::optional<SDL_Point> paletteCenter(std::size_t index) const;
+    std::optional<SDL_Point> categoryCenter(std::size_t index) const;  // entry in the open dropdown
+    std::optional<SDL_Point> slotCenter(FleetSide side, std::size_t ship, std::size_t slot) const;
+    std::optional<SDL_Point> arrowCenter(FleetSide side, std::size_t ship, int delta) const;
+    std::optional<SDL_Point> toggleCenter(FleetSide side, std::size_t ship) const;
+    SDL_Point dropdownCenter() const;
+    SDL_Point simulateCenter() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace eclipse
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eclipse {
+
+// Fixed set of worker threads draining a FIFO of tasks. Tasks must not throw.
+// The destructor finishes what is queued and joins the workers.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Blocks until the queue is empty and no task is running.
+    void wait();
+
+    std::size_t threadCount() const { return workers_.size(); }
+    std::size_t queued() const;
+
+private:
+    void workerLoop();
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::condition_variable idle_;
+    std::deque<std::function<void()>> tasks_;
+    std::size_t running_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace eclipse
@@ -2,12 +2,21 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <limits>
 #include <numeric>
 #include <optional>
+#include <random>
 #include <unordered_map>
 
+#include "game/solution_store.hpp"
+#include "game/solve_cache.hpp"
+
 namespace eclipse {
 
 namespace {
@@ -29,8 +38,11 @@ struct BattleShipProfile {
     int hull = 0;
     int computer = 0;
     int shield = 0;
+    // Derived from weapons when the profile is built; not part of identity.
+    int weaponDice = 0;
     bool fluxShield = false;
     ShipClass shipClass = ShipClass::Other;
+    // Merged per (initiative, die, to-hit) and ordered by descending initiative.
     std::vector<WeaponStats> weapons;
     std::vector<WeaponStats> missiles;
 
@@ -51,39 +63,41 @@ struct BattleState {
     }
 };
 
+std::size_t hashWeapons(const std::vector<WeaponStats>& weapons) {
+    std::size_t h = 0;
+    for (const auto& ship : weapons) {
+        std::size_t segment = static_cast<std::size_t>(ship.dice & 0xFF);
+        segment = (segment << 8) ^ static_cast<std::size_t>(ship.dieSides & 0xFF);
+        segment = (segment << 8) ^ static_cast<std::size_t>(ship.baseToHit & 0xFF);
+        segment = (segment << 8) ^ static_cast<std::size_t>(ship.initiative & 0xFF);
+        segment ^= static_cast<std::size_t>(ship.missile ? 0x4000 : 0x0);
+        segment ^= static_cast<std::size_t>(ship.oneShot ? 0x8000 : 0x0);
+        h ^= segment + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+std::size_t hashFleet(const std::vector<BattleShipProfile>& fleet) {
+    std::size_t h = 0;
+    for (const auto& ship : fleet) {
+        std::size_t segment = static_cast<std::size_t>(ship.hull & 0xFF);
+        segment = (segment << 8) ^ static_cast<std::size_t>((ship.computer & 0xFF));
+        segment = (segment << 8) ^ static_cast<std::size_t>((ship.shield & 0xFF));
+        segment ^= static_cast<std::size_t>(ship.fluxShield ? 0x1000 : 0x0);
+        segment ^= static_cast<std::size_t>(static_cast<int>(ship.shipClass) & 0xFF) << 24;
+        std::size_t weaponHash = hashWeapons(ship.weapons);
+        std::size_t missileHash = hashWeapons(ship.missiles);
+        segment ^= weaponHash;
+        segment ^= missileHash << 1;
+        h ^= segment + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
 struct StateHash {
     std::size_t operator()(const BattleState& state) const noexcept {
-        auto hashWeapons = [](const std::vector<WeaponStats>& vec) {
-            std::size_t h = 0;
-            for (const auto& ship : vec) {
-                std::size_t segment = static_cast<std::size_t>(ship.dice & 0xFF);
-                segment = (segment << 8) ^ static_cast<std::size_t>(ship.dieSides & 0xFF);
-                segment = (segment << 8) ^ static_cast<std::size_t>(ship.baseToHit & 0xFF);
-                segment = (segment << 8) ^ static_cast<std::size_t>(ship.initiative & 0xFF);
-                segment ^= static_cast<std::size_t>(ship.missile ? 0x4000 : 0x0);
-                segment ^= static_cast<std::size_t>(ship.oneShot ? 0x8000 : 0x0);
-                h ^= segment + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
-            }
-            return h;
-        };
-        auto hashVec = [&](const std::vector<BattleShipProfile>& vec) {
-            std::size_t h = 0;
-            for (const auto& ship : vec) {
-                std::size_t segment = static_cast<std::size_t>(ship.hull & 0xFF);
-                segment = (segment << 8) ^ static_cast<std::size_t>((ship.computer & 0xFF));
-                segment = (segment << 8) ^ static_cast<std::size_t>((ship.shield & 0xFF));
-                segment ^= static_cast<std::size_t>(ship.fluxShield ? 0x1000 : 0x0);
-                segment ^= static_cast<std::size_t>(static_cast<int>(ship.shipClass) & 0xFF) << 24;
-                std::size_t weaponHash = hashWeapons(ship.weapons);
-                std::size_t missileHash = hashWeapons(ship.missiles);
-                segment ^= weaponHash;
-                segment ^= missileHash << 1;
-                h ^= segment + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
-            }
-            return h;
-        };
-        std::size_t hash = hashVec(state.humans);
-        hash ^= hashVec(state.aliens) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        std::size_t hash = hashFleet(state.humans);
+        hash ^= hashFleet(state.aliens) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
         hash ^= static_cast<std::size_t>(state.missilesResolved ? 0xFFFF : 0x1);
         return hash;
     }
@@ -97,15 +111,9 @@ int totalDice(const std::vector<WeaponStats>& weapons) {
     return total;
 }
 
-int totalDice(const BattleShipProfile& ship) {
-    return totalDice(ship.weapons);
-}
-
 bool battleCompare(const BattleShipProfile& a, const BattleShipProfile& b) {
     if (a.hull != b.hull) return a.hull > b.hull;
-    int diceA = totalDice(a);
-    int diceB = totalDice(b);
-    if (diceA != diceB) return diceA > diceB;
+    if (a.weaponDice != b.weaponDice) return a.weaponDice > b.weaponDice;
     if (a.computer != b.computer) return a.computer > b.computer;
     if (a.shield != b.shield) return a.shield > b.shield;
     if (a.fluxShield != b.fluxShield) return a.fluxShield;
@@ -149,104 +157,398 @@ std::vector<double> convolve(const std::vector<double>& lhs, const std::vector<d
     return result;
 }
 
-std::vector<double> hitDistribution(const std::vector<BattleShipProfile>& attackers,
-                                    const std::vector<BattleShipProfile>& defenders,
+// A pool of dice that share initiative, die size and to-hit roll once the
+// owning ship's computer is applied.
+struct DiceGroup {
+    int initiative = 0;
+    int dieSides = 6;
+    int toHit = 6;
+    int dice = 0;
+};
+
+// Column view of one side of a state. Built once per state so that every
+// initiative bucket and every damage assignment scans dense arrays instead of
+// walking each profile's weapon vectors again.
+struct FleetColumns {
+    std::vector<int> hull;
+    std::vector<int> computer;
+    std::vector<int> shield;
+    std::vector<int> dice;
+    std::vector<DiceGroup> weapons;   // sorted by descending initiative
+    std::vector<DiceGroup> missiles;
+    int roundedShield = 0;
+
+    size_t size() const { return hull.size(); }
+};
+
+void appendGroups(std::vector<DiceGroup>& out, const std::vector<WeaponStats>& pool, int computer) {
+    for (const auto& weapon : pool) {
+        if (weapon.dice > 0) {
+            out.push_back(DiceGroup{weapon.initiative, weapon.dieSides, weapon.baseToHit - computer, weapon.dice});
+        }
+    }
+}
+
+void mergeGroups(std::vector<DiceGroup>& groups) {
+    std::sort(groups.begin(), groups.end(), [](const DiceGroup& a, const DiceGroup& b) {
+        if (a.initiative != b.initiative) return a.initiative > b.initiative;
+        if (a.dieSides != b.dieSides) return a.dieSides < b.dieSides;
+        return a.toHit < b.toHit;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < groups.size(); ++i) {
+        if (out > 0 && groups[out - 1].initiative == groups[i].initiative &&
+            groups[out - 1].dieSides == groups[i].dieSides && groups[out - 1].toHit == groups[i].toHit) {
+            groups[out - 1].dice += groups[i].dice;
+        } else {
+            groups[out++] = groups[i];
+        }
+    }
+    groups.resize(out);
+}
+
+FleetColumns buildColumns(const std::vector<BattleShipProfile>& fleet) {
+    FleetColumns columns;
+    columns.hull.reserve(fleet.size());
+    columns.computer.reserve(fleet.size());
+    columns.shield.reserve(fleet.size());
+    columns.dice.reserve(fleet.size());
+    double shieldSum = 0.0;
+    for (const auto& ship : fleet) {
+        columns.hull.push_back(ship.hull);
+        columns.computer.push_back(ship.computer);
+        columns.shield.push_back(ship.shield);
+        columns.dice.push_back(ship.weaponDice);
+        shieldSum += ship.shield;
+        appendGroups(columns.weapons, ship.weapons, ship.computer);
+        appendGroups(columns.missiles, ship.missiles, ship.computer);
+    }
+    if (!fleet.empty()) {
+        columns.roundedShield = static_cast<int>(std::round(shieldSum / fleet.size()));
+    }
+    mergeGroups(columns.weapons);
+    mergeGroups(columns.missiles);
+    return columns;
+}
+
+// Hits rolled by the attacker's groups (all of them, or one initiative bucket)
+// against the defender's averaged shield. Groups whose rolls clamp to the same
+// success chance are pooled into a single binomial.
+std::vector<double> hitDistribution(const FleetColumns& attackers,
+                                    const FleetColumns& defenders,
                                     bool missilesOnly,
                                     std::optional<int> initiativeFilter = std::nullopt) {
-    if (attackers.empty() || defenders.empty()) {
+    if (attackers.size() == 0 || defenders.size() == 0) {
         return {1.0};
     }
+    struct Pool {
+        int maxRoll;
+        int threshold;
+        int dice;
+    };
+    std::array<Pool, 16> pools{};
+    size_t poolCount = 0;
     std::vector<double> distribution{1.0};
-    double shieldSum = 0.0;
-    for (const auto& ship : defenders) {
-        shieldSum += ship.shield;
-    }
-    double avgShield = defenders.empty() ? 0.0 : (shieldSum / defenders.size());
+    auto flush = [&](const Pool& pool) {
+        double success = clamp01(((pool.maxRoll + 1) - pool.threshold) / static_cast<double>(pool.maxRoll));
+        distribution = convolve(distribution, binomialDistribution(pool.dice, success));
+    };
 
-    for (const auto& ship : attackers) {
-        const auto& pools = missilesOnly ? ship.missiles : ship.weapons;
-        if (pools.empty()) {
+    for (const DiceGroup& group : missilesOnly ? attackers.missiles : attackers.weapons) {
+        if (initiativeFilter.has_value() && group.initiative != *initiativeFilter) {
             continue;
         }
-        int delta = ship.computer - static_cast<int>(std::round(avgShield));
-        for (const auto& weapon : pools) {
-            if (weapon.dice <= 0) {
-                continue;
-            }
-            if (missilesOnly && !weapon.missile) {
-                continue;
-            }
-            if (!missilesOnly && weapon.missile) {
-                continue;
-            }
-            if (initiativeFilter.has_value() && weapon.initiative != *initiativeFilter) {
-                continue;
-            }
-            int threshold = weapon.baseToHit - delta;
-            int maxRoll = std::max(weapon.dieSides, 2);
-            if (threshold < 2) threshold = 2;
-            if (threshold > maxRoll) threshold = maxRoll;
-            double success = clamp01(((maxRoll + 1) - threshold) / static_cast<double>(maxRoll));
-            std::vector<double> shipDist = binomialDistribution(weapon.dice, success);
-            distribution = convolve(distribution, shipDist);
+        int maxRoll = std::max(group.dieSides, 2);
+        int threshold = std::clamp(group.toHit + defenders.roundedShield, 2, maxRoll);
+        size_t slot = 0;
+        while (slot < poolCount && (pools[slot].maxRoll != maxRoll || pools[slot].threshold != threshold)) {
+            ++slot;
+        }
+        if (slot < poolCount) {
+            pools[slot].dice += group.dice;
+        } else if (poolCount < pools.size()) {
+            pools[poolCount++] = Pool{maxRoll, threshold, group.dice};
+        } else {
+            flush(Pool{maxRoll, threshold, group.dice});
         }
     }
+    for (size_t i = 0; i < poolCount; ++i) {
+        flush(pools[i]);
+    }
     return distribution;
 }
 
-std::vector<BattleShipProfile> applyHits(const std::vector<BattleShipProfile>& defenders, int hits) {
+// Order in which a fleet's ships soak up hits: smallest hull first.
+std::vector<size_t> damageOrder(const FleetColumns& columns) {
+    std::vector<size_t> order(columns.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (columns.hull[a] != columns.hull[b]) return columns.hull[a] < columns.hull[b];
+        if (columns.dice[a] != columns.dice[b]) return columns.dice[a] < columns.dice[b];
+        if (columns.computer[a] != columns.computer[b]) return columns.computer[a] < columns.computer[b];
+        return columns.shield[a] < columns.shield[b];
+    });
+    return order;
+}
+
+std::vector<BattleShipProfile> applyHits(const std::vector<BattleShipProfile>& defenders,
+                                         const FleetColumns& columns,
+                                         int hits) {
     if (hits <= 0 || defenders.empty()) {
         return defenders;
     }
-    struct TargetShip {
-        BattleShipProfile ship;
-        bool fluxConsumed = false;
-    };
-    std::vector<TargetShip> targets;
-    targets.reserve(defenders.size());
-    for (const auto& ship : defenders) {
-        targets.push_back(TargetShip{ship, false});
-    }
-    std::sort(targets.begin(), targets.end(), [](const TargetShip& a, const TargetShip& b) {
-        if (a.ship.hull != b.ship.hull) return a.ship.hull < b.ship.hull;
-        int diceA = totalDice(a.ship);
-        int diceB = totalDice(b.ship);
-        if (diceA != diceB) return diceA < diceB;
-        if (a.ship.computer != b.ship.computer) return a.ship.computer < b.ship.computer;
-        return a.ship.shield < b.ship.shield;
-    });
+    std::vector<size_t> order = damageOrder(columns);
+    std::vector<int> hull = columns.hull;
+    std::vector<bool> fluxConsumed(defenders.size(), false);
     size_t index = 0;
     int damage = hits;
-    while (damage > 0 && index < targets.size()) {
-        TargetShip& target = targets[index];
-        int rawDamage = std::min(damage, target.ship.hull);
+    while (damage > 0 && index < order.size()) {
+        size_t target = order[index];
+        int rawDamage = std::min(damage, hull[target]);
         int prevention = 0;
-        if (target.ship.fluxShield && !target.fluxConsumed && rawDamage > 0) {
+        if (defenders[target].fluxShield && !fluxConsumed[target] && rawDamage > 0) {
             prevention = 1;
-            target.fluxConsumed = true;
+            fluxConsumed[target] = true;
         }
         int effectiveDamage = std::max(0, rawDamage - prevention);
         if (effectiveDamage == 0) {
             ++index;
             continue;
         }
-        target.ship.hull -= effectiveDamage;
+        hull[target] -= effectiveDamage;
         damage -= effectiveDamage;
-        if (target.ship.hull <= 0) {
-            targets.erase(targets.begin() + static_cast<long>(index));
+        if (hull[target] <= 0) {
+            order.erase(order.begin() + static_cast<long>(index));
         } else {
             ++index;
         }
     }
     std::vector<BattleShipProfile> remaining;
-    remaining.reserve(targets.size());
-    for (auto& target : targets) {
-        remaining.push_back(std::move(target.ship));
+    remaining.reserve(order.size());
+    for (size_t target : order) {
+        remaining.push_back(defenders[target]);
+        remaining.back().hull = hull[target];
     }
     std::sort(remaining.begin(), remaining.end(), battleCompare);
     return remaining;
 }
 
+// Per-target shields (ShieldModel::PerTarget). A die that beats the roll needed
+// against some of the defenders' shields but not the others' can only be
+// assigned to the ships it beats, so a volley yields a hit vector instead of a
+// hit count: how many hits beat each shield level of the defending fleet but
+// no higher one. Shield levels that no attacking group's roll tells apart are
+// merged, and a volley at a single level goes through the pooled binomial and
+// applyHits(), which are exact in that case. Counts are packed eight bits each.
+constexpr size_t kMaxShieldLevels = 8;
+constexpr int kMaxVectorHits = 0xFF;
+using HitVector = std::uint64_t;
+using HitVectors = std::vector<std::pair<HitVector, double>>;
+// The ways one volley can leave a defending fleet, with their probabilities.
+using FleetOutcomes = std::vector<std::pair<std::vector<BattleShipProfile>, double>>;
+
+struct FleetHash {
+    std::size_t operator()(const std::vector<BattleShipProfile>& fleet) const noexcept { return hashFleet(fleet); }
+};
+
+bool mixedShields(const FleetColumns& fleet) {
+    return std::adjacent_find(fleet.shield.begin(), fleet.shield.end(), std::not_equal_to<>()) != fleet.shield.end();
+}
+
+int rollNeeded(const DiceGroup& group, int shield) {
+    return std::clamp(group.toHit + shield, 2, std::max(group.dieSides, 2));
+}
+
+template <typename Visit>
+void forEachGroup(const FleetColumns& attackers, bool missilesOnly, std::optional<int> initiativeFilter, Visit&& visit) {
+    for (const DiceGroup& group : missilesOnly ? attackers.missiles : attackers.weapons) {
+        if (!initiativeFilter.has_value() || group.initiative == *initiativeFilter) {
+            visit(group);
+        }
+    }
+}
+
+// Lowest shield of every level the attacking dice can tell apart, ascending.
+std::vector<int> shieldLevels(const FleetColumns& defenders,
+                              const std::vector<const FleetColumns*>& attackers,
+                              bool missilesOnly,
+                              std::optional<int> initiativeFilter) {
+    std::vector<int> shields = defenders.shield;
+    std::sort(shields.begin(), shields.end());
+    shields.erase(std::unique(shields.begin(), shields.end()), shields.end());
+    std::vector<int> levels;
+    for (int shield : shields) {
+        bool distinct = levels.empty();
+        for (const FleetColumns* attacker : attackers) {
+            forEachGroup(*attacker, missilesOnly, initiativeFilter, [&](const DiceGroup& group) {
+                distinct = distinct || rollNeeded(group, shield) != rollNeeded(group, levels.back());
+            });
+        }
+        if (distinct) {
+            levels.push_back(shield);
+        }
+    }
+    return levels;
+}
+
+size_t shieldLevel(const std::vector<int>& levels, int shield) {
+    size_t level = 0;
+    while (level + 1 < levels.size() && levels[level + 1] <= shield) {
+        ++level;
+    }
+    return level;
+}
+
+HitVector oneHit(size_t level) {
+    return HitVector{1} << (8 * level);
+}
+
+int hitsAt(HitVector hits, size_t level) {
+    return static_cast<int>((hits >> (8 * level)) & 0xFF);
+}
+
+HitVectors sortedVectors(const std::unordered_map<HitVector, double>& distribution) {
+    HitVectors vectors(distribution.begin(), distribution.end());
+    std::sort(vectors.begin(), vectors.end());
+    return vectors;
+}
+
+// Distribution of the hit vectors one attacking fleet rolls. Each die lands in
+// the highest level whose roll it makes, or misses.
+HitVectors hitVectors(const FleetColumns& attackers,
+                      const std::vector<int>& levels,
+                      bool missilesOnly,
+                      std::optional<int> initiativeFilter) {
+    std::unordered_map<HitVector, double> distribution{{0, 1.0}};
+    forEachGroup(attackers, missilesOnly, initiativeFilter, [&](const DiceGroup& group) {
+        int maxRoll = std::max(group.dieSides, 2);
+        std::array<double, kMaxShieldLevels> chance{};
+        for (size_t level = 0; level < levels.size(); ++level) {
+            int next = level + 1 < levels.size() ? rollNeeded(group, levels[level + 1]) : maxRoll + 1;
+            chance[level] = (next - rollNeeded(group, levels[level])) / static_cast<double>(maxRoll);
+        }
+        double miss = (rollNeeded(group, levels[0]) - 1) / static_cast<double>(maxRoll);
+        for (int die = 0; die < group.dice; ++die) {
+            std::unordered_map<HitVector, double> next;
+            next.reserve(distribution.size() * 2);
+            for (const auto& [hits, probability] : distribution) {
+                if (miss > 0.0) {
+                    next[hits] += probability * miss;
+                }
+                for (size_t level = 0; level < levels.size(); ++level) {
+                    if (chance[level] > 0.0) {
+                        next[hits + oneHit(level)] += probability * chance[level];
+                    }
+                }
+            }
+            distribution.swap(next);
+        }
+    });
+    return sortedVectors(distribution);
+}
+
+HitVectors combine(const HitVectors& lhs, const HitVectors& rhs) {
+    std::unordered_map<HitVector, double> sum;
+    sum.reserve(lhs.size() * rhs.size());
+    for (const auto& [left, leftProbability] : lhs) {
+        for (const auto& [right, rightProbability] : rhs) {
+            sum[left + right] += leftProbability * rightProbability;
+        }
+    }
+    return sortedVectors(sum);
+}
+
+// applyHits() for a hit vector. Ships are taken in the same order and damaged
+// the same way, except that each ship only receives hits that beat its shield,
+// the least versatile of those first.
+std::vector<BattleShipProfile> applyHitVector(const std::vector<BattleShipProfile>& defenders,
+                                              const FleetColumns& columns,
+                                              const std::vector<int>& levels,
+                                              HitVector hits) {
+    std::array<int, kMaxShieldLevels> remaining{};
+    for (size_t level = 0; level < levels.size(); ++level) {
+        remaining[level] = hitsAt(hits, level);
+    }
+    std::vector<size_t> order = damageOrder(columns);
+    std::vector<int> hull = columns.hull;
+    std::vector<bool> fluxConsumed(defenders.size(), false);
+    for (size_t target : order) {
+        size_t level = shieldLevel(levels, columns.shield[target]);
+        int reachable = std::accumulate(remaining.begin() + static_cast<long>(level),
+                                        remaining.begin() + static_cast<long>(levels.size()), 0);
+        int rawDamage = std::min(reachable, hull[target]);
+        int prevention = 0;
+        if (defenders[target].fluxShield && !fluxConsumed[target] && rawDamage > 0) {
+            prevention = 1;
+            fluxConsumed[target] = true;
+        }
+        int damage = std::max(0, rawDamage - prevention);
+        hull[target] -= damage;
+        for (size_t from = level; damage > 0; ++from) {
+            int taken = std::min(damage, remaining[from]);
+            remaining[from] -= taken;
+            damage -= taken;
+        }
+    }
+    std::vector<BattleShipProfile> survivors;
+    survivors.reserve(order.size());
+    for (size_t target : order) {
+        if (hull[target] > 0) {
+            survivors.push_back(defenders[target]);
+            survivors.back().hull = hull[target];
+        }
+    }
+    std::sort(survivors.begin(), survivors.end(), battleCompare);
+    return survivors;
+}
+
+// Every way the attackers' combined volley can leave `defenders`. Outcomes that
+// leave the fleet in the same state are merged.
+FleetOutcomes volleyOutcomes(const std::vector<BattleShipProfile>& defenders,
+                             const FleetColumns& defenderColumns,
+                             const std::vector<const FleetColumns*>& attackers,
+                             bool missilesOnly,
+                             std::optional<int> initiativeFilter,
+                             ShieldModel shields) {
+    std::vector<int> levels;
+    int dice = 0;
+    if (shields == ShieldModel::PerTarget && defenderColumns.size() > 0) {
+        levels = shieldLevels(defenderColumns, attackers, missilesOnly, initiativeFilter);
+        for (const FleetColumns* attacker : attackers) {
+            forEachGroup(*attacker, missilesOnly, initiativeFilter, [&](const DiceGroup& group) { dice += group.dice; });
+        }
+    }
+    FleetOutcomes outcomes;
+    // Beyond the packed range the volley falls back to the averaged shield.
+    if (levels.size() <= 1 || levels.size() > kMaxShieldLevels || dice > kMaxVectorHits) {
+        std::vector<double> hits{1.0};
+        for (const FleetColumns* attacker : attackers) {
+            hits = convolve(hits, hitDistribution(*attacker, defenderColumns, missilesOnly, initiativeFilter));
+        }
+        for (size_t count = 0; count < hits.size(); ++count) {
+            if (hits[count] > 0.0) {
+                outcomes.emplace_back(applyHits(defenders, defenderColumns, static_cast<int>(count)), hits[count]);
+            }
+        }
+        return outcomes;
+    }
+    HitVectors vectors{{0, 1.0}};
+    for (const FleetColumns* attacker : attackers) {
+        vectors = combine(vectors, hitVectors(*attacker, levels, missilesOnly, initiativeFilter));
+    }
+    std::unordered_map<std::vector<BattleShipProfile>, size_t, FleetHash> seen;
+    for (const auto& [hits, probability] : vectors) {
+        std::vector<BattleShipProfile> fleet = applyHitVector(defenders, defenderColumns, levels, hits);
+        auto [it, inserted] = seen.emplace(fleet, outcomes.size());
+        if (inserted) {
+            outcomes.emplace_back(std::move(fleet), probability);
+        } else {
+            outcomes[it->second].second += probability;
+        }
+    }
+    return outcomes;
+}
+
 struct CachedResult {
     double humanWin;
     double alienWin;
@@ -254,8 +556,176 @@ struct CachedResult {
     double expectedRounds;
 };
 
+struct SolveContext {
+    std::unordered_map<BattleState, CachedResult, StateHash> cache;
+    SolveCache* shared = nullptr;
+    SolutionStore* store = nullptr;
+    ShieldModel shields = ShieldModel::Averaged;
+    std::stop_token stop;
+    SolveStats stats;
+    SolveProgress* progress = nullptr;  // published every kProgressInterval expansions
+    std::uint64_t memoBytes = 0;        // estimated heap held by `cache`
+};
+
+void addStats(SolveStats& total, const SolveStats& part) {
+    total.statesExpanded += part.statesExpanded;
+    total.transitions += part.transitions;
+    total.memoHits += part.memoHits;
+    total.sharedHits += part.sharedHits;
+    total.storeHits += part.storeHits;
+}
+
+// Heap one memo entry holds: the node (entry, next pointer, cached hash), about
+// one bucket pointer, and the ship profiles the state owns.
+std::uint64_t memoEntryBytes(const BattleState& state) {
+    std::uint64_t bytes = sizeof(std::pair<const BattleState, CachedResult>) + 3 * sizeof(void*);
+    for (const auto* fleet : {&state.humans, &state.aliens}) {
+        bytes += fleet->capacity() * sizeof(BattleShipProfile);
+        for (const auto& ship : *fleet) {
+            bytes += (ship.weapons.capacity() + ship.missiles.capacity()) * sizeof(WeaponStats);
+        }
+    }
+    return bytes;
+}
+
+void publishStats(SolveProgress& progress, const SolveStats& stats, std::uint64_t memoBytes,
+                  const SolveCache* shared) {
+    progress.statesExpanded.store(stats.statesExpanded, std::memory_order_relaxed);
+    progress.memoHits.store(stats.memoHits, std::memory_order_relaxed);
+    progress.sharedHits.store(stats.sharedHits, std::memory_order_relaxed);
+    progress.storeHits.store(stats.storeHits, std::memory_order_relaxed);
+    progress.memoBytes.store(memoBytes, std::memory_order_relaxed);
+    progress.sharedCacheBytes.store(shared ? shared->memoryBytes() : 0, std::memory_order_relaxed);
+}
+
+// Brackets one simulate() call on the simulator's progress counters. Declared
+// after the call's contexts, so it publishes the final statistics once they
+// are in lastStats, on the normal and the exceptional path alike.
+class ProgressScope {
+public:
+    ProgressScope(SolveProgress& progress, const SolveStats& stats, const SolveContext* memo,
+                  const SolveCache* shared)
+        : progress_(progress), stats_(stats), memo_(memo), shared_(shared),
+          exceptions_(std::uncaught_exceptions()), started_(std::chrono::steady_clock::now()) {
+        publishStats(progress_, {}, 0, shared_);
+        progress_.solving.store(true, std::memory_order_relaxed);
+    }
+
+    ~ProgressScope() {
+        publishStats(progress_, stats_, memo_ ? memo_->memoBytes : 0, shared_);
+        auto elapsed = std::chrono::steady_clock::now() - started_;
+        progress_.lastSolveMicros.store(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()),
+            std::memory_order_relaxed);
+        if (std::uncaught_exceptions() == exceptions_) {
+            progress_.completedSolves.fetch_add(1, std::memory_order_relaxed);
+        }
+        progress_.solving.store(false, std::memory_order_release);
+    }
+
+    ProgressScope(const ProgressScope&) = delete;
+    ProgressScope& operator=(const ProgressScope&) = delete;
+
+private:
+    SolveProgress& progress_;
+    const SolveStats& stats_;
+    const SolveContext* memo_;
+    const SolveCache* shared_;
+    int exceptions_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+// Build-independent key for the solution store: a fixed little-endian encoding
+// of the canonical state, hashed twice. kSolutionStateVersion seeds both halves.
+// Per-target states append a marker, so averaged keys are unchanged. A nonzero
+// salt also goes into the seeds, keying other solvers' results for the same
+// state apart from the plain one.
+StateKey persistentKey(const BattleState& state, ShieldModel shields, std::uint64_t salt = 0) {
+    std::vector<std::uint8_t> bytes;
+    bytes.reserve(64);
+    auto put = [&](int value) {
+        bytes.push_back(static_cast<std::uint8_t>(value & 0xFF));
+        bytes.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
+    };
+    auto putWeapons = [&](const std::vector<WeaponStats>& weapons) {
+        put(static_cast<int>(weapons.size()));
+        for (const auto& weapon : weapons) {
+            put(weapon.dice);
+            put(weapon.dieSides);
+            put(weapon.baseToHit);
+            put(weapon.initiative);
+            put((weapon.missile ? 1 : 0) | (weapon.oneShot ? 2 : 0));
+        }
+    };
+    for (const auto* fleet : {&state.humans, &state.aliens}) {
+        put(static_cast<int>(fleet->size()));
+        for (const auto& ship : *fleet) {
+            put(ship.hull);
+            put(ship.computer);
+            put(ship.shield);
+            put((ship.fluxShield ? 1 : 0) | (static_cast<int>(ship.shipClass) << 1));
+            putWeapons(ship.weapons);
+            putWeapons(ship.missiles);
+        }
+    }
+    put(state.missilesResolved ? 1 : 0);
+    if (shields == ShieldModel::PerTarget) {
+        put(0x5E1D);
+    }
+
+    std::uint64_t lo = 0xcbf29ce484222325ULL ^ kSolutionStateVersion ^ salt;
+    std::uint64_t hi = 0x9e3779b97f4a7c15ULL * (kSolutionStateVersion + 1) ^ (salt * 0xbf58476d1ce4e5b9ULL);
+    for (std::uint8_t byte : bytes) {
+        lo = (lo ^ byte) * 0x100000001b3ULL;
+        hi = (hi + byte + 1) * 0xbf58476d1ce4e5b9ULL;
+        hi ^= hi >> 31;
+    }
+    hi ^= bytes.size();
+    hi = (hi ^ (hi >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hi = (hi ^ (hi >> 27)) * 0x94d049bb133111ebULL;
+    hi ^= hi >> 31;
+    return {lo, hi};
+}
+
+CachedResult fromSummary(const BattleSummary& summary) {
+    return {summary.humanWin, summary.alienWin, summary.draw, summary.expectedRounds};
+}
+
+BattleSummary toSummary(const CachedResult& result) {
+    return {result.humanWin, result.alienWin, result.draw, result.expectedRounds};
+}
+
+// Shared memo first, then the persistent store; store hits are promoted into
+// the shared memo so other simulators skip the file lookup.
+bool lookupSolved(SolveContext& context, const StateKey& key, CachedResult& result) {
+    BattleSummary found;
+    if (context.shared && context.shared->find(key, found)) {
+        ++context.stats.sharedHits;
+        result = fromSummary(found);
+        return true;
+    }
+    if (context.store && context.store->find(key, found)) {
+        if (context.shared) {
+            context.shared->insert(key, found);
+        }
+        ++context.stats.storeHits;
+        result = fromSummary(found);
+        return true;
+    }
+    return false;
+}
+
+void recordSolved(const SolveContext& context, const StateKey& key, const CachedResult& result) {
+    if (context.shared) {
+        context.shared->insert(key, toSummary(result));
+    }
+    if (context.store) {
+        context.store->insert(key, toSummary(result));
+    }
+}
+
 CachedResult solveState(const BattleState& state,
-                        std::unordered_map<BattleState, CachedResult, StateHash>& cache);
+                        SolveContext& context);
 
 bool fleetHasMissiles(const std::vector<BattleShipProfile>& fleet) {
     for (const auto& ship : fleet) {
@@ -272,29 +742,39 @@ void clearMissiles(std::vector<BattleShipProfile>& fleet) {
     }
 }
 
-std::vector<int> collectInitiatives(const std::vector<BattleShipProfile>& humans,
-                                    const std::vector<BattleShipProfile>& aliens) {
-    std::vector<int> initiatives;
-    auto addFromFleet = [&](const std::vector<BattleShipProfile>& fleet) {
-        for (const auto& ship : fleet) {
-            for (const auto& weapon : ship.weapons) {
-                if (std::find(initiatives.begin(), initiatives.end(), weapon.initiative) == initiatives.end()) {
-                    initiatives.push_back(weapon.initiative);
-                }
-            }
+void addInitiatives(std::vector<int>& initiatives, const FleetColumns& side) {
+    for (const DiceGroup& group : side.weapons) {
+        if (std::find(initiatives.begin(), initiatives.end(), group.initiative) == initiatives.end()) {
+            initiatives.push_back(group.initiative);
         }
-    };
-    addFromFleet(humans);
-    addFromFleet(aliens);
+    }
+}
+
+std::vector<int> collectInitiatives(const FleetColumns& humans, const FleetColumns& aliens) {
+    std::vector<int> initiatives;
+    addInitiatives(initiatives, humans);
+    addInitiatives(initiatives, aliens);
     std::sort(initiatives.begin(), initiatives.end(), std::greater<>());
     return initiatives;
 }
 
+// Which sides shoot during a round. A retreating fleet holds its fire for the
+// round it spends disengaging.
+enum class Firing {
+    Both,
+    HumansOnly,
+    AliensOnly
+};
+
 void accumulateInitiativeOutcomes(const BattleState& current,
+                                  const FleetColumns& humanColumns,
+                                  const FleetColumns& alienColumns,
                                   const std::vector<int>& initiatives,
                                   size_t index,
                                   double probability,
-                                  std::unordered_map<BattleState, double, StateHash>& accumulator) {
+                                  std::unordered_map<BattleState, double, StateHash>& accumulator,
+                                  Firing firing,
+                                  ShieldModel shields) {
     if (initiatives.empty() || index >= initiatives.size()) {
         BattleState terminal = current;
         canonicalize(terminal);
@@ -303,8 +783,35 @@ void accumulateInitiativeOutcomes(const BattleState& current,
     }
 
     int initiative = initiatives[index];
-    auto humanHits = hitDistribution(current.humans, current.aliens, false, initiative);
-    auto alienHits = hitDistribution(current.aliens, current.humans, false, initiative);
+    if (shields == ShieldModel::PerTarget && (mixedShields(humanColumns) || mixedShields(alienColumns))) {
+        FleetOutcomes aliens = firing == Firing::AliensOnly
+                                   ? FleetOutcomes{{current.aliens, 1.0}}
+                                   : volleyOutcomes(current.aliens, alienColumns, {&humanColumns}, false, initiative,
+                                                    shields);
+        FleetOutcomes humans = firing == Firing::HumansOnly
+                                   ? FleetOutcomes{{current.humans, 1.0}}
+                                   : volleyOutcomes(current.humans, humanColumns, {&alienColumns}, false, initiative,
+                                                    shields);
+        for (const auto& [alienFleet, alienProbability] : aliens) {
+            for (const auto& [humanFleet, humanProbability] : humans) {
+                BattleState next{humanFleet, alienFleet, current.missilesResolved};
+                double pairProb = alienProbability * humanProbability;
+                if (index + 1 < initiatives.size()) {
+                    accumulateInitiativeOutcomes(next, buildColumns(next.humans), buildColumns(next.aliens),
+                                                 initiatives, index + 1, probability * pairProb, accumulator, firing,
+                                                 shields);
+                } else {
+                    canonicalize(next);
+                    accumulator[next] += probability * pairProb;
+                }
+            }
+        }
+        return;
+    }
+    auto humanHits = firing == Firing::AliensOnly ? std::vector<double>{1.0}
+                                                  : hitDistribution(humanColumns, alienColumns, false, initiative);
+    auto alienHits = firing == Firing::HumansOnly ? std::vector<double>{1.0}
+                                                  : hitDistribution(alienColumns, humanColumns, false, initiative);
 
     for (size_t h = 0; h < humanHits.size(); ++h) {
         for (size_t a = 0; a < alienHits.size(); ++a) {
@@ -313,52 +820,108 @@ void accumulateInitiativeOutcomes(const BattleState& current,
                 continue;
             }
             BattleState next = current;
-            next.humans = applyHits(current.humans, static_cast<int>(a));
-            next.aliens = applyHits(current.aliens, static_cast<int>(h));
-            accumulateInitiativeOutcomes(next, initiatives, index + 1, probability * pairProb, accumulator);
+            next.humans = applyHits(current.humans, humanColumns, static_cast<int>(a));
+            next.aliens = applyHits(current.aliens, alienColumns, static_cast<int>(h));
+            if (index + 1 < initiatives.size()) {
+                accumulateInitiativeOutcomes(next, buildColumns(next.humans), buildColumns(next.aliens),
+                                             initiatives, index + 1, probability * pairProb, accumulator, firing,
+                                             shields);
+            } else {
+                canonicalize(next);
+                accumulator[next] += probability * pairProb;
+            }
+        }
+    }
+}
+
+// Outcomes of the missile volley both sides fire before the first round, in
+// enumeration order; every successor has its missiles spent.
+std::vector<std::pair<BattleState, double>> missileOutcomes(const BattleState& state, ShieldModel shields) {
+    FleetColumns humanColumns = buildColumns(state.humans);
+    FleetColumns alienColumns = buildColumns(state.aliens);
+    if (shields == ShieldModel::PerTarget && (mixedShields(humanColumns) || mixedShields(alienColumns))) {
+        FleetOutcomes aliens = volleyOutcomes(state.aliens, alienColumns, {&humanColumns}, true, std::nullopt, shields);
+        FleetOutcomes humans = volleyOutcomes(state.humans, humanColumns, {&alienColumns}, true, std::nullopt, shields);
+        std::vector<std::pair<BattleState, double>> outcomes;
+        outcomes.reserve(aliens.size() * humans.size());
+        for (const auto& [alienFleet, alienProbability] : aliens) {
+            for (const auto& [humanFleet, humanProbability] : humans) {
+                BattleState next{humanFleet, alienFleet, true};
+                clearMissiles(next.humans);
+                clearMissiles(next.aliens);
+                canonicalize(next);
+                outcomes.emplace_back(std::move(next), alienProbability * humanProbability);
+            }
+        }
+        return outcomes;
+    }
+    auto humanHits = hitDistribution(humanColumns, alienColumns, true, std::nullopt);
+    auto alienHits = hitDistribution(alienColumns, humanColumns, true, std::nullopt);
+    std::vector<std::pair<BattleState, double>> outcomes;
+    outcomes.reserve(humanHits.size() * alienHits.size());
+    for (size_t h = 0; h < humanHits.size(); ++h) {
+        for (size_t a = 0; a < alienHits.size(); ++a) {
+            double pairProb = humanHits[h] * alienHits[a];
+            if (pairProb <= 0.0) {
+                continue;
+            }
+            BattleState next = state;
+            next.humans = applyHits(state.humans, humanColumns, static_cast<int>(a));
+            next.aliens = applyHits(state.aliens, alienColumns, static_cast<int>(h));
+            next.missilesResolved = true;
+            clearMissiles(next.humans);
+            clearMissiles(next.aliens);
+            canonicalize(next);
+            outcomes.emplace_back(std::move(next), pairProb);
         }
     }
+    return outcomes;
+}
+
+// Distribution of canonical states after one regular round. The state itself
+// appears when the round can leave it unchanged.
+std::unordered_map<BattleState, double, StateHash> roundOutcomes(const BattleState& state,
+                                                                 ShieldModel shields,
+                                                                 Firing firing = Firing::Both) {
+    FleetColumns humanColumns = buildColumns(state.humans);
+    FleetColumns alienColumns = buildColumns(state.aliens);
+    std::vector<int> initiatives = collectInitiatives(humanColumns, alienColumns);
+    std::unordered_map<BattleState, double, StateHash> nextStates;
+    if (initiatives.empty()) {
+        BattleState terminal = state;
+        canonicalize(terminal);
+        nextStates[terminal] = 1.0;
+    } else {
+        accumulateInitiativeOutcomes(state, humanColumns, alienColumns, initiatives, 0, 1.0, nextStates, firing,
+                                     shields);
+    }
+    return nextStates;
 }
 
 CachedResult resolveMissilePhase(const BattleState& state,
-                                 std::unordered_map<BattleState, CachedResult, StateHash>& cache) {
+                                 SolveContext& context) {
     bool humanMissiles = fleetHasMissiles(state.humans);
     bool alienMissiles = fleetHasMissiles(state.aliens);
     if (!humanMissiles && !alienMissiles) {
         BattleState next = state;
         next.missilesResolved = true;
-        return solveState(next, cache);
+        return solveState(next, context);
     }
 
-    auto humanHits = hitDistribution(state.humans, state.aliens, true, std::nullopt);
-    auto alienHits = hitDistribution(state.aliens, state.humans, true, std::nullopt);
-
     double progressProbability = 0.0;
     double humanAccum = 0.0;
     double alienAccum = 0.0;
     double drawAccum = 0.0;
     double childRounds = 0.0;
 
-    for (size_t h = 0; h < humanHits.size(); ++h) {
-        for (size_t a = 0; a < alienHits.size(); ++a) {
-            double pairProb = humanHits[h] * alienHits[a];
-            if (pairProb <= 0.0) {
-                continue;
-            }
-            BattleState next = state;
-            next.humans = applyHits(state.humans, static_cast<int>(a));
-            next.aliens = applyHits(state.aliens, static_cast<int>(h));
-            next.missilesResolved = true;
-            clearMissiles(next.humans);
-            clearMissiles(next.aliens);
-            canonicalize(next);
-            CachedResult child = solveState(next, cache);
-            progressProbability += pairProb;
-            humanAccum += pairProb * child.humanWin;
-            alienAccum += pairProb * child.alienWin;
-            drawAccum += pairProb * child.draw;
-            childRounds += pairProb * child.expectedRounds;
-        }
+    for (const auto& [next, pairProb] : missileOutcomes(state, context.shields)) {
+        ++context.stats.transitions;
+        CachedResult child = solveState(next, context);
+        progressProbability += pairProb;
+        humanAccum += pairProb * child.humanWin;
+        alienAccum += pairProb * child.alienWin;
+        drawAccum += pairProb * child.draw;
+        childRounds += pairProb * child.expectedRounds;
     }
 
     CachedResult result;
@@ -373,8 +936,14 @@ CachedResult resolveMissilePhase(const BattleState& state,
     return result;
 }
 
+void memoize(SolveContext& context, const BattleState& state, const CachedResult& result) {
+    if (context.cache.emplace(state, result).second) {
+        context.memoBytes += memoEntryBytes(state);
+    }
+}
+
 CachedResult solveState(const BattleState& state,
-                        std::unordered_map<BattleState, CachedResult, StateHash>& cache) {
+                        SolveContext& context) {
     if (state.humans.empty() && state.aliens.empty()) {
         return {0.0, 0.0, 1.0, 0.0};
     }
@@ -385,14 +954,35 @@ CachedResult solveState(const BattleState& state,
         return {0.0, 1.0, 0.0, 0.0};
     }
 
-    auto it = cache.find(state);
-    if (it != cache.end()) {
+    auto it = context.cache.find(state);
+    if (it != context.cache.end()) {
+        ++context.stats.memoHits;
         return it->second;
     }
 
+    if (context.stop.stop_requested()) {
+        throw SimulationCancelled();
+    }
+
+    std::optional<StateKey> sharedKey;
+    if (context.shared || context.store) {
+        sharedKey = persistentKey(state, context.shields);
+        CachedResult solved;
+        if (lookupSolved(context, *sharedKey, solved)) {
+            memoize(context, state, solved);
+            return solved;
+        }
+    }
+
+    if (++context.stats.statesExpanded % kProgressInterval == 0 && context.progress) {
+        publishStats(*context.progress, context.stats, context.memoBytes, context.shared);
+    }
     if (!state.missilesResolved) {
-        CachedResult missileResult = resolveMissilePhase(state, cache);
-        cache.emplace(state, missileResult);
+        CachedResult missileResult = resolveMissilePhase(state, context);
+        memoize(context, state, missileResult);
+        if (sharedKey) {
+            recordSolved(context, *sharedKey, missileResult);
+        }
         return missileResult;
     }
 
@@ -403,15 +993,8 @@ CachedResult solveState(const BattleState& state,
     double drawAccum = 0.0;
     double childRounds = 0.0;
 
-    std::vector<int> initiatives = collectInitiatives(state.humans, state.aliens);
-    std::unordered_map<BattleState, double, StateHash> nextStates;
-    if (initiatives.empty()) {
-        BattleState terminal = state;
-        canonicalize(terminal);
-        nextStates[terminal] = 1.0;
-    } else {
-        accumulateInitiativeOutcomes(state, initiatives, 0, 1.0, nextStates);
-    }
+    std::unordered_map<BattleState, double, StateHash> nextStates = roundOutcomes(state, context.shields);
+    context.stats.transitions += nextStates.size();
 
     for (const auto& entry : nextStates) {
         const BattleState& next = entry.first;
@@ -423,7 +1006,7 @@ CachedResult solveState(const BattleState& state,
             stayProbability += pairProb;
             continue;
         }
-        CachedResult child = solveState(next, cache);
+        CachedResult child = solveState(next, context);
         progressProbability += pairProb;
         humanAccum += pairProb * child.humanWin;
         alienAccum += pairProb * child.alienWin;
@@ -442,39 +1025,670 @@ CachedResult solveState(const BattleState& state,
         result.expectedRounds = (1.0 + childRounds) / progressProbability;
     }
 
-    cache.emplace(state, result);
+    memoize(context, state, result);
+    if (sharedKey) {
+        recordSolved(context, *sharedKey, result);
+    }
     return result;
 }
 
-BattleState buildState(const std::vector<ShipLoadout>& humans,
-                       const std::vector<ShipLoadout>& aliens) {
-    auto limitForClass = [](ShipClass cls) {
-        switch (cls) {
-            case ShipClass::Interceptor:
-                return 8;
-            case ShipClass::Cruiser:
-                return 4;
-            case ShipClass::Dreadnought:
-                return 2;
-            case ShipClass::Starbase:
-                return 1;
-            default:
-                return std::numeric_limits<int>::max();
-        }
-    };
+// Horizon-limited solving memoizes on the state and the rounds still allowed,
+// since the same state has a different outcome distribution for each horizon.
+struct HorizonKey {
+    BattleState state;
+    int rounds = 0;
 
-    auto makeProfile = [](const ShipLoadout& ship) {
-        BattleShipProfile profile;
-        const ShipDesign* design = ship.design();
-        ShipDerivedStats stats = ship.derivedStats();
-        profile.hull = std::max(1, stats.hull);
-        profile.computer = stats.computer;
-        profile.shield = stats.shield;
-        profile.shipClass = design ? design->shipClass : ShipClass::Other;
-        int initiativeBonus = stats.initiativeBonus;
+    bool operator==(const HorizonKey& other) const { return rounds == other.rounds && state == other.state; }
+};
 
-        if (design && design->baseDice > 0) {
-            WeaponStats baseWeapon;
+struct HorizonKeyHash {
+    std::size_t operator()(const HorizonKey& key) const noexcept {
+        return StateHash{}(key.state) ^ (static_cast<std::size_t>(key.rounds) * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
+struct HorizonContext {
+    std::unordered_map<HorizonKey, HorizonSummary, HorizonKeyHash> cache;
+    ShieldModel shields = ShieldModel::Averaged;
+    std::stop_token stop;
+    SolveStats stats;
+};
+
+void accumulate(HorizonSummary& total, const HorizonSummary& child, double probability) {
+    total.humanWin += probability * child.humanWin;
+    total.alienWin += probability * child.alienWin;
+    total.draw += probability * child.draw;
+    total.stillFighting += probability * child.stillFighting;
+    total.expectedRounds += probability * child.expectedRounds;
+}
+
+// Outcome distribution after at most `rounds` more regular rounds. Mirrors
+// solveState(), except that a self-loop spends a round instead of being folded
+// away, and a battle that reaches the horizon ends as still fighting.
+HorizonSummary solveHorizon(const BattleState& state, int rounds, HorizonContext& context) {
+    if (state.humans.empty() && state.aliens.empty()) {
+        return {0.0, 0.0, 1.0, 0.0, 0.0};
+    }
+    if (state.aliens.empty()) {
+        return {1.0, 0.0, 0.0, 0.0, 0.0};
+    }
+    if (state.humans.empty()) {
+        return {0.0, 1.0, 0.0, 0.0, 0.0};
+    }
+
+    if (!state.missilesResolved) {
+        // The volley precedes the first round and does not count against the horizon.
+        if (!fleetHasMissiles(state.humans) && !fleetHasMissiles(state.aliens)) {
+            BattleState next = state;
+            next.missilesResolved = true;
+            return solveHorizon(next, rounds, context);
+        }
+        HorizonSummary total;
+        for (const auto& [next, probability] : missileOutcomes(state, context.shields)) {
+            ++context.stats.transitions;
+            accumulate(total, solveHorizon(next, rounds, context), probability);
+        }
+        return total;
+    }
+    if (rounds <= 0) {
+        return {0.0, 0.0, 0.0, 1.0, 0.0};
+    }
+
+    HorizonKey key{state, rounds};
+    auto it = context.cache.find(key);
+    if (it != context.cache.end()) {
+        ++context.stats.memoHits;
+        return it->second;
+    }
+    if (context.stop.stop_requested()) {
+        throw SimulationCancelled();
+    }
+
+    ++context.stats.statesExpanded;
+    std::unordered_map<BattleState, double, StateHash> nextStates = roundOutcomes(state, context.shields);
+    context.stats.transitions += nextStates.size();
+    auto stay = nextStates.find(state);
+    double stayProbability = stay == nextStates.end() ? 0.0 : stay->second;
+
+    HorizonSummary result;
+    if (1.0 - stayProbability <= std::numeric_limits<double>::epsilon()) {
+        // Stalemate configuration, a draw exactly as in the unbounded solver.
+        result = {0.0, 0.0, 1.0, 0.0, 0.0};
+    } else {
+        for (const auto& [next, probability] : nextStates) {
+            if (probability > 0.0) {
+                accumulate(result, solveHorizon(next, rounds - 1, context), probability);
+            }
+        }
+        result.expectedRounds += 1.0;
+    }
+    context.cache.emplace(std::move(key), result);
+    return result;
+}
+
+// Retreat-aware solving. A fleet may withdraw at the start of any round after
+// the missile volley: it holds fire for that round while the enemy shoots at it
+// with every initiative bucket, and whatever survives escapes. Fleets that
+// include a starbase cannot withdraw. Humans decide before aliens each round.
+//
+// Hull only ever goes down, so apart from self-loops the reachable states form
+// a DAG, and the memoized recursion below evaluates every state once its
+// successors are known; that is value iteration converged in one sweep. A
+// self-loop keeps the decisions of the state it returns to, so it is folded
+// exactly like in solveState().
+enum class Side {
+    Humans,
+    Aliens
+};
+
+struct RetreatContext {
+    std::unordered_map<BattleState, RetreatSummary, StateHash> cache;
+    RetreatPolicy humanPolicy;
+    RetreatPolicy alienPolicy;
+    SolveContext plain;  // no-retreat values for threshold policies
+    SolveStats stats;
+};
+
+// Retreat values depend on both policies, so they are keyed by the state salted
+// with the parts of each policy its rule reads. A RetreatSummary takes two
+// BattleSummary slots in the shared cache and the store: the outcome key holds
+// win, loss, draw and rounds, and the escape key the two retreat chances.
+struct RetreatKeys {
+    StateKey outcome;
+    StateKey escape;
+};
+
+std::uint64_t policySalt(const RetreatPolicy& policy) {
+    auto bits = [](double value) { return std::bit_cast<std::uint64_t>(value); };
+    switch (policy.rule) {
+        case RetreatRule::Never:
+            return 1;
+        case RetreatRule::Threshold:
+            return 2 ^ (bits(policy.threshold) * 0x9e3779b97f4a7c15ULL);
+        case RetreatRule::Optimal:
+            return 3 ^ (bits(policy.escapeValue) * 0x9e3779b97f4a7c15ULL);
+    }
+    return 0;
+}
+
+RetreatKeys retreatKeys(const BattleState& state, const RetreatContext& context) {
+    std::uint64_t salt = policySalt(context.humanPolicy);
+    salt ^= policySalt(context.alienPolicy) + 0x7f4a7c159e3779b9ULL + (salt << 6) + (salt >> 2);
+    StateKey outcome = persistentKey(state, context.plain.shields, salt);
+    StateKey escape = persistentKey(state, context.plain.shields, salt ^ 0xe5ca9e5ca9e5ca9eULL);
+    return {outcome, escape};
+}
+
+// Both halves must be present; a shard cleared between the two inserts is a miss.
+bool lookupRetreat(RetreatContext& context, const RetreatKeys& keys, RetreatSummary& result) {
+    BattleSummary outcome;
+    BattleSummary escape;
+    const SolveCache* shared = context.plain.shared;
+    if (shared && shared->find(keys.outcome, outcome) && shared->find(keys.escape, escape)) {
+        ++context.stats.sharedHits;
+    } else if (context.plain.store && context.plain.store->find(keys.outcome, outcome) &&
+               context.plain.store->find(keys.escape, escape)) {
+        if (context.plain.shared) {
+            context.plain.shared->insert(keys.outcome, outcome);
+            context.plain.shared->insert(keys.escape, escape);
+        }
+        ++context.stats.storeHits;
+    } else {
+        return false;
+    }
+    result = {outcome.humanWin, outcome.alienWin, outcome.draw, escape.humanWin, escape.alienWin,
+              outcome.expectedRounds};
+    return true;
+}
+
+void recordRetreat(const RetreatContext& context, const RetreatKeys& keys, const RetreatSummary& result) {
+    BattleSummary outcome{result.humanWin, result.alienWin, result.draw, result.expectedRounds};
+    BattleSummary escape{result.humanRetreat, result.alienRetreat, 0.0, 0.0};
+    if (context.plain.shared) {
+        context.plain.shared->insert(keys.outcome, outcome);
+        context.plain.shared->insert(keys.escape, escape);
+    }
+    if (context.plain.store) {
+        context.plain.store->insert(keys.outcome, outcome);
+        context.plain.store->insert(keys.escape, escape);
+    }
+}
+
+bool canRetreat(const std::vector<BattleShipProfile>& fleet) {
+    return !fleet.empty() && std::none_of(fleet.begin(), fleet.end(), [](const BattleShipProfile& ship) {
+        return ship.shipClass == ShipClass::Starbase;
+    });
+}
+
+// Holding the field counts as a win whether the enemy was destroyed or fled.
+double utility(const RetreatSummary& summary, Side side, const RetreatPolicy& policy) {
+    return side == Side::Humans
+               ? summary.humanWin + summary.alienRetreat + policy.escapeValue * summary.humanRetreat
+               : summary.alienWin + summary.humanRetreat + policy.escapeValue * summary.alienRetreat;
+}
+
+// The round a fleet spends disengaging, after which the battle is over.
+RetreatSummary disengage(const BattleState& state, Side side, RetreatContext& context) {
+    auto outcomes =
+        roundOutcomes(state, context.plain.shields, side == Side::Humans ? Firing::AliensOnly : Firing::HumansOnly);
+    context.stats.transitions += outcomes.size();
+    RetreatSummary result;
+    result.expectedRounds = 1.0;
+    for (const auto& [next, probability] : outcomes) {
+        if (side == Side::Humans) {
+            (next.humans.empty() ? result.alienWin : result.humanRetreat) += probability;
+        } else {
+            (next.aliens.empty() ? result.humanWin : result.alienRetreat) += probability;
+        }
+    }
+    return result;
+}
+
+bool thresholdSaysRetreat(const BattleState& state, Side side, RetreatContext& context) {
+    CachedResult plain = solveState(state, context.plain);
+    const RetreatPolicy& policy = side == Side::Humans ? context.humanPolicy : context.alienPolicy;
+    return (side == Side::Humans ? plain.humanWin : plain.alienWin) < policy.threshold;
+}
+
+RetreatSummary solveRetreat(const BattleState& state, RetreatContext& context);
+
+// Both fleets stay for this round; the next round's decisions are made again.
+RetreatSummary fightRound(const BattleState& state, RetreatContext& context) {
+    ++context.stats.statesExpanded;
+    std::unordered_map<BattleState, double, StateHash> nextStates = roundOutcomes(state, context.plain.shields);
+    context.stats.transitions += nextStates.size();
+    double progressProbability = 0.0;
+    RetreatSummary total;
+    for (const auto& [next, probability] : nextStates) {
+        if (probability <= 0.0 || next == state) {
+            continue;
+        }
+        RetreatSummary child = solveRetreat(next, context);
+        progressProbability += probability;
+        total.humanWin += probability * child.humanWin;
+        total.alienWin += probability * child.alienWin;
+        total.draw += probability * child.draw;
+        total.humanRetreat += probability * child.humanRetreat;
+        total.alienRetreat += probability * child.alienRetreat;
+        total.expectedRounds += probability * child.expectedRounds;
+    }
+    if (progressProbability <= std::numeric_limits<double>::epsilon()) {
+        return {0.0, 0.0, 1.0, 0.0, 0.0, 0.0};
+    }
+    total.humanWin /= progressProbability;
+    total.alienWin /= progressProbability;
+    total.draw /= progressProbability;
+    total.humanRetreat /= progressProbability;
+    total.alienRetreat /= progressProbability;
+    total.expectedRounds = (1.0 + total.expectedRounds) / progressProbability;
+    return total;
+}
+
+RetreatSummary solveRetreat(const BattleState& state, RetreatContext& context) {
+    if (state.humans.empty() && state.aliens.empty()) {
+        return {0.0, 0.0, 1.0, 0.0, 0.0, 0.0};
+    }
+    if (state.aliens.empty()) {
+        return {1.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    }
+    if (state.humans.empty()) {
+        return {0.0, 1.0, 0.0, 0.0, 0.0, 0.0};
+    }
+    auto it = context.cache.find(state);
+    if (it != context.cache.end()) {
+        ++context.stats.memoHits;
+        return it->second;
+    }
+    if (context.plain.stop.stop_requested()) {
+        throw SimulationCancelled();
+    }
+
+    RetreatSummary result;
+    std::optional<RetreatKeys> keys;
+    if (context.plain.shared || context.plain.store) {
+        keys = retreatKeys(state, context);
+        if (lookupRetreat(context, *keys, result)) {
+            context.cache.emplace(state, result);
+            return result;
+        }
+    }
+    if (!state.missilesResolved) {
+        BattleState resolved = state;
+        resolved.missilesResolved = true;
+        if (!fleetHasMissiles(state.humans) && !fleetHasMissiles(state.aliens)) {
+            result = solveRetreat(resolved, context);
+        } else {
+            double total = 0.0;
+            for (const auto& [next, probability] : missileOutcomes(state, context.plain.shields)) {
+                ++context.stats.transitions;
+                RetreatSummary child = solveRetreat(next, context);
+                total += probability;
+                result.humanWin += probability * child.humanWin;
+                result.alienWin += probability * child.alienWin;
+                result.draw += probability * child.draw;
+                result.humanRetreat += probability * child.humanRetreat;
+                result.alienRetreat += probability * child.alienRetreat;
+                result.expectedRounds += probability * child.expectedRounds;
+            }
+            if (total <= std::numeric_limits<double>::epsilon()) {
+                result = {0.0, 0.0, 1.0, 0.0, 0.0, 0.0};
+            } else {
+                result.humanWin /= total;
+                result.alienWin /= total;
+                result.draw /= total;
+                result.humanRetreat /= total;
+                result.alienRetreat /= total;
+                result.expectedRounds /= total;
+            }
+        }
+        context.cache.emplace(state, result);
+        if (keys) {
+            recordRetreat(context, *keys, result);
+        }
+        return result;
+    }
+
+    const RetreatPolicy& humans = context.humanPolicy;
+    const RetreatPolicy& aliens = context.alienPolicy;
+    bool humansMay = humans.rule != RetreatRule::Never && canRetreat(state.humans);
+    bool aliensMay = aliens.rule != RetreatRule::Never && canRetreat(state.aliens);
+    if (humansMay && humans.rule == RetreatRule::Threshold && thresholdSaysRetreat(state, Side::Humans, context)) {
+        result = disengage(state, Side::Humans, context);
+    } else {
+        // What happens if the humans stay: the aliens' choice, then the round.
+        if (aliensMay && aliens.rule == RetreatRule::Threshold && thresholdSaysRetreat(state, Side::Aliens, context)) {
+            result = disengage(state, Side::Aliens, context);
+        } else {
+            result = fightRound(state, context);
+            if (aliensMay && aliens.rule == RetreatRule::Optimal) {
+                RetreatSummary away = disengage(state, Side::Aliens, context);
+                if (utility(away, Side::Aliens, aliens) > utility(result, Side::Aliens, aliens) + 1e-12) {
+                    result = away;
+                }
+            }
+        }
+        if (humansMay && humans.rule == RetreatRule::Optimal) {
+            RetreatSummary away = disengage(state, Side::Humans, context);
+            if (utility(away, Side::Humans, humans) > utility(result, Side::Humans, humans) + 1e-12) {
+                result = away;
+            }
+        }
+    }
+    context.cache.emplace(state, result);
+    if (keys) {
+        recordRetreat(context, *keys, result);
+    }
+    return result;
+}
+
+// Battles between more than two fleets. Every fleet fights every other one; in
+// each volley a fleet sends all of its hits at a single enemy fleet picked by
+// its TargetRule, and hits that several fleets aim at the same target add up
+// before damage is assigned. When only two fleets are left the battle is
+// handed to solveState(), so its memo, the shared cache and the solution
+// store all apply to the two-sided endgames.
+struct MultiBattleState {
+    std::vector<std::vector<BattleShipProfile>> sides;  // destroyed fleets stay, empty
+    bool missilesResolved = false;
+
+    bool operator==(const MultiBattleState& other) const {
+        return missilesResolved == other.missilesResolved && sides == other.sides;
+    }
+};
+
+struct MultiStateHash {
+    std::size_t operator()(const MultiBattleState& state) const noexcept {
+        std::size_t hash = state.sides.size();
+        for (const auto& fleet : state.sides) {
+            hash ^= hashFleet(fleet) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        hash ^= static_cast<std::size_t>(state.missilesResolved ? 0xFFFF : 0x1);
+        return hash;
+    }
+};
+
+struct MultiResult {
+    std::vector<double> win;
+    double draw = 0.0;
+    double expectedRounds = 0.0;
+};
+
+struct MultiContext {
+    std::unordered_map<MultiBattleState, MultiResult, MultiStateHash> cache;
+    std::vector<TargetRule> targeting;
+    SolveContext pair;  // endgames with two fleets left
+    SolveStats stats;
+};
+
+void canonicalize(MultiBattleState& state) {
+    for (auto& fleet : state.sides) {
+        std::sort(fleet.begin(), fleet.end(), battleCompare);
+    }
+}
+
+std::vector<FleetColumns> buildColumns(const MultiBattleState& state) {
+    std::vector<FleetColumns> columns;
+    columns.reserve(state.sides.size());
+    for (const auto& fleet : state.sides) {
+        columns.push_back(buildColumns(fleet));
+    }
+    return columns;
+}
+
+// The enemy fleet `attacker` fires at, or -1 once none is left. Ties go to the
+// lower side index.
+int chooseTarget(const std::vector<FleetColumns>& columns, size_t attacker, TargetRule rule) {
+    int target = -1;
+    int bestScore = 0;
+    for (size_t side = 0; side < columns.size(); ++side) {
+        if (side == attacker || columns[side].size() == 0) {
+            continue;
+        }
+        const FleetColumns& fleet = columns[side];
+        int score = rule == TargetRule::Threat ? std::accumulate(fleet.dice.begin(), fleet.dice.end(), 0)
+                                               : -std::accumulate(fleet.hull.begin(), fleet.hull.end(), 0);
+        if (target < 0 || score > bestScore) {
+            target = static_cast<int>(side);
+            bestScore = score;
+        }
+    }
+    return target;
+}
+
+// How one volley (the missiles, or one initiative bucket of regular weapons)
+// can leave each fleet: every attacker's hits go to the fleet it targets.
+std::vector<FleetOutcomes> volleyAtEachFleet(const MultiBattleState& state,
+                                             const std::vector<FleetColumns>& columns,
+                                             const std::vector<TargetRule>& targeting,
+                                             ShieldModel shields,
+                                             bool missilesOnly,
+                                             std::optional<int> initiativeFilter) {
+    std::vector<std::vector<const FleetColumns*>> attackers(columns.size());
+    for (size_t side = 0; side < columns.size(); ++side) {
+        int target = chooseTarget(columns, side, targeting[side]);
+        if (target >= 0) {
+            attackers[static_cast<size_t>(target)].push_back(&columns[side]);
+        }
+    }
+    std::vector<FleetOutcomes> outcomes;
+    outcomes.reserve(columns.size());
+    for (size_t side = 0; side < columns.size(); ++side) {
+        outcomes.push_back(attackers[side].empty()
+                               ? FleetOutcomes{{state.sides[side], 1.0}}
+                               : volleyOutcomes(state.sides[side], columns[side], attackers[side], missilesOnly,
+                                                initiativeFilter, shields));
+    }
+    return outcomes;
+}
+
+// Calls visit(next, probability) for every combination of the fleets' outcomes.
+template <typename Visit>
+void forEachVolleyOutcome(const MultiBattleState& state, const std::vector<FleetOutcomes>& outcomes, Visit&& visit) {
+    std::vector<size_t> choice(outcomes.size(), 0);
+    while (true) {
+        MultiBattleState next;
+        next.missilesResolved = state.missilesResolved;
+        next.sides.reserve(outcomes.size());
+        double probability = 1.0;
+        for (size_t side = 0; side < choice.size(); ++side) {
+            next.sides.push_back(outcomes[side][choice[side]].first);
+            probability *= outcomes[side][choice[side]].second;
+        }
+        visit(std::move(next), probability);
+        size_t side = 0;
+        while (side < choice.size() && ++choice[side] == outcomes[side].size()) {
+            choice[side++] = 0;
+        }
+        if (side == choice.size()) {
+            return;
+        }
+    }
+}
+
+void accumulateMultiOutcomes(const MultiBattleState& current,
+                             const std::vector<FleetColumns>& columns,
+                             const std::vector<int>& initiatives,
+                             size_t index,
+                             double probability,
+                             const std::vector<TargetRule>& targeting,
+                             ShieldModel shields,
+                             std::unordered_map<MultiBattleState, double, MultiStateHash>& accumulator) {
+    auto outcomes = volleyAtEachFleet(current, columns, targeting, shields, false, initiatives[index]);
+    forEachVolleyOutcome(current, outcomes, [&](MultiBattleState next, double volleyProbability) {
+        if (index + 1 < initiatives.size()) {
+            accumulateMultiOutcomes(next, buildColumns(next), initiatives, index + 1,
+                                    probability * volleyProbability, targeting, shields, accumulator);
+        } else {
+            canonicalize(next);
+            accumulator[next] += probability * volleyProbability;
+        }
+    });
+}
+
+std::unordered_map<MultiBattleState, double, MultiStateHash> multiRoundOutcomes(
+    const MultiBattleState& state, const std::vector<TargetRule>& targeting, ShieldModel shields) {
+    std::vector<FleetColumns> columns = buildColumns(state);
+    std::vector<int> initiatives;
+    for (const FleetColumns& side : columns) {
+        addInitiatives(initiatives, side);
+    }
+    std::sort(initiatives.begin(), initiatives.end(), std::greater<>());
+    std::unordered_map<MultiBattleState, double, MultiStateHash> nextStates;
+    if (initiatives.empty()) {
+        nextStates[state] = 1.0;
+    } else {
+        accumulateMultiOutcomes(state, columns, initiatives, 0, 1.0, targeting, shields, nextStates);
+    }
+    return nextStates;
+}
+
+std::vector<std::pair<MultiBattleState, double>> multiMissileOutcomes(const MultiBattleState& state,
+                                                                      const std::vector<TargetRule>& targeting,
+                                                                      ShieldModel shields) {
+    std::vector<FleetColumns> columns = buildColumns(state);
+    auto volley = volleyAtEachFleet(state, columns, targeting, shields, true, std::nullopt);
+    std::vector<std::pair<MultiBattleState, double>> outcomes;
+    forEachVolleyOutcome(state, volley, [&](MultiBattleState next, double probability) {
+        next.missilesResolved = true;
+        for (auto& fleet : next.sides) {
+            clearMissiles(fleet);
+        }
+        canonicalize(next);
+        outcomes.emplace_back(std::move(next), probability);
+    });
+    return outcomes;
+}
+
+void accumulate(MultiResult& total, const MultiResult& child, double probability) {
+    for (size_t side = 0; side < total.win.size(); ++side) {
+        total.win[side] += probability * child.win[side];
+    }
+    total.draw += probability * child.draw;
+    total.expectedRounds += probability * child.expectedRounds;
+}
+
+MultiResult solveMulti(const MultiBattleState& state, MultiContext& context) {
+    const size_t count = state.sides.size();
+    std::vector<size_t> alive;
+    for (size_t side = 0; side < count; ++side) {
+        if (!state.sides[side].empty()) {
+            alive.push_back(side);
+        }
+    }
+    MultiResult result;
+    result.win.assign(count, 0.0);
+    if (alive.empty()) {
+        result.draw = 1.0;
+        return result;
+    }
+    if (alive.size() == 1) {
+        result.win[alive[0]] = 1.0;
+        return result;
+    }
+    if (alive.size() == 2) {
+        BattleState pair{state.sides[alive[0]], state.sides[alive[1]], state.missilesResolved};
+        CachedResult solved = solveState(pair, context.pair);
+        result.win[alive[0]] = solved.humanWin;
+        result.win[alive[1]] = solved.alienWin;
+        result.draw = solved.draw;
+        result.expectedRounds = solved.expectedRounds;
+        return result;
+    }
+
+    auto it = context.cache.find(state);
+    if (it != context.cache.end()) {
+        ++context.stats.memoHits;
+        return it->second;
+    }
+    if (context.pair.stop.stop_requested()) {
+        throw SimulationCancelled();
+    }
+
+    ++context.stats.statesExpanded;
+    double progressProbability = 0.0;
+    if (!state.missilesResolved) {
+        bool anyMissiles = std::any_of(state.sides.begin(), state.sides.end(), fleetHasMissiles);
+        if (!anyMissiles) {
+            MultiBattleState next = state;
+            next.missilesResolved = true;
+            result = solveMulti(next, context);
+            context.cache.emplace(state, result);
+            return result;
+        }
+        for (const auto& [next, probability] : multiMissileOutcomes(state, context.targeting, context.pair.shields)) {
+            ++context.stats.transitions;
+            accumulate(result, solveMulti(next, context), probability);
+            progressProbability += probability;
+        }
+    } else {
+        auto nextStates = multiRoundOutcomes(state, context.targeting, context.pair.shields);
+        context.stats.transitions += nextStates.size();
+        for (const auto& [next, probability] : nextStates) {
+            if (probability <= 0.0 || next == state) {
+                continue;
+            }
+            accumulate(result, solveMulti(next, context), probability);
+            progressProbability += probability;
+        }
+        result.expectedRounds += 1.0;
+    }
+
+    if (progressProbability <= std::numeric_limits<double>::epsilon()) {
+        // Stalemate configuration, treat as a draw.
+        result = MultiResult{std::vector<double>(count, 0.0), 1.0, 0.0};
+    } else {
+        for (double& win : result.win) {
+            win /= progressProbability;
+        }
+        result.draw /= progressProbability;
+        result.expectedRounds /= progressProbability;
+    }
+    context.cache.emplace(state, result);
+    return result;
+}
+
+// Weapons that roll identically are folded into one entry so that each
+// archetype carries its per-initiative dice totals precomputed, and two ships
+// fitted with the same parts in a different slot order compare equal.
+void mergeWeapons(std::vector<WeaponStats>& weapons) {
+    std::sort(weapons.begin(), weapons.end(), [](const WeaponStats& a, const WeaponStats& b) {
+        if (a.initiative != b.initiative) return a.initiative > b.initiative;
+        if (a.dieSides != b.dieSides) return a.dieSides < b.dieSides;
+        if (a.baseToHit != b.baseToHit) return a.baseToHit < b.baseToHit;
+        return a.oneShot < b.oneShot;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < weapons.size(); ++i) {
+        const WeaponStats& weapon = weapons[i];
+        if (out > 0 && weapons[out - 1].initiative == weapon.initiative &&
+            weapons[out - 1].dieSides == weapon.dieSides && weapons[out - 1].baseToHit == weapon.baseToHit &&
+            weapons[out - 1].missile == weapon.missile && weapons[out - 1].oneShot == weapon.oneShot) {
+            weapons[out - 1].dice += weapon.dice;
+        } else {
+            weapons[out++] = weapon;
+        }
+    }
+    weapons.resize(out);
+}
+
+// Statuses, when given, apply by index: destroyed ships are left out before
+// the class limits are counted, damaged ones start with the hull they have
+// left (never more than full), and a spent flux shield is dropped.
+std::vector<BattleShipProfile> buildFleet(const std::vector<ShipLoadout>& fleet,
+                                          const std::vector<ShipStatus>* status = nullptr) {
+
+    auto makeProfile = [](const ShipLoadout& ship) {
+        BattleShipProfile profile;
+        const ShipDesign* design = ship.design();
+        const ShipDerivedStats& stats = ship.derivedStats();
+        profile.hull = std::max(1, stats.hull);
+        profile.computer = stats.computer;
+        profile.shield = stats.shield;
+        profile.shipClass = design ? design->shipClass : ShipClass::Other;
+        int initiativeBonus = stats.initiativeBonus;
+
+        if (design && design->baseDice > 0) {
+            WeaponStats baseWeapon;
             baseWeapon.dice = design->baseDice;
             baseWeapon.dieSides = design->baseWeaponDieSides;
             baseWeapon.baseToHit = design->baseWeaponHit;
@@ -503,55 +1717,545 @@ BattleState buildState(const std::vector<ShipLoadout>& humans,
                 }
             }
         }
+        mergeWeapons(profile.weapons);
+        mergeWeapons(profile.missiles);
+        profile.weaponDice = totalDice(profile.weapons);
         return profile;
     };
 
-    auto toProfiles = [&](const std::vector<ShipLoadout>& fleet) {
-        std::vector<BattleShipProfile> profiles;
-        profiles.reserve(fleet.size());
-        std::array<int, 5> counts{};
-        for (const ShipLoadout& ship : fleet) {
-            if (!ship.isValid()) {
-                continue;
-            }
-            const ShipDesign* design = ship.design();
-            ShipClass cls = design ? design->shipClass : ShipClass::Other;
-            int limit = limitForClass(cls);
-            size_t idx = static_cast<size_t>(cls);
-            if (idx >= counts.size()) {
-                idx = counts.size() - 1;
+    std::vector<BattleShipProfile> profiles;
+    profiles.reserve(fleet.size());
+    std::array<int, 5> counts{};
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        const ShipLoadout& ship = fleet[i];
+        const ShipStatus* shipStatus = status && i < status->size() ? &(*status)[i] : nullptr;
+        if (!ship.isValid() || (shipStatus && shipStatus->hull && *shipStatus->hull <= 0)) {
+            continue;
+        }
+        const ShipDesign* design = ship.design();
+        ShipClass cls = design ? design->shipClass : ShipClass::Other;
+        int limit = shipClassLimit(cls);
+        size_t idx = static_cast<size_t>(cls);
+        if (idx >= counts.size()) {
+            idx = counts.size() - 1;
+        }
+        if (counts[idx] >= limit) {
+            continue;
+        }
+        counts[idx] += 1;
+        profiles.push_back(makeProfile(ship));
+        if (shipStatus) {
+            if (shipStatus->hull) {
+                profiles.back().hull = std::min(profiles.back().hull, *shipStatus->hull);
             }
-            if (counts[idx] >= limit) {
-                continue;
+            if (shipStatus->fluxSpent) {
+                profiles.back().fluxShield = false;
             }
-            counts[idx] += 1;
-            profiles.push_back(makeProfile(ship));
         }
-        std::sort(profiles.begin(), profiles.end(), battleCompare);
-        return profiles;
-    };
+    }
+    std::sort(profiles.begin(), profiles.end(), battleCompare);
+    return profiles;
+}
 
+BattleState buildState(const std::vector<ShipLoadout>& humans,
+                       const std::vector<ShipLoadout>& aliens) {
     BattleState state;
-    state.humans = toProfiles(humans);
-    state.aliens = toProfiles(aliens);
+    state.humans = buildFleet(humans);
+    state.aliens = buildFleet(aliens);
     state.missilesResolved = false;
     return state;
 }
 
+BattleState buildState(const BattlePosition& position) {
+    BattleState state;
+    state.humans = buildFleet(position.humans, &position.humanStatus);
+    state.aliens = buildFleet(position.aliens, &position.alienStatus);
+    state.missilesResolved = position.missilesResolved;
+    return state;
+}
+
+
+// Monte Carlo counterpart of hitDistribution(): rolls every die individually
+// instead of pooling groups into binomials, so the exact solver's probability
+// arithmetic is checked by an independent path.
+int rollHits(const FleetColumns& attackers,
+             const FleetColumns& defenders,
+             bool missilesOnly,
+             std::optional<int> initiativeFilter,
+             std::mt19937_64& random) {
+    if (attackers.size() == 0 || defenders.size() == 0) {
+        return 0;
+    }
+    int hits = 0;
+    for (const DiceGroup& group : missilesOnly ? attackers.missiles : attackers.weapons) {
+        if (initiativeFilter.has_value() && group.initiative != *initiativeFilter) {
+            continue;
+        }
+        int maxRoll = std::max(group.dieSides, 2);
+        int threshold = std::clamp(group.toHit + defenders.roundedShield, 2, maxRoll);
+        std::uniform_int_distribution<int> die(1, maxRoll);
+        for (int i = 0; i < group.dice; ++i) {
+            if (die(random) >= threshold) {
+                ++hits;
+            }
+        }
+    }
+    return hits;
+}
+
+int maxHits(const FleetColumns& attackers, const FleetColumns& defenders, int initiative) {
+    if (attackers.size() == 0 || defenders.size() == 0) {
+        return 0;
+    }
+    int hits = 0;
+    for (const DiceGroup& group : attackers.weapons) {
+        hits += group.initiative == initiative ? group.dice : 0;
+    }
+    return hits;
+}
+
+// One volley at `defenders` with every die rolled. Without a generator every
+// die hits and beats every shield, the most damage the volley can do. Falls
+// back to the averaged shield exactly where volleyOutcomes() does.
+std::vector<BattleShipProfile> rollVolley(const std::vector<BattleShipProfile>& defenders,
+                                          const FleetColumns& defenderColumns,
+                                          const FleetColumns& attackers,
+                                          bool missilesOnly,
+                                          std::optional<int> initiativeFilter,
+                                          std::mt19937_64* random,
+                                          ShieldModel shields) {
+    std::vector<int> levels;
+    int dice = 0;
+    if (shields == ShieldModel::PerTarget && defenderColumns.size() > 0) {
+        levels = shieldLevels(defenderColumns, {&attackers}, missilesOnly, initiativeFilter);
+        forEachGroup(attackers, missilesOnly, initiativeFilter, [&](const DiceGroup& group) { dice += group.dice; });
+    }
+    if (levels.size() <= 1 || levels.size() > kMaxShieldLevels || dice > kMaxVectorHits) {
+        int hits = random ? rollHits(attackers, defenderColumns, missilesOnly, initiativeFilter, *random)
+                          : maxHits(attackers, defenderColumns, *initiativeFilter);
+        return applyHits(defenders, defenderColumns, hits);
+    }
+    HitVector hits = 0;
+    forEachGroup(attackers, missilesOnly, initiativeFilter, [&](const DiceGroup& group) {
+        std::uniform_int_distribution<int> die(1, std::max(group.dieSides, 2));
+        for (int i = 0; i < group.dice; ++i) {
+            int roll = random ? die(*random) : std::max(group.dieSides, 2);
+            size_t beaten = 0;
+            while (beaten < levels.size() && roll >= rollNeeded(group, levels[beaten])) {
+                ++beaten;
+            }
+            hits += beaten > 0 ? oneHit(beaten - 1) : 0;
+        }
+    });
+    return applyHitVector(defenders, defenderColumns, levels, hits);
+}
+
+// One regular round, every initiative bucket in turn. Without a generator every
+// die hits, which is the most damage the round can possibly do.
+void playRound(BattleState& state,
+               const std::vector<int>& initiatives,
+               std::mt19937_64* random,
+               ShieldModel shields) {
+    for (int initiative : initiatives) {
+        FleetColumns humanColumns = buildColumns(state.humans);
+        FleetColumns alienColumns = buildColumns(state.aliens);
+        auto aliens = rollVolley(state.aliens, alienColumns, humanColumns, false, initiative, random, shields);
+        auto humans = rollVolley(state.humans, humanColumns, alienColumns, false, initiative, random, shields);
+        state.humans = std::move(humans);
+        state.aliens = std::move(aliens);
+    }
+}
+
+// Plays one battle to the end, returning +1 for a human win, -1 for an alien
+// win and 0 for a draw, and the number of regular rounds fought.
+int playBattle(BattleState state, std::mt19937_64& random, int& rounds, ShieldModel shields) {
+    rounds = 0;
+    if (fleetHasMissiles(state.humans) || fleetHasMissiles(state.aliens)) {
+        FleetColumns humanColumns = buildColumns(state.humans);
+        FleetColumns alienColumns = buildColumns(state.aliens);
+        auto aliens = rollVolley(state.aliens, alienColumns, humanColumns, true, std::nullopt, &random, shields);
+        auto humans = rollVolley(state.humans, humanColumns, alienColumns, true, std::nullopt, &random, shields);
+        state.humans = std::move(humans);
+        state.aliens = std::move(aliens);
+    }
+    clearMissiles(state.humans);
+    clearMissiles(state.aliens);
+
+    while (!state.humans.empty() && !state.aliens.empty() && rounds < kSampleRoundLimit) {
+        std::vector<int> initiatives = collectInitiatives(buildColumns(state.humans), buildColumns(state.aliens));
+        if (initiatives.empty()) {
+            break;
+        }
+        ++rounds;
+        BattleState before = state;
+        playRound(state, initiatives, &random, shields);
+        if (state == before) {
+            // The solver scores a state it can never leave as a draw after zero
+            // further rounds; recognise it the same way instead of rolling on.
+            BattleState best = state;
+            playRound(best, initiatives, nullptr, shields);
+            if (best == state) {
+                --rounds;
+                break;
+            }
+        }
+    }
+    if (state.humans.empty() == state.aliens.empty()) {
+        return 0;
+    }
+    return state.aliens.empty() ? 1 : -1;
+}
 }  // namespace
 
+SimulationCancelled::SimulationCancelled() : std::runtime_error("simulation cancelled") {}
+
+BattleSimulator::BattleSimulator(std::shared_ptr<SolutionStore> store) : store_(std::move(store)) {}
+
+void BattleSimulator::setSolutionStore(std::shared_ptr<SolutionStore> store) {
+    store_ = std::move(store);
+}
+
+void BattleSimulator::setSharedCache(std::shared_ptr<SolveCache> cache) {
+    sharedCache_ = std::move(cache);
+}
+
+StateKey BattleSimulator::matchupKey(const std::vector<ShipLoadout>& humans,
+                                     const std::vector<ShipLoadout>& aliens,
+                                     ShieldModel shields) {
+    BattleState state = buildState(humans, aliens);
+    canonicalize(state);
+    return persistentKey(state, shields);
+}
+
+StateKey BattleSimulator::positionKey(const BattlePosition& position, ShieldModel shields) {
+    BattleState state = buildState(position);
+    canonicalize(state);
+    return persistentKey(state, shields);
+}
+
 BattleSummary BattleSimulator::simulate(const std::vector<ShipLoadout>& humans,
-                                        const std::vector<ShipLoadout>& aliens) {
+                                        const std::vector<ShipLoadout>& aliens,
+                                        std::stop_token stop) {
+    return solveFrom(humans, aliens, nullptr, nullptr, false, std::move(stop));
+}
+
+BattleSummary BattleSimulator::simulateFrom(const BattlePosition& position, std::stop_token stop) {
+    return solveFrom(position.humans, position.aliens, &position.humanStatus, &position.alienStatus,
+                     position.missilesResolved, std::move(stop));
+}
+
+BattleSummary BattleSimulator::solveFrom(const std::vector<ShipLoadout>& humans,
+                                         const std::vector<ShipLoadout>& aliens,
+                                         const std::vector<ShipStatus>* humanStatus,
+                                         const std::vector<ShipStatus>* alienStatus,
+                                         bool missilesResolved,
+                                         std::stop_token stop) {
+    BattleState state;
+    state.humans = buildFleet(humans, humanStatus);
+    state.aliens = buildFleet(aliens, alienStatus);
+    state.missilesResolved = missilesResolved;
+    canonicalize(state);
+    SolveContext context;
+    context.shared = sharedCache_.get();
+    context.store = store_.get();
+    context.shields = shields_;
+    context.stop = std::move(stop);
+    context.progress = progress_.get();
+    ProgressScope scope(*progress_, lastStats_, &context, sharedCache_.get());
+    CachedResult result;
+    try {
+        result = solveState(state, context);
+    } catch (...) {
+        lastStats_ = context.stats;
+        throw;
+    }
+    lastStats_ = context.stats;
+    if (store_) {
+        store_->flush();
+    }
+    return toSummary(result);
+}
+
+SampledSummary BattleSimulator::sample(const std::vector<ShipLoadout>& humans,
+                                       const std::vector<ShipLoadout>& aliens,
+                                       std::uint64_t trials,
+                                       std::uint64_t seed,
+                                       ShieldModel shields) {
     BattleState state = buildState(humans, aliens);
     canonicalize(state);
-    std::unordered_map<BattleState, CachedResult, StateHash> cache;
-    CachedResult result = solveState(state, cache);
-    BattleSummary summary;
-    summary.humanWin = result.humanWin;
-    summary.alienWin = result.alienWin;
-    summary.draw = result.draw;
-    summary.expectedRounds = result.expectedRounds;
-    return summary;
+    std::mt19937_64 random(seed);
+    SampledSummary result;
+    result.trials = trials;
+    if (trials == 0) {
+        return result;
+    }
+    std::uint64_t humanWins = 0;
+    std::uint64_t alienWins = 0;
+    double roundSum = 0.0;
+    double roundSquares = 0.0;
+    for (std::uint64_t trial = 0; trial < trials; ++trial) {
+        int rounds = 0;
+        int outcome = playBattle(state, random, rounds, shields);
+        humanWins += outcome > 0 ? 1 : 0;
+        alienWins += outcome < 0 ? 1 : 0;
+        roundSum += rounds;
+        roundSquares += static_cast<double>(rounds) * rounds;
+    }
+    double n = static_cast<double>(trials);
+    result.estimate.humanWin = static_cast<double>(humanWins) / n;
+    result.estimate.alienWin = static_cast<double>(alienWins) / n;
+    result.estimate.draw = 1.0 - result.estimate.humanWin - result.estimate.alienWin;
+    result.estimate.expectedRounds = roundSum / n;
+    result.roundsVariance = trials > 1 ? (roundSquares - roundSum * roundSum / n) / (n - 1.0) : 0.0;
+    return result;
+}
+
+HorizonSummary BattleSimulator::simulateRounds(const std::vector<ShipLoadout>& humans,
+                                               const std::vector<ShipLoadout>& aliens,
+                                               int maxRounds,
+                                               std::stop_token stop) {
+    BattleState state = buildState(humans, aliens);
+    canonicalize(state);
+    HorizonContext context;
+    context.shields = shields_;
+    context.stop = std::move(stop);
+    ProgressScope scope(*progress_, lastStats_, nullptr, sharedCache_.get());
+    HorizonSummary result;
+    try {
+        result = solveHorizon(state, std::max(0, maxRounds), context);
+    } catch (...) {
+        lastStats_ = context.stats;
+        throw;
+    }
+    lastStats_ = context.stats;
+    return result;
+}
+
+RetreatSummary BattleSimulator::simulate(const std::vector<ShipLoadout>& humans,
+                                         const std::vector<ShipLoadout>& aliens,
+                                         const RetreatPolicy& humanPolicy,
+                                         const RetreatPolicy& alienPolicy,
+                                         std::stop_token stop) {
+    if (humanPolicy.rule == RetreatRule::Never && alienPolicy.rule == RetreatRule::Never) {
+        BattleSummary summary = simulate(humans, aliens, std::move(stop));
+        return {summary.humanWin, summary.alienWin, summary.draw, 0.0, 0.0, summary.expectedRounds};
+    }
+    BattleState state = buildState(humans, aliens);
+    canonicalize(state);
+    RetreatContext context;
+    context.humanPolicy = humanPolicy;
+    context.alienPolicy = alienPolicy;
+    context.plain.shared = sharedCache_.get();
+    context.plain.store = store_.get();
+    context.plain.shields = shields_;
+    context.plain.stop = std::move(stop);
+    context.plain.progress = progress_.get();
+    ProgressScope scope(*progress_, lastStats_, &context.plain, sharedCache_.get());
+    auto collectStats = [&] {
+        lastStats_ = context.stats;
+        addStats(lastStats_, context.plain.stats);
+    };
+    RetreatSummary result;
+    try {
+        result = solveRetreat(state, context);
+    } catch (...) {
+        collectStats();
+        throw;
+    }
+    collectStats();
+    if (store_) {
+        store_->flush();
+    }
+    return result;
+}
+
+MultiBattleSummary BattleSimulator::simulate(const std::vector<CombatSide>& sides, std::stop_token stop) {
+    if (sides.size() == 2) {
+        BattleSummary summary = simulate(sides[0].fleet, sides[1].fleet, std::move(stop));
+        return {{summary.humanWin, summary.alienWin}, summary.draw, summary.expectedRounds};
+    }
+    MultiBattleState state;
+    MultiContext context;
+    for (const CombatSide& side : sides) {
+        state.sides.push_back(buildFleet(side.fleet));
+        context.targeting.push_back(side.targeting);
+    }
+    context.pair.shared = sharedCache_.get();
+    context.pair.store = store_.get();
+    context.pair.shields = shields_;
+    context.pair.stop = std::move(stop);
+    context.pair.progress = progress_.get();
+    ProgressScope scope(*progress_, lastStats_, &context.pair, sharedCache_.get());
+    auto collectStats = [&] {
+        lastStats_ = context.stats;
+        addStats(lastStats_, context.pair.stats);
+    };
+    MultiResult result;
+    try {
+        result = solveMulti(state, context);
+    } catch (...) {
+        collectStats();
+        throw;
+    }
+    collectStats();
+    if (store_) {
+        store_->flush();
+    }
+    return {std::move(result.win), result.draw, result.expectedRounds};
+}
+
+struct RoundTransitions::Impl {
+    struct Node {
+        const BattleState* state = nullptr;  // key in `handles`, whose nodes never move
+        bool roundReady = false;
+        std::vector<Transition> round;
+        std::optional<std::vector<int>> initiatives;
+        std::vector<std::pair<int, std::vector<Transition>>> volleys;
+    };
+
+    ShieldModel shields;
+    std::unordered_map<BattleState, StateHandle, StateHash> handles;
+    std::vector<Node> nodes;
+
+    void check(StateHandle state) const {
+        if (state >= nodes.size()) {
+            throw std::out_of_range("unknown battle state handle");
+        }
+    }
+    const Node& node(StateHandle state) const {
+        check(state);
+        return nodes[state];
+    }
+    Node& node(StateHandle state) {
+        check(state);
+        return nodes[state];
+    }
+
+    // `state` must be canonical.
+    StateHandle intern(const BattleState& state) {
+        auto [it, inserted] = handles.emplace(state, static_cast<StateHandle>(nodes.size()));
+        if (inserted) {
+            nodes.emplace_back().state = &it->first;
+        }
+        return it->second;
+    }
+
+    // Interns the successors and merges any that canonicalize alike. Sorted by
+    // descending probability so a search can cut off the unlikely tail.
+    template <typename Outcomes>
+    std::vector<Transition> collect(const Outcomes& outcomes) {
+        std::vector<Transition> transitions;
+        transitions.reserve(outcomes.size());
+        for (const auto& [next, probability] : outcomes) {
+            if (probability > 0.0) {
+                transitions.push_back({intern(next), probability});
+            }
+        }
+        std::sort(transitions.begin(), transitions.end(),
+                  [](const Transition& a, const Transition& b) { return a.state < b.state; });
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < transitions.size(); ++i) {
+            if (kept > 0 && transitions[kept - 1].state == transitions[i].state) {
+                transitions[kept - 1].probability += transitions[i].probability;
+            } else {
+                transitions[kept++] = transitions[i];
+            }
+        }
+        transitions.resize(kept);
+        std::stable_sort(transitions.begin(), transitions.end(),
+                         [](const Transition& a, const Transition& b) { return a.probability > b.probability; });
+        return transitions;
+    }
+};
+
+RoundTransitions::RoundTransitions(ShieldModel shields) : impl_(std::make_unique<Impl>()) {
+    impl_->shields = shields;
+}
+
+RoundTransitions::~RoundTransitions() = default;
+
+StateHandle RoundTransitions::intern(const BattlePosition& position) {
+    BattleState state = buildState(position);
+    canonicalize(state);
+    return impl_->intern(state);
+}
+
+std::span<const Transition> RoundTransitions::round(StateHandle state) {
+    if (impl_->node(state).roundReady) {
+        return impl_->nodes[state].round;
+    }
+    const BattleState& current = *impl_->nodes[state].state;
+    std::vector<Transition> transitions;
+    if (current.humans.empty() || current.aliens.empty()) {
+        transitions = {{state, 1.0}};
+    } else if (!current.missilesResolved) {
+        if (fleetHasMissiles(current.humans) || fleetHasMissiles(current.aliens)) {
+            transitions = impl_->collect(missileOutcomes(current, impl_->shields));
+        } else {
+            BattleState next = current;
+            next.missilesResolved = true;
+            transitions = {{impl_->intern(next), 1.0}};
+        }
+    } else {
+        transitions = impl_->collect(roundOutcomes(current, impl_->shields));
+    }
+    // Interning may have grown `nodes`; index it afresh.
+    Impl::Node& node = impl_->nodes[state];
+    node.round = std::move(transitions);
+    node.roundReady = true;
+    return node.round;
+}
+
+std::span<const Transition> RoundTransitions::volley(StateHandle state, int initiative) {
+    const BattleState& current = *impl_->node(state).state;
+    if (!current.missilesResolved || current.humans.empty() || current.aliens.empty()) {
+        return round(state);
+    }
+    for (const auto& [cached, transitions] : impl_->nodes[state].volleys) {
+        if (cached == initiative) {
+            return transitions;
+        }
+    }
+    std::unordered_map<BattleState, double, StateHash> nextStates;
+    accumulateInitiativeOutcomes(current, buildColumns(current.humans), buildColumns(current.aliens), {initiative}, 0,
+                                 1.0, nextStates, Firing::Both, impl_->shields);
+    std::vector<Transition> transitions = impl_->collect(nextStates);
+    auto& volleys = impl_->nodes[state].volleys;
+    volleys.emplace_back(initiative, std::move(transitions));
+    return volleys.back().second;
+}
+
+std::span<const int> RoundTransitions::initiatives(StateHandle state) {
+    Impl::Node& node = impl_->node(state);
+    if (!node.initiatives) {
+        node.initiatives = collectInitiatives(buildColumns(node.state->humans), buildColumns(node.state->aliens));
+    }
+    return *node.initiatives;
+}
+
+BattleOutcome RoundTransitions::outcome(StateHandle state) const {
+    const BattleState& current = *impl_->node(state).state;
+    if (current.humans.empty()) {
+        return current.aliens.empty() ? BattleOutcome::Draw : BattleOutcome::AliensWin;
+    }
+    return current.aliens.empty() ? BattleOutcome::HumansWin : BattleOutcome::Fighting;
+}
+
+bool RoundTransitions::missilesResolved(StateHandle state) const {
+    return impl_->node(state).state->missilesResolved;
+}
+
+StateKey RoundTransitions::key(StateHandle state) const {
+    return persistentKey(*impl_->node(state).state, impl_->shields);
+}
+
+std::size_t RoundTransitions::size() const {
+    return impl_->nodes.size();
+}
+
+void RoundTransitions::clear() {
+    impl_->nodes.clear();
+    impl_->handles.clear();
 }
 
 }  // namespace eclipse
@@ -0,0 +1,1028 @@
+#include "game/catalog_source.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "io/mapped_file.hpp"
+
+namespace eclipse {
+
+namespace {
+constexpr std::size_t kFactionCount = 4;
+constexpr std::size_t kMaxEntries = kInvalidModuleId;
+
+template <typename Enum, std::size_t N>
+struct NameTable {
+    std::array<std::pair<std::string_view, Enum>, N> entries;
+
+    std::optional<Enum> parse(std::string_view name) const {
+        for (const auto& [label, value] : entries) {
+            if (label == name) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::string_view name(Enum value) const {
+        for (const auto& [label, entry] : entries) {
+            if (entry == value) {
+                return label;
+            }
+        }
+        return "?";
+    }
+};
+
+constexpr NameTable<SlotType, 6> kSlotNames{{{
+    {"weapon", SlotType::Weapon},
+    {"drive", SlotType::Drive},
+    {"computer", SlotType::Computer},
+    {"shield", SlotType::Shield},
+    {"power", SlotType::Power},
+    {"support", SlotType::Support},
+}}};
+
+constexpr NameTable<Faction, kFactionCount> kFactionNames{{{
+    {"human", Faction::Human},
+    {"eridani", Faction::Eridani},
+    {"planta", Faction::Planta},
+    {"orion", Faction::Orion},
+}}};
+
+constexpr NameTable<ShipClass, 5> kClassNames{{{
+    {"interceptor", ShipClass::Interceptor},
+    {"cruiser", ShipClass::Cruiser},
+    {"dreadnought", ShipClass::Dreadnought},
+    {"starbase", ShipClass::Starbase},
+    {"other", ShipClass::Other},
+}}};
+
+// Designs before their slot and extra arrays are flattened; modules are referenced by
+// index so the module vector may still grow while drafts are collected.
+struct DraftDesign {
+    ShipDesign design;
+    std::vector<std::pair<SlotType, ModuleId>> slots;
+    std::vector<ModuleId> extras;
+};
+
+struct Draft {
+    std::vector<ModuleSpec> modules;
+    std::vector<DraftDesign> designs;
+};
+
+std::runtime_error formatError(std::string_view source, std::size_t line, const std::string& message) {
+    std::ostringstream out;
+    out << source;
+    if (line > 0) {
+        out << ":" << line;
+    }
+    out << ": " << message;
+    return std::runtime_error(out.str());
+}
+}  // namespace
+
+struct CatalogSource::Storage {
+    std::string text;
+    std::deque<std::string> derivedNames;
+    MappedFile mapping;
+
+    std::vector<ModuleSpec> modules;
+    std::vector<SlotBlueprint> slots;
+    std::vector<const ModuleSpec*> extras;
+    std::vector<ShipDesign> designs;
+    std::vector<std::pair<std::string_view, ModuleId>> moduleIndex;
+    std::vector<std::pair<std::string_view, DesignId>> designIndex;
+    std::array<std::vector<const ShipDesign*>, kFactionCount> factionDesigns;
+    CatalogView view;
+
+    void finalize(Draft&& draft, std::string_view source) {
+        if (draft.modules.size() >= kMaxEntries || draft.designs.size() >= kMaxEntries) {
+            throw formatError(source, 0, "too many catalog entries");
+        }
+        modules = std::move(draft.modules);
+
+        auto moduleRef = [&](ModuleId id) -> const ModuleSpec* {
+            if (id == kInvalidModuleId) {
+                return nullptr;
+            }
+            if (id >= modules.size()) {
+                throw formatError(source, 0, "module reference out of range");
+            }
+            return &modules[id];
+        };
+
+        std::size_t slotTotal = 0;
+        std::size_t extraTotal = 0;
+        for (const DraftDesign& entry : draft.designs) {
+            slotTotal += entry.slots.size();
+            extraTotal += entry.extras.size();
+        }
+        // Reserved up front: designs keep spans into these vectors.
+        slots.reserve(slotTotal);
+        extras.reserve(extraTotal);
+        designs.reserve(draft.designs.size());
+        for (DraftDesign& entry : draft.designs) {
+            ShipDesign design = entry.design;
+            std::size_t firstSlot = slots.size();
+            for (const auto& [type, preprint] : entry.slots) {
+                SlotBlueprint slot;
+                slot.preferredType = type;
+                slot.preprint = moduleRef(preprint);
+                slots.push_back(slot);
+            }
+            std::size_t firstExtra = extras.size();
+            for (ModuleId extra : entry.extras) {
+                if (const ModuleSpec* spec = moduleRef(extra)) {
+                    extras.push_back(spec);
+                }
+            }
+            design.slots = std::span<const SlotBlueprint>(slots.data() + firstSlot, slots.size() - firstSlot);
+            design.extras = std::span<const ModuleSpec* const>(extras.data() + firstExtra, extras.size() - firstExtra);
+            designs.push_back(design);
+        }
+
+        moduleIndex.reserve(modules.size());
+        for (std::size_t i = 0; i < modules.size(); ++i) {
+            moduleIndex.emplace_back(modules[i].id, static_cast<ModuleId>(i));
+        }
+        std::sort(moduleIndex.begin(), moduleIndex.end());
+        designIndex.reserve(designs.size());
+        for (std::size_t i = 0; i < designs.size(); ++i) {
+            designIndex.emplace_back(designs[i].id, static_cast<DesignId>(i));
+            std::size_t faction = static_cast<std::size_t>(designs[i].faction);
+            if (faction < factionDesigns.size()) {
+                factionDesigns[faction].push_back(&designs[i]);
+            }
+        }
+        std::sort(designIndex.begin(), designIndex.end());
+        auto duplicate = [](const auto& index) {
+            return std::adjacent_find(index.begin(), index.end(), [](const auto& a, const auto& b) {
+                return a.first == b.first;
+            });
+        };
+        if (auto it = duplicate(moduleIndex); it != moduleIndex.end()) {
+            throw formatError(source, 0, "duplicate module " + std::string(it->first));
+        }
+        if (auto it = duplicate(designIndex); it != designIndex.end()) {
+            throw formatError(source, 0, "duplicate design " + std::string(it->first));
+        }
+
+        view.modules = modules;
+        view.designs = designs;
+        view.moduleIndex = moduleIndex;
+        view.designIndex = designIndex;
+        for (std::size_t i = 0; i < kFactionCount; ++i) {
+            view.factionDesigns[i] = factionDesigns[i];
+        }
+    }
+};
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Text format
+
+class TextParser {
+public:
+    TextParser(std::string_view text, std::deque<std::string>& derivedNames)
+        : text_(text), derivedNames_(derivedNames) {}
+
+    Draft parse() {
+        std::size_t pos = 0;
+        while (pos <= text_.size()) {
+            std::size_t end = text_.find('\n', pos);
+            if (end == std::string_view::npos) {
+                end = text_.size();
+            }
+            ++line_;
+            parseLine(text_.substr(pos, end - pos));
+            pos = end + 1;
+        }
+        closeBlock();
+        return std::move(draft_);
+    }
+
+private:
+    enum class Block { None, Module, Design, Variant };
+
+    struct VariantRule {
+        std::string_view op;
+        std::string_view selector;
+        std::vector<std::string_view> args;
+        std::size_t line = 0;
+    };
+
+    std::string_view text_;
+    std::deque<std::string>& derivedNames_;
+    Draft draft_;
+    std::unordered_map<std::string_view, ModuleId> moduleIds_;
+    std::size_t line_ = 0;
+    Block block_ = Block::None;
+
+    std::string_view variantPrefix_;
+    std::string_view variantFrom_;
+    std::string_view variantName_;
+    std::optional<Faction> variantFaction_;
+    std::vector<VariantRule> variantRules_;
+    std::size_t variantLine_ = 0;
+
+    [[noreturn]] void fail(const std::string& message) const { throw formatError("catalog", line_, message); }
+
+    static std::vector<std::string_view> tokenize(std::string_view line) {
+        std::vector<std::string_view> tokens;
+        std::size_t pos = 0;
+        while (pos < line.size()) {
+            while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+                ++pos;
+            }
+            std::size_t start = pos;
+            while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t') {
+                ++pos;
+            }
+            if (pos > start) {
+                tokens.push_back(line.substr(start, pos - start));
+            }
+        }
+        return tokens;
+    }
+
+    static std::string_view restOfLine(std::string_view line, std::string_view keyword) {
+        std::size_t pos = line.find(keyword) + keyword.size();
+        std::size_t first = line.find_first_not_of(" \t", pos);
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        std::size_t last = line.find_last_not_of(" \t");
+        return line.substr(first, last - first + 1);
+    }
+
+    int integer(const std::vector<std::string_view>& tokens, std::size_t index) const {
+        if (index >= tokens.size()) {
+            fail("missing value for '" + std::string(tokens[0]) + "'");
+        }
+        std::string_view token = tokens[index];
+        bool negative = !token.empty() && token[0] == '-';
+        std::size_t start = negative ? 1 : 0;
+        if (start >= token.size()) {
+            fail("expected integer, got '" + std::string(token) + "'");
+        }
+        int value = 0;
+        for (std::size_t i = start; i < token.size(); ++i) {
+            if (token[i] < '0' || token[i] > '9' || value > 100000) {
+                fail("expected integer, got '" + std::string(token) + "'");
+            }
+            value = value * 10 + (token[i] - '0');
+        }
+        return negative ? -value : value;
+    }
+
+    template <typename Enum, std::size_t N>
+    Enum named(const NameTable<Enum, N>& table, const std::vector<std::string_view>& tokens, std::size_t index) const {
+        if (index >= tokens.size()) {
+            fail("missing value for '" + std::string(tokens[0]) + "'");
+        }
+        auto value = table.parse(tokens[index]);
+        if (!value) {
+            fail("unknown value '" + std::string(tokens[index]) + "'");
+        }
+        return *value;
+    }
+
+    ModuleId moduleRef(std::string_view id) const {
+        auto it = moduleIds_.find(id);
+        if (it == moduleIds_.end()) {
+            fail("unknown module '" + std::string(id) + "' (modules must be defined before use)");
+        }
+        return it->second;
+    }
+
+    void parseLine(std::string_view line) {
+        if (std::size_t comment = line.find('#'); comment != std::string_view::npos) {
+            line = line.substr(0, comment);
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        std::vector<std::string_view> tokens = tokenize(line);
+        if (tokens.empty()) {
+            return;
+        }
+        bool indented = line[0] == ' ' || line[0] == '\t';
+        if (!indented) {
+            openBlock(tokens);
+            return;
+        }
+        switch (block_) {
+            case Block::Module: moduleAttribute(line, tokens); break;
+            case Block::Design: designAttribute(line, tokens); break;
+            case Block::Variant: variantAttribute(line, tokens); break;
+            case Block::None: fail("attribute outside of a block");
+        }
+    }
+
+    void openBlock(const std::vector<std::string_view>& tokens) {
+        closeBlock();
+        if (tokens.size() != 2) {
+            fail("expected '<module|design|variant> <ID>'");
+        }
+        if (tokens[0] == "module") {
+            ModuleSpec spec;
+            spec.id = tokens[1];
+            spec.shortLabel = tokens[1];
+            spec.name = tokens[1];
+            if (!moduleIds_.emplace(spec.id, static_cast<ModuleId>(draft_.modules.size())).second) {
+                fail("duplicate module '" + std::string(spec.id) + "'");
+            }
+            draft_.modules.push_back(spec);
+            block_ = Block::Module;
+        } else if (tokens[0] == "design") {
+            DraftDesign design;
+            design.design.id = tokens[1];
+            design.design.name = tokens[1];
+            draft_.designs.push_back(std::move(design));
+            block_ = Block::Design;
+        } else if (tokens[0] == "variant") {
+            variantPrefix_ = tokens[1];
+            variantFrom_ = {};
+            variantName_ = tokens[1];
+            variantFaction_.reset();
+            variantRules_.clear();
+            variantLine_ = line_;
+            block_ = Block::Variant;
+        } else {
+            fail("unknown directive '" + std::string(tokens[0]) + "'");
+        }
+    }
+
+    void moduleAttribute(std::string_view line, const std::vector<std::string_view>& tokens) {
+        ModuleSpec& spec = draft_.modules.back();
+        std::string_view key = tokens[0];
+        if (key == "label") {
+            spec.shortLabel = restOfLine(line, key);
+        } else if (key == "name") {
+            spec.name = restOfLine(line, key);
+        } else if (key == "slot") {
+            spec.slot = named(kSlotNames, tokens, 1);
+        } else if (key == "energy") {
+            spec.energyCost = integer(tokens, 1);
+        } else if (key == "power") {
+            spec.energyProvided = integer(tokens, 1);
+        } else if (key == "dice") {
+            spec.dice = integer(tokens, 1);
+        } else if (key == "computer") {
+            spec.accuracyBonus = integer(tokens, 1);
+        } else if (key == "shield") {
+            spec.shieldBonus = integer(tokens, 1);
+        } else if (key == "hull") {
+            spec.hullBonus = integer(tokens, 1);
+        } else if (key == "drive") {
+            spec.drivePower = integer(tokens, 1);
+        } else if (key == "initiative") {
+            spec.weaponInitiative = integer(tokens, 1);
+        } else if (key == "sides") {
+            spec.weaponDieSides = integer(tokens, 1);
+        } else if (key == "hit") {
+            spec.baseToHit = integer(tokens, 1);
+        } else if (key == "missile") {
+            spec.missile = true;
+        } else if (key == "oneshot") {
+            spec.oneShot = true;
+        } else if (key == "flux") {
+            spec.grantsFluxShield = true;
+        } else if (key == "blueprint") {
+            spec.blueprintOnly = true;
+        } else {
+            fail("unknown module attribute '" + std::string(key) + "'");
+        }
+    }
+
+    void designAttribute(std::string_view line, const std::vector<std::string_view>& tokens) {
+        DraftDesign& entry = draft_.designs.back();
+        ShipDesign& design = entry.design;
+        std::string_view key = tokens[0];
+        if (key == "name") {
+            design.name = restOfLine(line, key);
+        } else if (key == "faction") {
+            design.faction = named(kFactionNames, tokens, 1);
+        } else if (key == "class") {
+            design.shipClass = named(kClassNames, tokens, 1);
+        } else if (key == "hull") {
+            design.baseHull = integer(tokens, 1);
+        } else if (key == "computer") {
+            design.baseComputer = integer(tokens, 1);
+        } else if (key == "shield") {
+            design.baseShield = integer(tokens, 1);
+        } else if (key == "dice") {
+            design.baseDice = integer(tokens, 1);
+        } else if (key == "energy") {
+            design.baseEnergy = integer(tokens, 1);
+        } else if (key == "initiative") {
+            design.baseInitiativeBonus = integer(tokens, 1);
+        } else if (key == "weapon-initiative") {
+            design.baseWeaponInitiative = integer(tokens, 1);
+        } else if (key == "weapon-sides") {
+            design.baseWeaponDieSides = integer(tokens, 1);
+        } else if (key == "weapon-hit") {
+            design.baseWeaponHit = integer(tokens, 1);
+        } else if (key == "drives") {
+            std::string_view mode = tokens.size() > 1 ? tokens[1] : std::string_view{};
+            if (mode == "required") {
+                design.drivesAllowed = true;
+                design.requiresDrive = true;
+            } else if (mode == "optional") {
+                design.drivesAllowed = true;
+                design.requiresDrive = false;
+            } else if (mode == "forbidden") {
+                design.drivesAllowed = false;
+                design.requiresDrive = false;
+            } else {
+                fail("drives must be required, optional or forbidden");
+            }
+        } else if (key == "slot") {
+            SlotType type = named(kSlotNames, tokens, 1);
+            ModuleId preprint = tokens.size() > 2 ? moduleRef(tokens[2]) : kInvalidModuleId;
+            entry.slots.emplace_back(type, preprint);
+        } else if (key == "extra") {
+            for (std::size_t i = 1; i < tokens.size(); ++i) {
+                entry.extras.push_back(moduleRef(tokens[i]));
+            }
+        } else {
+            fail("unknown design attribute '" + std::string(key) + "'");
+        }
+    }
+
+    void variantAttribute(std::string_view line, const std::vector<std::string_view>& tokens) {
+        std::string_view key = tokens[0];
+        if (key == "from") {
+            variantFrom_ = tokens.size() > 1 ? tokens[1] : std::string_view{};
+        } else if (key == "faction") {
+            variantFaction_ = named(kFactionNames, tokens, 1);
+        } else if (key == "name") {
+            variantName_ = restOfLine(line, key);
+        } else if (key == "initiative" || key == "extra" || key == "extras" || key == "fill-empty" ||
+                   key == "clear-preprint") {
+            if (tokens.size() < 3) {
+                fail("'" + std::string(key) + "' needs a selector and a value");
+            }
+            VariantRule rule;
+            rule.op = key;
+            rule.selector = tokens[1];
+            rule.args.assign(tokens.begin() + 2, tokens.end());
+            rule.line = line_;
+            variantRules_.push_back(std::move(rule));
+        } else {
+            fail("unknown variant attribute '" + std::string(key) + "'");
+        }
+    }
+
+    static bool selects(std::string_view selector, ShipClass cls) {
+        if (selector == "all") {
+            return true;
+        }
+        if (selector == "ships") {
+            return cls != ShipClass::Starbase;
+        }
+        auto parsed = kClassNames.parse(selector);
+        return parsed && *parsed == cls;
+    }
+
+    void applyRule(const VariantRule& rule, DraftDesign& entry) {
+        line_ = rule.line;
+        if (rule.selector != "all" && rule.selector != "ships" && !kClassNames.parse(rule.selector)) {
+            fail("unknown selector '" + std::string(rule.selector) + "'");
+        }
+        if (!selects(rule.selector, entry.design.shipClass)) {
+            return;
+        }
+        if (rule.op == "initiative") {
+            std::vector<std::string_view> tokens{rule.op, rule.args[0]};
+            entry.design.baseInitiativeBonus = integer(tokens, 1);
+        } else if (rule.op == "extra") {
+            for (std::string_view id : rule.args) {
+                entry.extras.push_back(moduleRef(id));
+            }
+        } else if (rule.op == "extras") {
+            entry.extras.clear();
+            for (std::string_view id : rule.args) {
+                entry.extras.push_back(moduleRef(id));
+            }
+        } else if (rule.op == "fill-empty") {
+            ModuleId fill = moduleRef(rule.args[0]);
+            for (auto& slot : entry.slots) {
+                if (slot.second == kInvalidModuleId) {
+                    slot.second = fill;
+                }
+            }
+        } else if (rule.op == "clear-preprint") {
+            ModuleId target = moduleRef(rule.args[0]);
+            for (auto& slot : entry.slots) {
+                if (slot.second == target) {
+                    slot.second = kInvalidModuleId;
+                    return;
+                }
+            }
+            if (rule.args.size() < 2 || rule.args[1] != "else-except") {
+                return;
+            }
+            std::vector<ModuleId> keep;
+            for (std::size_t i = 2; i < rule.args.size(); ++i) {
+                keep.push_back(moduleRef(rule.args[i]));
+            }
+            for (auto& slot : entry.slots) {
+                if (slot.second != kInvalidModuleId &&
+                    std::find(keep.begin(), keep.end(), slot.second) == keep.end()) {
+                    slot.second = kInvalidModuleId;
+                    return;
+                }
+            }
+        }
+    }
+
+    void expandVariant() {
+        if (variantFrom_.empty()) {
+            line_ = variantLine_;
+            fail("variant '" + std::string(variantPrefix_) + "' needs 'from <PREFIX>'");
+        }
+        std::string basePrefix = std::string(variantFrom_) + "_";
+        std::size_t existing = draft_.designs.size();
+        for (std::size_t i = 0; i < existing; ++i) {
+            const DraftDesign& base = draft_.designs[i];
+            if (base.design.id.substr(0, basePrefix.size()) != basePrefix) {
+                continue;
+            }
+            DraftDesign derived = base;
+            std::string_view baseName = base.design.name;
+            std::size_t space = baseName.find(' ');
+            std::string_view suffix = space == std::string_view::npos ? baseName : baseName.substr(space + 1);
+            derivedNames_.push_back(std::string(variantPrefix_) + "_" +
+                                    std::string(base.design.id.substr(basePrefix.size())));
+            derived.design.id = derivedNames_.back();
+            derivedNames_.push_back(std::string(variantName_) + " " + std::string(suffix));
+            derived.design.name = derivedNames_.back();
+            if (variantFaction_) {
+                derived.design.faction = *variantFaction_;
+            }
+            for (const VariantRule& rule : variantRules_) {
+                applyRule(rule, derived);
+            }
+            draft_.designs.push_back(std::move(derived));
+        }
+    }
+
+    void closeBlock() {
+        if (block_ == Block::Variant) {
+            std::size_t line = line_;
+            expandVariant();
+            line_ = line;
+        }
+        block_ = Block::None;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Binary format
+
+constexpr char kBinaryMagic[4] = {'E', 'S', 'D', 'C'};
+constexpr std::uint32_t kBinaryVersion = 1;
+
+struct BinaryHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t moduleCount;
+    std::uint32_t designCount;
+    std::uint32_t slotCount;
+    std::uint32_t extraCount;
+    std::uint32_t stringBytes;
+    std::uint32_t reserved;
+};
+
+struct BinaryString {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+enum ModuleFlags : std::uint8_t {
+    kFlagMissile = 1 << 0,
+    kFlagOneShot = 1 << 1,
+    kFlagFlux = 1 << 2,
+    kFlagBlueprint = 1 << 3,
+};
+
+struct BinaryModule {
+    BinaryString id;
+    BinaryString shortLabel;
+    BinaryString name;
+    std::uint8_t slot;
+    std::uint8_t flags;
+    std::int16_t energyCost;
+    std::int16_t energyProvided;
+    std::int16_t dice;
+    std::int16_t accuracyBonus;
+    std::int16_t shieldBonus;
+    std::int16_t hullBonus;
+    std::int16_t drivePower;
+    std::int16_t weaponInitiative;
+    std::int16_t weaponDieSides;
+    std::int16_t baseToHit;
+    std::int16_t reserved;
+};
+
+enum DesignFlags : std::uint8_t {
+    kFlagDrivesAllowed = 1 << 0,
+    kFlagRequiresDrive = 1 << 1,
+};
+
+struct BinaryDesign {
+    BinaryString id;
+    BinaryString name;
+    std::uint8_t faction;
+    std::uint8_t shipClass;
+    std::uint8_t flags;
+    std::uint8_t reserved;
+    std::int16_t baseHull;
+    std::int16_t baseComputer;
+    std::int16_t baseShield;
+    std::int16_t baseDice;
+    std::int16_t baseEnergy;
+    std::int16_t baseWeaponInitiative;
+    std::int16_t baseWeaponDieSides;
+    std::int16_t baseWeaponHit;
+    std::int16_t baseInitiativeBonus;
+    std::int16_t reserved2;
+    std::uint32_t firstSlot;
+    std::uint32_t slotCount;
+    std::uint32_t firstExtra;
+    std::uint32_t extraCount;
+};
+
+struct BinarySlot {
+    std::uint8_t type;
+    std::uint8_t reserved;
+    std::uint16_t preprint;
+};
+
+static_assert(sizeof(BinaryHeader) == 32);
+static_assert(sizeof(BinaryModule) == 48);
+static_assert(sizeof(BinaryDesign) == 56);
+static_assert(sizeof(BinarySlot) == 4);
+
+void requireLittleEndian() {
+    if constexpr (std::endian::native != std::endian::little) {
+        throw std::runtime_error("binary catalogs are only supported on little-endian hosts");
+    }
+}
+
+class BinaryReader {
+public:
+    BinaryReader(std::span<const std::byte> bytes, std::string_view source) : bytes_(bytes), source_(source) {}
+
+    template <typename Record>
+    Record read(std::size_t offset) const {
+        if (offset + sizeof(Record) > bytes_.size()) {
+            throw formatError(source_, 0, "truncated binary catalog");
+        }
+        Record record;
+        std::memcpy(&record, bytes_.data() + offset, sizeof(Record));
+        return record;
+    }
+
+    std::string_view string(const BinaryString& ref, std::size_t stringsOffset, std::size_t stringBytes) const {
+        if (std::size_t(ref.offset) + ref.length > stringBytes) {
+            throw formatError(source_, 0, "string reference out of range");
+        }
+        return {reinterpret_cast<const char*>(bytes_.data() + stringsOffset + ref.offset), ref.length};
+    }
+
+private:
+    std::span<const std::byte> bytes_;
+    std::string_view source_;
+};
+
+Draft readBinary(std::span<const std::byte> bytes, std::string_view source) {
+    requireLittleEndian();
+    BinaryReader reader(bytes, source);
+    auto header = reader.read<BinaryHeader>(0);
+    if (std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        throw formatError(source, 0, "not a binary catalog");
+    }
+    if (header.version != kBinaryVersion) {
+        throw formatError(source, 0, "unsupported binary catalog version " + std::to_string(header.version));
+    }
+    std::size_t modulesOffset = sizeof(BinaryHeader);
+    std::size_t designsOffset = modulesOffset + std::size_t(header.moduleCount) * sizeof(BinaryModule);
+    std::size_t slotsOffset = designsOffset + std::size_t(header.designCount) * sizeof(BinaryDesign);
+    std::size_t extrasOffset = slotsOffset + std::size_t(header.slotCount) * sizeof(BinarySlot);
+    std::size_t stringsOffset = extrasOffset + std::size_t(header.extraCount) * sizeof(std::uint16_t);
+    if (stringsOffset + header.stringBytes > bytes.size()) {
+        throw formatError(source, 0, "truncated binary catalog");
+    }
+
+    Draft draft;
+    draft.modules.reserve(header.moduleCount);
+    for (std::uint32_t i = 0; i < header.moduleCount; ++i) {
+        auto record = reader.read<BinaryModule>(modulesOffset + i * sizeof(BinaryModule));
+        if (record.slot > static_cast<std::uint8_t>(SlotType::Support)) {
+            throw formatError(source, 0, "invalid slot type");
+        }
+        ModuleSpec spec;
+        spec.id = reader.string(record.id, stringsOffset, header.stringBytes);
+        spec.shortLabel = reader.string(record.shortLabel, stringsOffset, header.stringBytes);
+        spec.name = reader.string(record.name, stringsOffset, header.stringBytes);
+        spec.slot = static_cast<SlotType>(record.slot);
+        spec.energyCost = record.energyCost;
+        spec.energyProvided = record.energyProvided;
+        spec.dice = record.dice;
+        spec.accuracyBonus = record.accuracyBonus;
+        spec.shieldBonus = record.shieldBonus;
+        spec.hullBonus = record.hullBonus;
+        spec.drivePower = record.drivePower;
+        spec.weaponInitiative = record.weaponInitiative;
+        spec.weaponDieSides = record.weaponDieSides;
+        spec.baseToHit = record.baseToHit;
+        spec.missile = record.flags & kFlagMissile;
+        spec.oneShot = record.flags & kFlagOneShot;
+        spec.grantsFluxShield = record.flags & kFlagFlux;
+        spec.blueprintOnly = record.flags & kFlagBlueprint;
+        draft.modules.push_back(spec);
+    }
+
+    draft.designs.reserve(header.designCount);
+    for (std::uint32_t i = 0; i < header.designCount; ++i) {
+        auto record = reader.read<BinaryDesign>(designsOffset + i * sizeof(BinaryDesign));
+        if (record.faction >= kFactionCount || record.shipClass > static_cast<std::uint8_t>(ShipClass::Other) ||
+            std::size_t(record.firstSlot) + record.slotCount > header.slotCount ||
+            std::size_t(record.firstExtra) + record.extraCount > header.extraCount) {
+            throw formatError(source, 0, "invalid design record");
+        }
+        DraftDesign entry;
+        ShipDesign& design = entry.design;
+        design.id = reader.string(record.id, stringsOffset, header.stringBytes);
+        design.name = reader.string(record.name, stringsOffset, header.stringBytes);
+        design.faction = static_cast<Faction>(record.faction);
+        design.shipClass = static_cast<ShipClass>(record.shipClass);
+        design.drivesAllowed = record.flags & kFlagDrivesAllowed;
+        design.requiresDrive = record.flags & kFlagRequiresDrive;
+        design.baseHull = record.baseHull;
+        design.baseComputer = record.baseComputer;
+        design.baseShield = record.baseShield;
+        design.baseDice = record.baseDice;
+        design.baseEnergy = record.baseEnergy;
+        design.baseWeaponInitiative = record.baseWeaponInitiative;
+        design.baseWeaponDieSides = record.baseWeaponDieSides;
+        design.baseWeaponHit = record.baseWeaponHit;
+        design.baseInitiativeBonus = record.baseInitiativeBonus;
+        for (std::uint32_t s = 0; s < record.slotCount; ++s) {
+            auto slot = reader.read<BinarySlot>(slotsOffset + (record.firstSlot + s) * sizeof(BinarySlot));
+            if (slot.type > static_cast<std::uint8_t>(SlotType::Support)) {
+                throw formatError(source, 0, "invalid slot type");
+            }
+            entry.slots.emplace_back(static_cast<SlotType>(slot.type), slot.preprint);
+        }
+        for (std::uint32_t e = 0; e < record.extraCount; ++e) {
+            entry.extras.push_back(
+                reader.read<std::uint16_t>(extrasOffset + (record.firstExtra + e) * sizeof(std::uint16_t)));
+        }
+        draft.designs.push_back(std::move(entry));
+    }
+    return draft;
+}
+
+ModuleId indexOf(const CatalogView& catalog, const ModuleSpec* spec) {
+    if (!spec) {
+        return kInvalidModuleId;
+    }
+    const ModuleSpec* base = catalog.modules.data();
+    if (spec < base || spec >= base + catalog.modules.size()) {
+        throw std::runtime_error("catalog references a module outside of itself");
+    }
+    return static_cast<ModuleId>(spec - base);
+}
+
+}  // namespace
+
+CatalogSource::CatalogSource(std::unique_ptr<Storage> storage) : storage_(std::move(storage)) {}
+
+CatalogSource::~CatalogSource() = default;
+
+const CatalogView& CatalogSource::view() const {
+    return storage_->view;
+}
+
+std::unique_ptr<CatalogSource> CatalogSource::parseText(std::string text) {
+    auto storage = std::make_unique<Storage>();
+    storage->text = std::move(text);
+    Draft draft = TextParser(storage->text, storage->derivedNames).parse();
+    storage->finalize(std::move(draft), "catalog");
+    return std::unique_ptr<CatalogSource>(new CatalogSource(std::move(storage)));
+}
+
+std::unique_ptr<CatalogSource> CatalogSource::loadTextFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open catalog '" + path + "'");
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    try {
+        return parseText(contents.str());
+    } catch (const std::runtime_error& error) {
+        throw std::runtime_error(path + ": " + error.what());
+    }
+}
+
+std::unique_ptr<CatalogSource> CatalogSource::loadBinaryFile(const std::string& path) {
+    auto storage = std::make_unique<Storage>();
+    storage->mapping = MappedFile::openReadOnly(path);
+    Draft draft = readBinary(storage->mapping.bytes(), path);
+    storage->finalize(std::move(draft), path);
+    return std::unique_ptr<CatalogSource>(new CatalogSource(std::move(storage)));
+}
+
+std::unique_ptr<CatalogSource> CatalogSource::loadFile(const std::string& path) {
+    char magic[sizeof(kBinaryMagic)] = {};
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open catalog '" + path + "'");
+        }
+        in.read(magic, sizeof(magic));
+    }
+    if (std::memcmp(magic, kBinaryMagic, sizeof(kBinaryMagic)) == 0) {
+        return loadBinaryFile(path);
+    }
+    return loadTextFile(path);
+}
+
+void writeCatalogText(const CatalogView& catalog, std::ostream& out) {
+    out << "# Eclipse Second Dawn catalog\n";
+    for (const ModuleSpec& spec : catalog.modules) {
+        const ModuleSpec defaults;
+        out << "\nmodule " << spec.id << "\n";
+        out << "  label " << spec.shortLabel << "\n";
+        out << "  name " << spec.name << "\n";
+        out << "  slot " << kSlotNames.name(spec.slot) << "\n";
+        auto field = [&](const char* key, int value, int fallback) {
+            if (value != fallback) {
+                out << "  " << key << " " << value << "\n";
+            }
+        };
+        field("energy", spec.energyCost, defaults.energyCost);
+        field("power", spec.energyProvided, defaults.energyProvided);
+        field("dice", spec.dice, defaults.dice);
+        field("computer", spec.accuracyBonus, defaults.accuracyBonus);
+        field("shield", spec.shieldBonus, defaults.shieldBonus);
+        field("hull", spec.hullBonus, defaults.hullBonus);
+        field("drive", spec.drivePower, defaults.drivePower);
+        field("initiative", spec.weaponInitiative, defaults.weaponInitiative);
+        field("sides", spec.weaponDieSides, defaults.weaponDieSides);
+        field("hit", spec.baseToHit, defaults.baseToHit);
+        if (spec.missile) out << "  missile\n";
+        if (spec.oneShot) out << "  oneshot\n";
+        if (spec.grantsFluxShield) out << "  flux\n";
+        if (spec.blueprintOnly) out << "  blueprint\n";
+    }
+    for (const ShipDesign& design : catalog.designs) {
+        const ShipDesign defaults;
+        out << "\ndesign " << design.id << "\n";
+        out << "  name " << design.name << "\n";
+        out << "  faction " << kFactionNames.name(design.faction) << "\n";
+        out << "  class " << kClassNames.name(design.shipClass) << "\n";
+        auto field = [&](const char* key, int value, int fallback) {
+            if (value != fallback) {
+                out << "  " << key << " " << value << "\n";
+            }
+        };
+        field("hull", design.baseHull, defaults.baseHull);
+        field("computer", design.baseComputer, defaults.baseComputer);
+        field("shield", design.baseShield, defaults.baseShield);
+        field("dice", design.baseDice, defaults.baseDice);
+        field("energy", design.baseEnergy, defaults.baseEnergy);
+        field("initiative", design.baseInitiativeBonus, defaults.baseInitiativeBonus);
+        field("weapon-initiative", design.baseWeaponInitiative, defaults.baseWeaponInitiative);
+        field("weapon-sides", design.baseWeaponDieSides, defaults.baseWeaponDieSides);
+        field("weapon-hit", design.baseWeaponHit, defaults.baseWeaponHit);
+        if (!design.drivesAllowed) {
+            out << "  drives forbidden\n";
+        } else if (!design.requiresDrive) {
+            out << "  drives optional\n";
+        }
+        for (const SlotBlueprint& slot : design.slots) {
+            out << "  slot " << kSlotNames.name(slot.preferredType);
+            if (slot.preprint) {
+                out << " " << slot.preprint->id;
+            }
+            out << "\n";
+        }
+        for (const ModuleSpec* extra : design.extras) {
+            out << "  extra " << extra->id << "\n";
+        }
+    }
+}
+
+void writeCatalogBinary(const CatalogView& catalog, const std::string& path) {
+    requireLittleEndian();
+    std::string strings;
+    auto intern = [&](std::string_view text) {
+        BinaryString ref{static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(text.size())};
+        strings.append(text);
+        return ref;
+    };
+
+    std::vector<BinaryModule> modules;
+    modules.reserve(catalog.modules.size());
+    for (const ModuleSpec& spec : catalog.modules) {
+        BinaryModule record{};
+        record.id = intern(spec.id);
+        record.shortLabel = intern(spec.shortLabel);
+        record.name = intern(spec.name);
+        record.slot = static_cast<std::uint8_t>(spec.slot);
+        record.flags = static_cast<std::uint8_t>((spec.missile ? kFlagMissile : 0) |
+                                                 (spec.oneShot ? kFlagOneShot : 0) |
+                                                 (spec.grantsFluxShield ? kFlagFlux : 0) |
+                                                 (spec.blueprintOnly ? kFlagBlueprint : 0));
+        record.energyCost = static_cast<std::int16_t>(spec.energyCost);
+        record.energyProvided = static_cast<std::int16_t>(spec.energyProvided);
+        record.dice = static_cast<std::int16_t>(spec.dice);
+        record.accuracyBonus = static_cast<std::int16_t>(spec.accuracyBonus);
+        record.shieldBonus = static_cast<std::int16_t>(spec.shieldBonus);
+        record.hullBonus = static_cast<std::int16_t>(spec.hullBonus);
+        record.drivePower = static_cast<std::int16_t>(spec.drivePower);
+        record.weaponInitiative = static_cast<std::int16_t>(spec.weaponInitiative);
+        record.weaponDieSides = static_cast<std::int16_t>(spec.weaponDieSides);
+        record.baseToHit = static_cast<std::int16_t>(spec.baseToHit);
+        modules.push_back(record);
+    }
+
+    std::vector<BinaryDesign> designs;
+    std::vector<BinarySlot> slots;
+    std::vector<std::uint16_t> extras;
+    for (const ShipDesign& design : catalog.designs) {
+        BinaryDesign record{};
+        record.id = intern(design.id);
+        record.name = intern(design.name);
+        record.faction = static_cast<std::uint8_t>(design.faction);
+        record.shipClass = static_cast<std::uint8_t>(design.shipClass);
+        record.flags = static_cast<std::uint8_t>((design.drivesAllowed ? kFlagDrivesAllowed : 0) |
+                                                 (design.requiresDrive ? kFlagRequiresDrive : 0));
+        record.baseHull = static_cast<std::int16_t>(design.baseHull);
+        record.baseComputer = static_cast<std::int16_t>(design.baseComputer);
+        record.baseShield = static_cast<std::int16_t>(design.baseShield);
+        record.baseDice = static_cast<std::int16_t>(design.baseDice);
+        record.baseEnergy = static_cast<std::int16_t>(design.baseEnergy);
+        record.baseWeaponInitiative = static_cast<std::int16_t>(design.baseWeaponInitiative);
+        record.baseWeaponDieSides = static_cast<std::int16_t>(design.baseWeaponDieSides);
+        record.baseWeaponHit = static_cast<std::int16_t>(design.baseWeaponHit);
+        record.baseInitiativeBonus = static_cast<std::int16_t>(design.baseInitiativeBonus);
+        record.firstSlot = static_cast<std::uint32_t>(slots.size());
+        record.slotCount = static_cast<std::uint32_t>(design.slots.size());
+        record.firstExtra = static_cast<std::uint32_t>(extras.size());
+        record.extraCount = static_cast<std::uint32_t>(design.extras.size());
+        for (const SlotBlueprint& slot : design.slots) {
+            slots.push_back({static_cast<std::uint8_t>(slot.preferredType), 0, indexOf(catalog, slot.preprint)});
+        }
+        for (const ModuleSpec* extra : design.extras) {
+            extras.push_back(indexOf(catalog, extra));
+        }
+        designs.push_back(record);
+    }
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+    header.version = kBinaryVersion;
+    header.moduleCount = static_cast<std::uint32_t>(modules.size());
+    header.designCount = static_cast<std::uint32_t>(designs.size());
+    header.slotCount = static_cast<std::uint32_t>(slots.size());
+    header.extraCount = static_cast<std::uint32_t>(extras.size());
+    header.stringBytes = static_cast<std::uint32_t>(strings.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write catalog '" + path + "'");
+    }
+    auto write = [&](const void* data, std::size_t size) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    };
+    write(&header, sizeof(header));
+    write(modules.data(), modules.size() * sizeof(BinaryModule));
+    write(designs.data(), designs.size() * sizeof(BinaryDesign));
+    write(slots.data(), slots.size() * sizeof(BinarySlot));
+    write(extras.data(), extras.size() * sizeof(std::uint16_t));
+    write(strings.data(), strings.size());
+    if (!out) {
+        throw std::runtime_error("Failed writing catalog '" + path + "'");
+    }
+}
+
+}  // namespace eclipse
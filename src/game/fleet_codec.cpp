@@ -0,0 +1,406 @@
+#include "game/fleet_codec.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+
+#include "game/tech_catalog.hpp"
+
+namespace eclipse {
+
+namespace {
+constexpr char kBinaryMagic[4] = {'E', 'S', 'F', 'L'};
+constexpr std::size_t kHeaderSize = 16;
+constexpr std::string_view kTextHeader = "eclipse-fleets";
+
+std::runtime_error codecError(std::string_view what, std::string_view token) {
+    return std::runtime_error(std::string(what) + " '" + std::string(token) + "'");
+}
+
+std::string_view nextToken(std::string_view& text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        text = {};
+        return {};
+    }
+    size_t end = text.find_first_of(" \t", start);
+    std::string_view token = text.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+    text = end == std::string_view::npos ? std::string_view{} : text.substr(end);
+    return token;
+}
+
+std::string_view trim(std::string_view text) {
+    size_t start = text.find_first_not_of(" \r\n\t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = text.find_last_not_of(" \r\n\t");
+    return text.substr(start, end - start + 1);
+}
+
+std::uint16_t readU16(const std::byte* data) {
+    return static_cast<std::uint16_t>(std::to_integer<unsigned>(data[0]) | (std::to_integer<unsigned>(data[1]) << 8));
+}
+
+std::uint32_t readU32(const std::byte* data) {
+    return readU16(data) | (std::uint32_t(readU16(data + 2)) << 16);
+}
+
+void appendU16(std::vector<std::byte>& out, std::uint32_t value) {
+    out.push_back(static_cast<std::byte>(value & 0xFF));
+    out.push_back(static_cast<std::byte>((value >> 8) & 0xFF));
+}
+
+void appendU32(std::vector<std::byte>& out, std::uint32_t value) {
+    appendU16(out, value & 0xFFFF);
+    appendU16(out, value >> 16);
+}
+
+void appendFleet(std::vector<std::byte>& out, const std::vector<ShipLoadout>& fleet) {
+    for (const ShipLoadout& ship : fleet) {
+        LoadoutSignature signature = TechCatalog::signature(ship);
+        appendU16(out, signature.design);
+        appendU16(out, static_cast<std::uint32_t>(signature.modules.size()));
+        for (ModuleId module : signature.modules) {
+            appendU16(out, module);
+        }
+    }
+}
+
+// Walks one fleet of a matchup record, checking every field against the end of
+// the buffer and the installed catalog. Returns the offset just past the fleet.
+std::size_t validateFleet(std::span<const std::byte> bytes, std::size_t offset, std::size_t count) {
+    const CatalogView& catalog = TechCatalog::view();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (offset + 4 > bytes.size()) {
+            throw std::runtime_error("truncated fleet archive");
+        }
+        std::uint16_t design = readU16(bytes.data() + offset);
+        std::uint16_t slots = readU16(bytes.data() + offset + 2);
+        if (design >= catalog.designs.size() || slots != catalog.designs[design].slots.size()) {
+            throw std::runtime_error("fleet archive refers to an unknown design");
+        }
+        offset += 4;
+        if (offset + std::size_t(slots) * 2 > bytes.size()) {
+            throw std::runtime_error("truncated fleet archive");
+        }
+        for (std::uint16_t slot = 0; slot < slots; ++slot) {
+            std::uint16_t module = readU16(bytes.data() + offset + slot * 2u);
+            if (module != kInvalidModuleId && module >= catalog.modules.size()) {
+                throw std::runtime_error("fleet archive refers to an unknown module");
+            }
+        }
+        offset += std::size_t(slots) * 2;
+    }
+    return offset;
+}
+
+std::size_t fleetBytes(const std::byte* data, std::size_t count) {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        size += (2 + std::size_t(readU16(data + size + 2))) * 2;
+    }
+    return size;
+}
+}  // namespace
+
+std::string formatLoadout(const ShipLoadout& ship) {
+    std::string text(ship.design() ? ship.design()->id : std::string_view("?"));
+    bool first = true;
+    for (size_t i = 0; i < ship.slotCount(); ++i) {
+        const ModuleSpec* module = ship.moduleAt(i);
+        if (!module) {
+            continue;
+        }
+        text += first ? '[' : ',';
+        text += std::to_string(i);
+        text += '=';
+        text += module->id;
+        first = false;
+    }
+    if (!first) {
+        text += ']';
+    }
+    return text;
+}
+
+std::string formatFleet(const std::vector<ShipLoadout>& fleet) {
+    std::string text;
+    for (const ShipLoadout& ship : fleet) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += formatLoadout(ship);
+    }
+    return text;
+}
+
+std::string formatMatchup(const Matchup& matchup) {
+    return formatFleet(matchup.humans) + " vs " + formatFleet(matchup.aliens);
+}
+
+ShipLoadout parseLoadout(std::string_view token) {
+    size_t bracket = token.find('[');
+    std::string_view designId = token.substr(0, bracket);
+    const ShipDesign* design = TechCatalog::findDesign(designId);
+    if (!design) {
+        throw codecError("unknown design", designId);
+    }
+    ShipLoadout ship(design);
+    if (bracket == std::string_view::npos) {
+        return ship;
+    }
+    if (token.back() != ']') {
+        throw codecError("unterminated slot list in", token);
+    }
+    std::string_view slots = token.substr(bracket + 1, token.size() - bracket - 2);
+    while (!slots.empty()) {
+        size_t comma = slots.find(',');
+        std::string_view entry = slots.substr(0, comma);
+        slots = comma == std::string_view::npos ? std::string_view{} : slots.substr(comma + 1);
+        size_t equals = entry.find('=');
+        size_t index = 0;
+        auto [end, error] = std::from_chars(entry.data(), entry.data() + (equals == std::string_view::npos ? 0 : equals), index);
+        if (equals == std::string_view::npos || error != std::errc() || end != entry.data() + equals ||
+            index >= ship.slotCount()) {
+            throw codecError("bad slot entry", entry);
+        }
+        std::string_view moduleId = entry.substr(equals + 1);
+        const ModuleSpec* module = TechCatalog::findModule(moduleId);
+        if (!module) {
+            throw codecError("unknown module", moduleId);
+        }
+        if (!ship.isSlotCompatible(index, *module)) {
+            throw codecError("module does not fit", entry);
+        }
+        ship.setModule(index, module);
+    }
+    return ship;
+}
+
+std::vector<ShipLoadout> parseFleet(std::string_view text) {
+    std::vector<ShipLoadout> fleet;
+    for (std::string_view token = nextToken(text); !token.empty(); token = nextToken(text)) {
+        fleet.push_back(parseLoadout(token));
+    }
+    return fleet;
+}
+
+Matchup parseMatchup(std::string_view text) {
+    text = trim(text);
+    size_t separator = text.find(" vs ");
+    if (separator == std::string_view::npos) {
+        throw std::runtime_error("expected '<fleet> vs <fleet>'");
+    }
+    Matchup matchup{parseFleet(text.substr(0, separator)), parseFleet(text.substr(separator + 4))};
+    if (matchup.humans.empty() || matchup.aliens.empty()) {
+        throw std::runtime_error("both fleets need at least one ship");
+    }
+    return matchup;
+}
+
+void writeMatchupsText(std::ostream& out, std::span<const Matchup> matchups) {
+    out << kTextHeader << ' ' << kFleetTextVersion << '\n';
+    for (const Matchup& matchup : matchups) {
+        out << formatMatchup(matchup) << '\n';
+    }
+}
+
+std::vector<Matchup> parseMatchupsText(std::string_view document) {
+    std::vector<Matchup> matchups;
+    bool sawHeader = false;
+    int lineNumber = 0;
+    while (!document.empty()) {
+        size_t newline = document.find('\n');
+        std::string_view line = trim(document.substr(0, newline));
+        document = newline == std::string_view::npos ? std::string_view{} : document.substr(newline + 1);
+        ++lineNumber;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        if (!sawHeader) {
+            std::string_view rest = line;
+            std::string_view tag = nextToken(rest);
+            std::string_view version = trim(rest);
+            if (tag != kTextHeader) {
+                throw codecError("not a matchup file: expected header, got", line);
+            }
+            if (version != std::to_string(kFleetTextVersion)) {
+                throw codecError("unsupported matchup file version", version);
+            }
+            sawHeader = true;
+            continue;
+        }
+        try {
+            matchups.push_back(parseMatchup(line));
+        } catch (const std::runtime_error& error) {
+            throw std::runtime_error("line " + std::to_string(lineNumber) + ": " + error.what());
+        }
+    }
+    if (!sawHeader) {
+        throw std::runtime_error("not a matchup file: missing header");
+    }
+    return matchups;
+}
+
+std::uint32_t catalogFingerprint() {
+    // FNV-1a over every module and design id in index order plus each design's
+    // slot count: exactly what binary archives depend on.
+    std::uint32_t hash = 2166136261u;
+    auto mix = [&](std::string_view text) {
+        for (char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        hash = (hash ^ 0xFFu) * 16777619u;
+    };
+    const CatalogView& catalog = TechCatalog::view();
+    for (const ModuleSpec& module : catalog.modules) {
+        mix(module.id);
+    }
+    for (const ShipDesign& design : catalog.designs) {
+        mix(design.id);
+        hash = (hash ^ static_cast<std::uint32_t>(design.slots.size())) * 16777619u;
+    }
+    return hash;
+}
+
+void appendMatchupBinary(std::vector<std::byte>& out, const Matchup& matchup) {
+    if (matchup.humans.size() > 0xFFFF || matchup.aliens.size() > 0xFFFF) {
+        throw std::runtime_error("fleet too large to encode");
+    }
+    appendU16(out, static_cast<std::uint32_t>(matchup.humans.size()));
+    appendU16(out, static_cast<std::uint32_t>(matchup.aliens.size()));
+    appendFleet(out, matchup.humans);
+    appendFleet(out, matchup.aliens);
+}
+
+std::vector<std::byte> encodeMatchups(std::span<const Matchup> matchups) {
+    std::vector<std::byte> out;
+    out.reserve(kHeaderSize + matchups.size() * 32);
+    for (char c : kBinaryMagic) {
+        out.push_back(static_cast<std::byte>(c));
+    }
+    appendU16(out, kFleetBinaryVersion);
+    appendU16(out, 0);
+    appendU32(out, catalogFingerprint());
+    appendU32(out, static_cast<std::uint32_t>(matchups.size()));
+    for (const Matchup& matchup : matchups) {
+        appendMatchupBinary(out, matchup);
+    }
+    return out;
+}
+
+void writeMatchupsBinary(const std::string& path, std::span<const Matchup> matchups) {
+    std::vector<std::byte> bytes = encodeMatchups(matchups);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write matchups '" + path + "'");
+    }
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+        throw std::runtime_error("Cannot write matchups '" + path + "'");
+    }
+}
+
+std::uint16_t LoadoutView::field(std::size_t index) const {
+    return readU16(data_ + index * sizeof(std::uint16_t));
+}
+
+ShipLoadout LoadoutView::toLoadout() const {
+    LoadoutSignature signature;
+    signature.design = design();
+    signature.modules.reserve(slotCount());
+    for (std::size_t slot = 0; slot < slotCount(); ++slot) {
+        signature.modules.push_back(module(slot));
+    }
+    return TechCatalog::loadout(signature);
+}
+
+std::vector<ShipLoadout> FleetView::toFleet() const {
+    std::vector<ShipLoadout> fleet;
+    fleet.reserve(size_);
+    for (LoadoutView ship : *this) {
+        fleet.push_back(ship.toLoadout());
+    }
+    return fleet;
+}
+
+FleetView MatchupView::humans() const {
+    return FleetView(data_ + 4, readU16(data_));
+}
+
+FleetView MatchupView::aliens() const {
+    std::size_t humans = readU16(data_);
+    return FleetView(data_ + 4 + fleetBytes(data_ + 4, humans), readU16(data_ + 2));
+}
+
+MatchupView MatchupArchive::iterator::operator*() const {
+    std::size_t humans = readU16(data_);
+    std::size_t aliens = readU16(data_ + 2);
+    std::size_t humanBytes = fleetBytes(data_ + 4, humans);
+    return MatchupView(data_, 4 + humanBytes + fleetBytes(data_ + 4 + humanBytes, aliens));
+}
+
+MatchupArchive::MatchupArchive(std::span<const std::byte> bytes) : bytes_(bytes) {
+    if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kBinaryMagic, sizeof(kBinaryMagic)) != 0) {
+        throw std::runtime_error("not a fleet archive");
+    }
+    std::uint16_t version = readU16(bytes.data() + 4);
+    if (version != kFleetBinaryVersion) {
+        throw std::runtime_error("unsupported fleet archive version " + std::to_string(version));
+    }
+    if (readU32(bytes.data() + 8) != catalogFingerprint()) {
+        throw std::runtime_error("fleet archive was written against a different catalog");
+    }
+    size_ = readU32(bytes.data() + 12);
+    std::size_t offset = kHeaderSize;
+    for (std::size_t i = 0; i < size_; ++i) {
+        if (offset + 4 > bytes.size()) {
+            throw std::runtime_error("truncated fleet archive");
+        }
+        std::size_t humans = readU16(bytes.data() + offset);
+        std::size_t aliens = readU16(bytes.data() + offset + 2);
+        offset = validateFleet(bytes, offset + 4, humans);
+        offset = validateFleet(bytes, offset, aliens);
+    }
+    if (offset != bytes.size()) {
+        throw std::runtime_error("trailing bytes after fleet archive");
+    }
+}
+
+MatchupArchive MatchupArchive::open(const std::string& path) {
+    MappedFile file = MappedFile::openReadOnly(path);
+    MatchupArchive archive(file.bytes());
+    archive.file_ = std::move(file);
+    return archive;
+}
+
+MatchupArchive::iterator MatchupArchive::begin() const {
+    return iterator(bytes_.data() + kHeaderSize, 0);
+}
+
+std::vector<Matchup> MatchupArchive::toMatchups() const {
+    std::vector<Matchup> matchups;
+    matchups.reserve(size_);
+    for (MatchupView matchup : *this) {
+        matchups.push_back(matchup.toMatchup());
+    }
+    return matchups;
+}
+
+std::vector<Matchup> loadMatchups(const std::string& path) {
+    MappedFile file = MappedFile::openReadOnly(path);
+    std::span<const std::byte> bytes = file.bytes();
+    if (bytes.size() >= sizeof(kBinaryMagic) && std::memcmp(bytes.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0) {
+        return MatchupArchive(bytes).toMatchups();
+    }
+    try {
+        return parseMatchupsText(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    } catch (const std::runtime_error& error) {
+        throw std::runtime_error(path + ": " + error.what());
+    }
+}
+
+}  // namespace eclipse
@@ -0,0 +1,77 @@
+#include "game/matchup_matrix.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "game/solve_cache.hpp"
+#include "game/tech_catalog.hpp"
+#include "util/thread_pool.hpp"
+
+namespace eclipse {
+
+std::vector<MatrixEntry> factionDesignEntries() {
+    std::vector<MatrixEntry> entries;
+    for (Faction faction : {Faction::Human, Faction::Eridani, Faction::Planta, Faction::Orion}) {
+        for (const ShipDesign* design : TechCatalog::factionDesigns(faction)) {
+            entries.push_back({std::string(design->id), {ShipLoadout(design)}});
+        }
+    }
+    return entries;
+}
+
+std::size_t solveMatrix(const std::vector<MatrixEntry>& entries,
+                        const MatrixOptions& options,
+                        const std::function<void(const MatrixCell&)>& onCell,
+                        std::stop_token stop) {
+    std::shared_ptr<SolveCache> cache = options.cache ? options.cache : std::make_shared<SolveCache>();
+    std::atomic<std::size_t> solved{0};
+    // A failing cell stops the others; the caller's stop is forwarded to it.
+    std::stop_source stopAll;
+    std::stop_callback forwardStop(stop, [&stopAll] { stopAll.request_stop(); });
+    std::mutex failureMutex;
+    std::exception_ptr failure;
+    ThreadPool pool(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()));
+    for (std::size_t row = 0; row < entries.size(); ++row) {
+        for (std::size_t column = 0; column < entries.size(); ++column) {
+            pool.submit([&, row, column] {
+                std::stop_token cellStop = stopAll.get_token();
+                if (cellStop.stop_requested()) {
+                    return;
+                }
+                try {
+                    BattleSimulator simulator(options.store);
+                    simulator.setSharedCache(cache);
+                    simulator.setShieldModel(options.shields);
+                    MatrixCell cell;
+                    cell.row = row;
+                    cell.column = column;
+                    auto started = std::chrono::steady_clock::now();
+                    cell.summary = simulator.simulate(entries[row].fleet, entries[column].fleet, cellStop);
+                    cell.milliseconds =
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+                    cell.stats = simulator.lastStats();
+                    solved.fetch_add(1, std::memory_order_relaxed);
+                    onCell(cell);
+                } catch (const SimulationCancelled&) {
+                } catch (...) {
+                    std::lock_guard lock(failureMutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                    stopAll.request_stop();
+                }
+            });
+        }
+    }
+    pool.wait();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    return solved.load();
+}
+
+}  // namespace eclipse
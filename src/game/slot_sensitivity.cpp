@@ -0,0 +1,123 @@
+#include "game/slot_sensitivity.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "game/solve_cache.hpp"
+#include "game/tech_catalog.hpp"
+#include "util/thread_pool.hpp"
+
+namespace eclipse {
+
+namespace {
+double sideWin(const BattleSummary& summary, BattleSide side) {
+    return side == BattleSide::Humans ? summary.humanWin : summary.alienWin;
+}
+}  // namespace
+
+SensitivityReport slotSensitivity(const std::vector<ShipLoadout>& humans,
+                                  const std::vector<ShipLoadout>& aliens,
+                                  const SensitivityOptions& options,
+                                  std::stop_token stop) {
+    std::shared_ptr<SolveCache> cache = options.cache ? options.cache : std::make_shared<SolveCache>();
+    auto solve = [&](const std::vector<ShipLoadout>& varied, std::stop_token token) {
+        BattleSimulator simulator(options.store);
+        simulator.setSharedCache(cache);
+        simulator.setShieldModel(options.shields);
+        bool humansVaried = options.side == BattleSide::Humans;
+        return simulator.simulate(humansVaried ? varied : humans, humansVaried ? aliens : varied, token);
+    };
+
+    const std::vector<ShipLoadout>& fleet = options.side == BattleSide::Humans ? humans : aliens;
+    SensitivityReport report;
+    report.baseline = solve(fleet, stop);
+
+    // Distinct variant fleets, and for every change the variant it resolves to.
+    std::vector<std::vector<ShipLoadout>> variants;
+    std::vector<std::size_t> variantOf;
+    std::map<StateKey, std::size_t> seen;
+    auto consider = [&](std::size_t ship, std::size_t slot, const ModuleSpec* after) {
+        std::vector<ShipLoadout> variant = fleet;
+        if (after) {
+            variant[ship].setModule(slot, after);
+        } else {
+            variant[ship].clearModule(slot);
+        }
+        if (options.requireValid && !variant[ship].isValid()) {
+            return;
+        }
+        StateKey key = options.side == BattleSide::Humans
+                           ? BattleSimulator::matchupKey(variant, aliens, options.shields)
+                           : BattleSimulator::matchupKey(humans, variant, options.shields);
+        auto [it, inserted] = seen.emplace(key, variants.size());
+        if (inserted) {
+            variants.push_back(std::move(variant));
+        }
+        report.changes.push_back({ship, slot, fleet[ship].moduleAt(slot), after, {}, 0.0});
+        variantOf.push_back(it->second);
+    };
+    for (std::size_t ship = 0; ship < fleet.size(); ++ship) {
+        for (std::size_t slot = 0; slot < fleet[ship].slotCount(); ++slot) {
+            const ModuleSpec* active = fleet[ship].activeModuleAt(slot);
+            for (const ModuleSpec& module : TechCatalog::modules()) {
+                if (!module.blueprintOnly && &module != active && fleet[ship].isSlotCompatible(slot, module)) {
+                    consider(ship, slot, &module);
+                }
+            }
+            if (fleet[ship].moduleAt(slot)) {
+                consider(ship, slot, nullptr);
+            }
+        }
+    }
+
+    std::vector<BattleSummary> summaries(variants.size());
+    {
+        // A failing variant stops the others; the caller's stop is forwarded.
+        std::stop_source stopAll;
+        std::stop_callback forwardStop(stop, [&stopAll] { stopAll.request_stop(); });
+        std::mutex failureMutex;
+        std::exception_ptr failure;
+        ThreadPool pool(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()));
+        for (std::size_t i = 0; i < variants.size(); ++i) {
+            pool.submit([&, i] {
+                std::stop_token variantStop = stopAll.get_token();
+                if (variantStop.stop_requested()) {
+                    return;
+                }
+                try {
+                    summaries[i] = solve(variants[i], variantStop);
+                } catch (const SimulationCancelled&) {
+                } catch (...) {
+                    std::lock_guard lock(failureMutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                    stopAll.request_stop();
+                }
+            });
+        }
+        pool.wait();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+    if (stop.stop_requested()) {
+        throw SimulationCancelled();
+    }
+
+    double baseline = sideWin(report.baseline, options.side);
+    for (std::size_t i = 0; i < report.changes.size(); ++i) {
+        report.changes[i].summary = summaries[variantOf[i]];
+        report.changes[i].delta = sideWin(report.changes[i].summary, options.side) - baseline;
+    }
+    std::stable_sort(report.changes.begin(), report.changes.end(),
+                     [](const SlotChange& a, const SlotChange& b) { return a.delta > b.delta; });
+    report.solved = variants.size();
+    return report;
+}
+
+}  // namespace eclipse
@@ -0,0 +1,381 @@
+#include "game/solution_store.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "io/mapped_file.hpp"
+
+namespace eclipse {
+
+namespace {
+constexpr char kStoreMagic[4] = {'E', 'S', 'S', 'S'};
+constexpr std::uint32_t kStoreFormatVersion = 1;
+constexpr std::size_t kCompactChunk = 4096;  // records written per call while compacting
+
+struct StoreHeader {
+    char magic[4];
+    std::uint32_t formatVersion;
+    std::uint32_t stateVersion;
+    std::uint32_t recordSize;
+    std::uint64_t sortedCount;
+    std::uint64_t reserved;
+};
+
+struct StoreRecord {
+    std::uint64_t lo;
+    std::uint64_t hi;
+    double humanWin;
+    double alienWin;
+    double draw;
+    double expectedRounds;
+};
+
+static_assert(sizeof(StoreHeader) == 32);
+static_assert(sizeof(StoreRecord) == 48);
+
+struct StateKeyHash {
+    std::size_t operator()(const StateKey& key) const noexcept {
+        return static_cast<std::size_t>(key.lo ^ (key.hi * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+using SolutionMap = std::unordered_map<StateKey, BattleSummary, StateKeyHash>;
+
+StoreRecord toRecord(const StateKey& key, const BattleSummary& summary) {
+    return {key.lo, key.hi, summary.humanWin, summary.alienWin, summary.draw, summary.expectedRounds};
+}
+
+BattleSummary toSummary(const StoreRecord& record) {
+    return {record.humanWin, record.alienWin, record.draw, record.expectedRounds};
+}
+
+StoreHeader makeHeader(std::uint64_t sortedCount) {
+    StoreHeader header{};
+    std::memcpy(header.magic, kStoreMagic, sizeof(kStoreMagic));
+    header.formatVersion = kStoreFormatVersion;
+    header.stateVersion = kSolutionStateVersion;
+    header.recordSize = sizeof(StoreRecord);
+    header.sortedCount = sortedCount;
+    return header;
+}
+}  // namespace
+
+struct SolutionStore::Storage {
+    mutable std::shared_mutex mutex;
+    std::atomic<bool> loaded{false};
+    // The file holds nothing usable (missing, foreign or another state version)
+    // and must be rewritten from scratch on the next flush.
+    bool rewrite = true;
+    // The path holds some other file; it is never overwritten.
+    bool foreign = false;
+    std::size_t tailLimit = SolutionStore::kDefaultTailLimit;
+    MappedFile mapping;
+    std::size_t sortedCount = 0;
+    SolutionMap tail;
+    SolutionMap pending;
+
+    StoreRecord sortedRecord(std::size_t index) const {
+        StoreRecord record;
+        std::memcpy(&record, mapping.bytes().data() + sizeof(StoreHeader) + index * sizeof(StoreRecord),
+                    sizeof(StoreRecord));
+        return record;
+    }
+
+    bool findSorted(const StateKey& key, BattleSummary& result) const {
+        std::size_t low = 0;
+        std::size_t high = sortedCount;
+        while (low < high) {
+            std::size_t mid = low + (high - low) / 2;
+            StoreRecord record = sortedRecord(mid);
+            StateKey probe{record.lo, record.hi};
+            if (probe == key) {
+                result = toSummary(record);
+                return true;
+            }
+            if (probe < key) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return false;
+    }
+
+    bool findLocked(const StateKey& key, BattleSummary& result) const {
+        for (const SolutionMap* map : {&pending, &tail}) {
+            auto it = map->find(key);
+            if (it != map->end()) {
+                result = it->second;
+                return true;
+            }
+        }
+        return findSorted(key, result);
+    }
+
+    void load(const std::string& path) {
+        rewrite = true;
+        foreign = false;
+        sortedCount = 0;
+        tail.clear();
+        mapping = MappedFile();
+        std::error_code error;
+        std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+        if (error) {
+            return;
+        }
+        if (fileSize < sizeof(StoreHeader)) {
+            foreign = fileSize > 0;
+            return;
+        }
+        if constexpr (std::endian::native != std::endian::little) {
+            return;
+        }
+        MappedFile file = MappedFile::openReadOnly(path);
+        auto bytes = file.bytes();
+        StoreHeader header{};
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, kStoreMagic, sizeof(kStoreMagic)) != 0) {
+            foreign = true;
+            return;
+        }
+        if (header.formatVersion != kStoreFormatVersion || header.stateVersion != kSolutionStateVersion ||
+            header.recordSize != sizeof(StoreRecord)) {
+            return;
+        }
+        // Drop a partially written trailing record (interrupted flush) so that
+        // later appends stay aligned. Nothing past the last whole record is read.
+        std::uintmax_t aligned = fileSize - (fileSize - sizeof(StoreHeader)) % sizeof(StoreRecord);
+        if (aligned != fileSize) {
+            std::filesystem::resize_file(path, aligned, error);
+            if (error) {
+                return;
+            }
+        }
+        std::size_t records = (bytes.size() - sizeof(StoreHeader)) / sizeof(StoreRecord);
+        mapping = std::move(file);
+        sortedCount = static_cast<std::size_t>(std::min<std::uint64_t>(header.sortedCount, records));
+        for (std::size_t i = sortedCount; i < records; ++i) {
+            StoreRecord record = sortedRecord(i);
+            tail.emplace(StateKey{record.lo, record.hi}, toSummary(record));
+        }
+        rewrite = false;
+        if (tail.size() > tailLimit) {
+            try {
+                compactLocked(path);
+            } catch (const std::exception&) {
+                // A read-only or full disk: keep answering from the tail.
+            }
+        }
+    }
+
+    // Merges the mapped sorted run with the sorted tail and pending entries
+    // into a new file, a chunk at a time, and swaps it in.
+    void compactLocked(const std::string& path) {
+        if (foreign) {
+            throw std::runtime_error("'" + path + "' is not a solution store");
+        }
+        auto keyOf = [](const StoreRecord& record) { return StateKey{record.lo, record.hi}; };
+        std::vector<StoreRecord> fresh;
+        fresh.reserve(tail.size() + pending.size());
+        for (const SolutionMap* map : {&tail, &pending}) {
+            for (const auto& [key, summary] : *map) {
+                fresh.push_back(toRecord(key, summary));
+            }
+        }
+        std::sort(fresh.begin(), fresh.end(),
+                  [&](const StoreRecord& a, const StoreRecord& b) { return keyOf(a) < keyOf(b); });
+
+        const std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            StoreHeader header = makeHeader(0);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            std::vector<StoreRecord> chunk;
+            chunk.reserve(kCompactChunk);
+            auto writeChunk = [&] {
+                out.write(reinterpret_cast<const char*>(chunk.data()),
+                          static_cast<std::streamsize>(chunk.size() * sizeof(StoreRecord)));
+                chunk.clear();
+            };
+            std::uint64_t written = 0;
+            std::optional<StateKey> last;
+            std::size_t sorted = 0;
+            std::size_t next = 0;
+            while (sorted < sortedCount || next < fresh.size()) {
+                StoreRecord record;
+                if (next == fresh.size() ||
+                    (sorted < sortedCount && !(keyOf(fresh[next]) < keyOf(sortedRecord(sorted))))) {
+                    record = sortedRecord(sorted++);
+                } else {
+                    record = fresh[next++];
+                }
+                if (last && *last == keyOf(record)) {
+                    continue;
+                }
+                last = keyOf(record);
+                chunk.push_back(record);
+                ++written;
+                if (chunk.size() == kCompactChunk) {
+                    writeChunk();
+                }
+            }
+            writeChunk();
+            header = makeHeader(written);
+            out.seekp(0);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            if (!out) {
+                throw std::runtime_error("Failed writing solution store '" + temporary + "'");
+            }
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot replace solution store '" + path + "'");
+        }
+        pending.clear();
+        load(path);
+    }
+
+    // Callers hold the exclusive lock.
+    void loadLocked(const std::string& path) {
+        if (!loaded.load(std::memory_order_relaxed)) {
+            load(path);
+            loaded.store(true, std::memory_order_release);
+        }
+    }
+
+    void ensureLoaded(const std::string& path) {
+        if (!loaded.load(std::memory_order_acquire)) {
+            std::unique_lock lock(mutex);
+            loadLocked(path);
+        }
+    }
+};
+
+SolutionStore::SolutionStore(std::string path, std::size_t tailLimit)
+    : path_(std::move(path)), tailLimit_(tailLimit), storage_(std::make_unique<Storage>()) {
+    storage_->tailLimit = tailLimit_;
+}
+
+SolutionStore::~SolutionStore() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Losing unflushed solutions only costs recomputation.
+    }
+}
+
+std::shared_ptr<SolutionStore> SolutionStore::open(const std::string& path) {
+    return std::make_shared<SolutionStore>(path);
+}
+
+bool SolutionStore::find(const StateKey& key, BattleSummary& result) const {
+    storage_->ensureLoaded(path_);
+    std::shared_lock lock(storage_->mutex);
+    return storage_->findLocked(key, result);
+}
+
+void SolutionStore::insert(const StateKey& key, const BattleSummary& result) {
+    BattleSummary existing;
+    if (find(key, existing)) {
+        return;
+    }
+    std::unique_lock lock(storage_->mutex);
+    storage_->pending.emplace(key, result);
+}
+
+void SolutionStore::flush() {
+    std::unique_lock lock(storage_->mutex);
+    Storage& storage = *storage_;
+    if (storage.pending.empty()) {
+        return;
+    }
+    storage.loadLocked(path_);
+    if (storage.foreign) {
+        throw std::runtime_error("'" + path_ + "' is not a solution store");
+    }
+    std::vector<StoreRecord> records;
+    records.reserve(storage.pending.size());
+    for (const auto& [key, summary] : storage.pending) {
+        records.push_back(toRecord(key, summary));
+    }
+
+    std::ofstream out;
+    if (storage.rewrite) {
+        out.open(path_, std::ios::binary | std::ios::trunc);
+        StoreHeader header = makeHeader(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    } else {
+        out.open(path_, std::ios::binary | std::ios::app);
+    }
+    if (!out) {
+        throw std::runtime_error("Cannot write solution store '" + path_ + "'");
+    }
+    out.write(reinterpret_cast<const char*>(records.data()),
+              static_cast<std::streamsize>(records.size() * sizeof(StoreRecord)));
+    if (!out) {
+        throw std::runtime_error("Failed writing solution store '" + path_ + "'");
+    }
+    storage.rewrite = false;
+    storage.tail.merge(storage.pending);
+    storage.pending.clear();
+    out.close();
+    if (storage.tail.size() > tailLimit_) {
+        storage.compactLocked(path_);
+    }
+}
+
+void SolutionStore::compact() {
+    std::unique_lock lock(storage_->mutex);
+    storage_->loadLocked(path_);
+    storage_->compactLocked(path_);
+}
+
+void SolutionStore::merge(const SolutionStore& other) {
+    if (&other == this) {
+        return;
+    }
+    std::vector<StoreRecord> records;
+    {
+        other.storage_->ensureLoaded(other.path_);
+        std::shared_lock lock(other.storage_->mutex);
+        const Storage& source = *other.storage_;
+        records.reserve(source.sortedCount + source.tail.size() + source.pending.size());
+        for (std::size_t i = 0; i < source.sortedCount; ++i) {
+            records.push_back(source.sortedRecord(i));
+        }
+        for (const SolutionMap* map : {&source.tail, &source.pending}) {
+            for (const auto& [key, summary] : *map) {
+                records.push_back(toRecord(key, summary));
+            }
+        }
+    }
+    for (const StoreRecord& record : records) {
+        insert(StateKey{record.lo, record.hi}, toSummary(record));
+    }
+}
+
+std::size_t SolutionStore::size() const {
+    storage_->ensureLoaded(path_);
+    std::shared_lock lock(storage_->mutex);
+    return storage_->sortedCount + storage_->tail.size() + storage_->pending.size();
+}
+
+std::size_t SolutionStore::tailSize() const {
+    storage_->ensureLoaded(path_);
+    std::shared_lock lock(storage_->mutex);
+    return storage_->tail.size() + storage_->pending.size();
+}
+
+}  // namespace eclipse
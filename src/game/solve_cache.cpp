@@ -0,0 +1,81 @@
+#include "game/solve_cache.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+namespace eclipse {
+
+namespace {
+constexpr std::size_t kShardCount = 64;
+
+struct StateKeyHash {
+    std::size_t operator()(const StateKey& key) const noexcept {
+        return static_cast<std::size_t>(key.lo ^ (key.hi * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+std::size_t shardOf(const StateKey& key) {
+    return static_cast<std::size_t>(key.hi % kShardCount);
+}
+}  // namespace
+
+struct SolveCache::Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<StateKey, BattleSummary, StateKeyHash> entries;
+};
+
+SolveCache::SolveCache(std::size_t capacity)
+    : capacity_(std::max(capacity, kShardCount)), shards_(std::make_unique<Shard[]>(kShardCount)) {}
+
+SolveCache::~SolveCache() = default;
+
+bool SolveCache::find(const StateKey& key, BattleSummary& result) const {
+    const Shard& shard = shards_[shardOf(key)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        return false;
+    }
+    result = it->second;
+    return true;
+}
+
+void SolveCache::insert(const StateKey& key, const BattleSummary& result) {
+    Shard& shard = shards_[shardOf(key)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.entries.size() >= capacity_ / kShardCount) {
+        entries_.fetch_sub(shard.entries.size(), std::memory_order_relaxed);
+        shard.entries.clear();
+    }
+    if (shard.entries.emplace(key, result).second) {
+        entries_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SolveCache::clear() {
+    for (std::size_t i = 0; i < kShardCount; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        entries_.fetch_sub(shards_[i].entries.size(), std::memory_order_relaxed);
+        shards_[i].entries.clear();
+    }
+}
+
+std::size_t SolveCache::size() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < kShardCount; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mutex);
+        total += shards_[i].entries.size();
+    }
+    return total;
+}
+
+std::size_t SolveCache::memoryBytes() const {
+    // A node holds the entry, its next pointer and the cached hash, and costs
+    // about one bucket pointer at the default load factor.
+    constexpr std::size_t kEntryBytes =
+        sizeof(std::pair<const StateKey, BattleSummary>) + 3 * sizeof(void*);
+    return entries_.load(std::memory_order_relaxed) * kEntryBytes;
+}
+
+}  // namespace eclipse
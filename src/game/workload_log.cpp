@@ -0,0 +1,169 @@
+#include "game/workload_log.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+
+#include "io/mapped_file.hpp"
+
+namespace eclipse {
+
+namespace {
+constexpr std::string_view kLogHeader = "eclipse-workload";
+
+std::string_view trim(std::string_view text) {
+    size_t start = text.find_first_not_of(" \r\n\t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = text.find_last_not_of(" \r\n\t");
+    return text.substr(start, end - start + 1);
+}
+
+std::string_view nextField(std::string_view& text) {
+    text = trim(text);
+    size_t end = text.find(' ');
+    std::string_view field = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view{} : text.substr(end);
+    return field;
+}
+
+constexpr std::string_view kOutcomeNames[] = {"ok", "cancelled", "error"};
+
+template <typename Number>
+Number parseNumber(std::string_view& text) {
+    std::string_view field = nextField(text);
+    Number value{};
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (field.empty() || error != std::errc() || end != field.data() + field.size()) {
+        throw std::runtime_error("bad number '" + std::string(field) + "'");
+    }
+    return value;
+}
+}  // namespace
+
+std::string formatWorkloadEntry(const WorkloadEntry& entry) {
+    char numbers[320];
+    std::snprintf(numbers, sizeof(numbers), "%s %.3f %llu %llu %llu %llu %llu %.17g %.17g %.17g %.17g | ",
+                  kOutcomeNames[static_cast<std::size_t>(entry.outcome)].data(), entry.milliseconds,
+                  static_cast<unsigned long long>(entry.stats.statesExpanded),
+                  static_cast<unsigned long long>(entry.stats.transitions),
+                  static_cast<unsigned long long>(entry.stats.memoHits),
+                  static_cast<unsigned long long>(entry.stats.sharedHits),
+                  static_cast<unsigned long long>(entry.stats.storeHits), entry.summary.humanWin,
+                  entry.summary.alienWin, entry.summary.draw, entry.summary.expectedRounds);
+    return numbers + formatMatchup(entry.matchup);
+}
+
+WorkloadEntry parseWorkloadEntry(std::string_view line, std::uint16_t version) {
+    size_t bar = line.find(" | ");
+    if (bar == std::string_view::npos) {
+        throw std::runtime_error("expected '<numbers> | <matchup>'");
+    }
+    std::string_view numbers = line.substr(0, bar);
+    WorkloadEntry entry;
+    if (version >= 2) {
+        std::string_view outcome = nextField(numbers);
+        auto name = std::find(std::begin(kOutcomeNames), std::end(kOutcomeNames), outcome);
+        if (name == std::end(kOutcomeNames)) {
+            throw std::runtime_error("bad outcome '" + std::string(outcome) + "'");
+        }
+        entry.outcome = static_cast<WorkloadOutcome>(name - std::begin(kOutcomeNames));
+    }
+    entry.milliseconds = parseNumber<double>(numbers);
+    entry.stats.statesExpanded = parseNumber<std::uint64_t>(numbers);
+    entry.stats.transitions = parseNumber<std::uint64_t>(numbers);
+    entry.stats.memoHits = parseNumber<std::uint64_t>(numbers);
+    entry.stats.sharedHits = parseNumber<std::uint64_t>(numbers);
+    entry.stats.storeHits = parseNumber<std::uint64_t>(numbers);
+    entry.summary.humanWin = parseNumber<double>(numbers);
+    entry.summary.alienWin = parseNumber<double>(numbers);
+    entry.summary.draw = parseNumber<double>(numbers);
+    entry.summary.expectedRounds = parseNumber<double>(numbers);
+    if (!trim(numbers).empty()) {
+        throw std::runtime_error("unexpected field '" + std::string(trim(numbers)) + "'");
+    }
+    entry.matchup = parseMatchup(line.substr(bar + 3));
+    return entry;
+}
+
+Workload loadWorkload(const std::string& path) {
+    MappedFile file = MappedFile::openReadOnly(path);
+    std::string_view text(reinterpret_cast<const char*>(file.bytes().data()), file.bytes().size());
+    Workload workload;
+    unsigned version = 0;
+    bool sawHeader = false;
+    int lineNumber = 0;
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        std::string_view line = trim(text.substr(0, newline));
+        text = newline == std::string_view::npos ? std::string_view{} : text.substr(newline + 1);
+        ++lineNumber;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        try {
+            if (!sawHeader) {
+                if (nextField(line) != kLogHeader) {
+                    throw std::runtime_error("not a workload log");
+                }
+                version = parseNumber<unsigned>(line);
+                if (version < 1 || version > kWorkloadLogVersion) {
+                    throw std::runtime_error("unsupported workload log version");
+                }
+                std::string_view catalog = nextField(line);
+                auto [end, error] =
+                    std::from_chars(catalog.data(), catalog.data() + catalog.size(), workload.catalog, 16);
+                if (error != std::errc() || end != catalog.data() + catalog.size()) {
+                    throw std::runtime_error("bad catalog fingerprint '" + std::string(catalog) + "'");
+                }
+                sawHeader = true;
+                continue;
+            }
+            workload.entries.push_back(parseWorkloadEntry(line, static_cast<std::uint16_t>(version)));
+        } catch (const std::runtime_error& error) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + error.what());
+        }
+    }
+    if (!sawHeader) {
+        throw std::runtime_error(path + ": not a workload log");
+    }
+    return workload;
+}
+
+WorkloadRecorder::WorkloadRecorder(const std::string& path) {
+    std::error_code error;
+    bool fresh = !std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) == 0;
+    if (!fresh) {
+        // Entries of another version cannot be appended to an existing log.
+        std::ifstream in(path);
+        std::string header;
+        std::getline(in, header);
+        std::string_view fields = header;
+        if (nextField(fields) != kLogHeader || nextField(fields) != std::to_string(kWorkloadLogVersion)) {
+            throw std::runtime_error("Workload log '" + path + "' was written by another version; record to a new file");
+        }
+    }
+    out_.open(path, std::ios::app);
+    if (!out_) {
+        throw std::runtime_error("Cannot open workload log '" + path + "'");
+    }
+    if (fresh) {
+        char header[64];
+        std::snprintf(header, sizeof(header), "%.*s %u %08x\n", static_cast<int>(kLogHeader.size()),
+                      kLogHeader.data(), static_cast<unsigned>(kWorkloadLogVersion), catalogFingerprint());
+        out_ << header << std::flush;
+    }
+}
+
+void WorkloadRecorder::record(const WorkloadEntry& entry) {
+    std::string line = formatWorkloadEntry(entry);
+    line += '\n';
+    std::lock_guard<std::mutex> lock(mutex_);
+    out_ << line << std::flush;
+}
+
+}  // namespace eclipse
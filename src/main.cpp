@@ -1,468 +1,46 @@
 #include <SDL.h>
 
-#include <algorithm>
-#include <array>
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <optional>
-#include <sstream>
-#include <string>
+#include <string_view>
 #include <utility>
-#include <vector>
 
-#include "game/battle_simulator.hpp"
+#include "game/solution_store.hpp"
 #include "game/tech_catalog.hpp"
+#include "game/workload_log.hpp"
 #include "render/bitmap_font.hpp"
+#include "ui/fleet_builder.hpp"
 
 using namespace eclipse;
 
-namespace {
-struct PaletteEntry {
-	const ModuleSpec* spec;
-	SDL_Rect rect;
-};
-
-struct FleetShip {
-	ShipLoadout loadout;
-	size_t designIndex = 0;
-	Faction faction = Faction::Human;
-	bool active = true;
-};
-
-struct SlotRect {
-	FleetShip* ship;
-	size_t slotIndex;
-	SDL_Rect rect;
-};
-
-struct ArrowRect {
-	FleetShip* ship;
-	SDL_Rect rect;
-	int delta;
-};
-
-struct ToggleRect {
-	FleetShip* ship;
-	SDL_Rect rect;
-};
-
-struct DragPayload {
-	bool active = false;
-	const ModuleSpec* spec = nullptr;
-	FleetShip* sourceShip = nullptr;
-	int sourceSlot = -1;
-	bool fromPalette = false;
-	int mouseX = 0;
-	int mouseY = 0;
-};
-
-struct ModuleCategory {
-	std::string name;
-	std::vector<const ModuleSpec*> modules;
-};
-
-struct CategoryOption {
-	size_t index;
-	SDL_Rect rect;
-	std::string label;
-};
-
-bool pointInRect(int x, int y, const SDL_Rect& rect) {
-	return x >= rect.x && x <= rect.x + rect.w && y >= rect.y && y <= rect.y + rect.h;
-}
-
-SDL_Color colorFromHex(uint32_t hex, uint8_t alpha = 255) {
-	SDL_Color c;
-	c.r = static_cast<uint8_t>((hex >> 16) & 0xFF);
-	c.g = static_cast<uint8_t>((hex >> 8) & 0xFF);
-	c.b = static_cast<uint8_t>(hex & 0xFF);
-	c.a = alpha;
-	return c;
-}
-
-const char* slotLabel(SlotType slot) {
-	switch (slot) {
-		case SlotType::Weapon: return "WEAPON";
-		case SlotType::Drive: return "DRIVE";
-		case SlotType::Computer: return "COMP";
-		case SlotType::Shield: return "SHIELD";
-		case SlotType::Power: return "POWER";
-		case SlotType::Support: return "SUP";
-	}
-	return "";
-}
-
-const char* slotCategoryLabel(SlotType slot) {
-	switch (slot) {
-		case SlotType::Weapon: return "Weapons";
-		case SlotType::Drive: return "Drives";
-		case SlotType::Computer: return "Computers";
-		case SlotType::Shield: return "Shields";
-		case SlotType::Power: return "Power";
-		case SlotType::Support: return "Support";
-	}
-	return "Modules";
-}
-
-SDL_Color slotColor(SlotType slot) {
-	switch (slot) {
-		case SlotType::Weapon: return colorFromHex(0xE07A5F);
-		case SlotType::Drive: return colorFromHex(0x3D405B);
-		case SlotType::Computer: return colorFromHex(0x81B29A);
-		case SlotType::Shield: return colorFromHex(0xF2CC8F);
-		case SlotType::Power: return colorFromHex(0x118AB2);
-		case SlotType::Support: return colorFromHex(0x6C757D);
-	}
-	return colorFromHex(0xFFFFFF);
-}
-
-void drawPanel(SDL_Renderer* renderer, const SDL_Rect& rect, SDL_Color fill, SDL_Color border) {
-	SDL_SetRenderDrawColor(renderer, fill.r, fill.g, fill.b, fill.a);
-	SDL_RenderFillRect(renderer, &rect);
-	SDL_SetRenderDrawColor(renderer, border.r, border.g, border.b, border.a);
-	SDL_RenderDrawRect(renderer, &rect);
-}
-
-SDL_Rect slotRectInCard(const SDL_Rect& cardRect, size_t slotIndex) {
-	constexpr int columns = 3;
-	constexpr int slotHeight = 60;
-	int availableWidth = cardRect.w - 40;
-	int spacing = 10;
-	int slotWidth = (availableWidth - (columns - 1) * spacing);
-	slotWidth = std::max(slotWidth / columns, 60);
-	int row = static_cast<int>(slotIndex) / columns;
-	int col = static_cast<int>(slotIndex) % columns;
-	SDL_Rect rect;
-	rect.x = cardRect.x + 20 + col * (slotWidth + spacing);
-	rect.y = cardRect.y + 90 + row * (slotHeight + spacing);
-	rect.w = slotWidth;
-	rect.h = slotHeight;
-	return rect;
-}
-
-std::pair<SDL_Rect, SDL_Rect> arrowRectsForCard(const SDL_Rect& rect) {
-	SDL_Rect left{rect.x + 10, rect.y + 10, 30, 30};
-	SDL_Rect right{rect.x + rect.w - 40, rect.y + 10, 30, 30};
-	return {left, right};
-}
-
-SDL_Rect toggleRectForCard(const SDL_Rect& rect) {
-	return SDL_Rect{rect.x + rect.w - 130, rect.y + 10, 80, 28};
-}
-
-void assignDesign(FleetShip& ship, const std::vector<const ShipDesign*>& options, size_t index) {
-	if (options.empty()) {
-		ship.loadout.setDesign(nullptr);
-		return;
-	}
-	ship.designIndex = index % options.size();
-	ship.loadout.setDesign(options[ship.designIndex]);
-}
-
-bool ensureModulePlacement(FleetShip& ship, size_t slotIndex, const ModuleSpec* spec) {
-	if (!spec) {
-		ship.loadout.clearModule(slotIndex);
-		return true;
-	}
-	ship.loadout.setModule(slotIndex, spec);
-	ShipDerivedStats stats = ship.loadout.derivedStats();
-	if (stats.energyAvailable < stats.energyUsed) {
-		ship.loadout.clearModule(slotIndex);
-		return false;
-	}
-	return true;
-}
-
-std::vector<FleetShip> createFleet(Faction faction,
-					   const std::vector<const ShipDesign*>& options) {
-	std::vector<FleetShip> fleet(3);
-	for (size_t i = 0; i < fleet.size(); ++i) {
-		fleet[i].faction = faction;
-		if (!options.empty()) {
-			assignDesign(fleet[i], options, std::min(i, options.size() - 1));
-		}
-	}
-	return fleet;
-}
-
-std::vector<ModuleCategory> buildModuleCategories(const std::vector<const ModuleSpec*>& modules) {
-	std::vector<ModuleCategory> categories;
-	constexpr int maxPerCategory = 25;
-	const std::array<SlotType, 6> order = {
-		SlotType::Weapon, SlotType::Drive, SlotType::Computer,
-		SlotType::Shield, SlotType::Power, SlotType::Support};
-	for (SlotType slot : order) {
-		std::vector<const ModuleSpec*> filtered;
-		std::copy_if(modules.begin(), modules.end(), std::back_inserter(filtered), [&](const ModuleSpec* spec) {
-			return spec->slot == slot;
-		});
-		if (filtered.empty()) {
-			continue;
-		}
-		int chunks = static_cast<int>((filtered.size() + maxPerCategory - 1) / maxPerCategory);
-		for (int chunk = 0; chunk < chunks; ++chunk) {
-			int start = chunk * maxPerCategory;
-			int end = std::min(start + maxPerCategory, static_cast<int>(filtered.size()));
-			ModuleCategory category;
-			category.name = slotCategoryLabel(slot);
-			if (chunks > 1) {
-				category.name += " " + std::to_string(chunk + 1);
+int main(int argc, char** argv) {
+	std::shared_ptr<SolutionStore> solutionStore;
+	std::unique_ptr<WorkloadRecorder> recorder;
+	for (int i = 1; i < argc; ++i) {
+		std::string_view arg = argv[i];
+		if (arg == "--catalog" && i + 1 < argc) {
+			try {
+				TechCatalog::loadFromFile(argv[++i]);
+			} catch (const std::exception& error) {
+				std::cerr << "Failed to load catalog: " << error.what() << "\n";
+				return 1;
 			}
-			category.modules.insert(category.modules.end(), filtered.begin() + start, filtered.begin() + end);
-			categories.push_back(std::move(category));
-		}
-	}
-	if (categories.empty()) {
-		ModuleCategory fallback;
-		fallback.name = "Modules";
-		fallback.modules = modules;
-		categories.push_back(std::move(fallback));
-	}
-	return categories;
-}
-
-std::vector<PaletteEntry> buildPalette(const std::vector<const ModuleSpec*>& modules,
-								   const SDL_Rect& area) {
-	std::vector<PaletteEntry> entries;
-	constexpr int columns = 5;
-	constexpr int rows = 5;
-	const int spacing = 6;
-	int tileWidth = (area.w - (columns + 1) * spacing) / columns;
-	int tileHeight = (area.h - (rows + 1) * spacing) / rows;
-	for (size_t i = 0; i < modules.size() && i < static_cast<size_t>(columns * rows); ++i) {
-		int row = static_cast<int>(i) / columns;
-		int col = static_cast<int>(i) % columns;
-		SDL_Rect rect;
-		rect.x = area.x + spacing + col * (tileWidth + spacing);
-		rect.y = area.y + spacing + row * (tileHeight + spacing);
-		rect.w = tileWidth;
-		rect.h = tileHeight;
-		entries.push_back({modules[i], rect});
-	}
-	return entries;
-}
-
-std::vector<CategoryOption> buildCategoryOptions(const SDL_Rect& dropdown,
-											   const std::vector<ModuleCategory>& categories) {
-	std::vector<CategoryOption> options;
-	int optionHeight = 26;
-	int spacing = 4;
-	for (size_t i = 0; i < categories.size(); ++i) {
-		SDL_Rect rect;
-		rect.x = dropdown.x;
-		rect.y = dropdown.y + dropdown.h + spacing + static_cast<int>(i) * (optionHeight + spacing);
-		rect.w = dropdown.w;
-		rect.h = optionHeight;
-		options.push_back({i, rect, categories[i].name});
-	}
-	return options;
-}
-
-std::vector<SDL_Rect> layoutCards(const SDL_Rect& area, size_t count) {
-	std::vector<SDL_Rect> rects;
-	if (count == 0) {
-		return rects;
-	}
-	int spacing = 10;
-	int cardWidth = (area.w - (static_cast<int>(count) + 1) * spacing) / static_cast<int>(count);
-	int cardHeight = area.h - 2 * spacing;
-	for (size_t i = 0; i < count; ++i) {
-		SDL_Rect rect;
-		rect.x = area.x + spacing + static_cast<int>(i) * (cardWidth + spacing);
-		rect.y = area.y + spacing;
-		rect.w = cardWidth;
-		rect.h = cardHeight;
-		rects.push_back(rect);
-	}
-	return rects;
-}
-
-std::vector<SlotRect> buildSlotRects(std::vector<FleetShip>& fleet,
-									 const std::vector<SDL_Rect>& cardRects) {
-	std::vector<SlotRect> slots;
-	for (size_t i = 0; i < fleet.size() && i < cardRects.size(); ++i) {
-		FleetShip& ship = fleet[i];
-		for (size_t slotIndex = 0; slotIndex < ship.loadout.slotCount(); ++slotIndex) {
-			slots.push_back({&ship, slotIndex, slotRectInCard(cardRects[i], slotIndex)});
-		}
-	}
-	return slots;
-}
-
-std::vector<ArrowRect> buildArrows(std::vector<FleetShip>& fleet,
-								   const std::vector<SDL_Rect>& cardRects) {
-	std::vector<ArrowRect> arrows;
-	for (size_t i = 0; i < fleet.size() && i < cardRects.size(); ++i) {
-		auto [left, right] = arrowRectsForCard(cardRects[i]);
-		arrows.push_back({&fleet[i], left, -1});
-		arrows.push_back({&fleet[i], right, +1});
-	}
-	return arrows;
-}
-
-std::vector<ToggleRect> buildToggles(std::vector<FleetShip>& fleet,
-						 const std::vector<SDL_Rect>& cardRects) {
-	std::vector<ToggleRect> toggles;
-	for (size_t i = 0; i < fleet.size() && i < cardRects.size(); ++i) {
-		toggles.push_back({&fleet[i], toggleRectForCard(cardRects[i])});
-	}
-	return toggles;
-}
-
-void renderPalette(SDL_Renderer* renderer, BitmapFont& font, const SDL_Rect& area,
-				   const SDL_Rect& dropdownRect, const std::string& categoryName,
-				   bool dropdownOpen, const std::vector<CategoryOption>& options,
-				   const std::vector<PaletteEntry>& entries) {
-	drawPanel(renderer, area, colorFromHex(0x1B1F3B), colorFromHex(0x394989));
-	SDL_Color dropdownFill = colorFromHex(0x23395B);
-	drawPanel(renderer, dropdownRect, dropdownFill, colorFromHex(0xF4F1DE));
-	font.drawText(renderer, categoryName, dropdownRect.x + 8, dropdownRect.y + 8,
-			  colorFromHex(0xF7FFF7), 1);
-	int arrowX = dropdownRect.x + dropdownRect.w - 20;
-	SDL_SetRenderDrawColor(renderer, 244, 241, 222, 255);
-	SDL_RenderDrawLine(renderer, arrowX - 6, dropdownRect.y + 12, arrowX, dropdownRect.y + 18);
-	SDL_RenderDrawLine(renderer, arrowX + 6, dropdownRect.y + 12, arrowX, dropdownRect.y + 18);
-
-	for (const PaletteEntry& entry : entries) {
-		SDL_Color fill = slotColor(entry.spec->slot);
-		drawPanel(renderer, entry.rect, fill, colorFromHex(0x000000));
-		font.drawText(renderer, entry.spec->shortLabel, entry.rect.x + 6, entry.rect.y + 6,
-				  colorFromHex(0x000000), 1);
-		std::string energy = "E:" + std::to_string(entry.spec->energyCost) +
-					 " P:" + std::to_string(entry.spec->energyProvided);
-		font.drawText(renderer, energy, entry.rect.x + 6, entry.rect.y + 24, colorFromHex(0x000000), 1);
-	}
-
-	if (dropdownOpen) {
-		for (const CategoryOption& option : options) {
-			SDL_Color fill = option.label == categoryName ? colorFromHex(0x2E5A88)
-											 : colorFromHex(0x1D2D50);
-			drawPanel(renderer, option.rect, fill, colorFromHex(0xF4F1DE));
-			font.drawText(renderer, option.label.c_str(), option.rect.x + 6, option.rect.y + 6,
-					  colorFromHex(0xF7FFF7), 1);
-		}
-	}
-
-	font.drawText(renderer, "Drag modules onto ships. Right click removes.",
-			  area.x + 12, area.y + area.h - 60, colorFromHex(0xF4F1DE), 1);
-}
-
-void renderArrow(SDL_Renderer* renderer, const SDL_Rect& rect, bool isRight) {
-	SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-	SDL_RenderDrawRect(renderer, &rect);
-	SDL_Point top = isRight ? SDL_Point{rect.x + 6, rect.y + 6} : SDL_Point{rect.x + rect.w - 6, rect.y + 6};
-	SDL_Point mid = isRight ? SDL_Point{rect.x + rect.w - 6, rect.y + rect.h / 2}
-							: SDL_Point{rect.x + 6, rect.y + rect.h / 2};
-	SDL_Point bottom = isRight ? SDL_Point{rect.x + 6, rect.y + rect.h - 6}
-							   : SDL_Point{rect.x + rect.w - 6, rect.y + rect.h - 6};
-	SDL_RenderDrawLine(renderer, top.x, top.y, mid.x, mid.y);
-	SDL_RenderDrawLine(renderer, mid.x, mid.y, bottom.x, bottom.y);
-}
-
-void renderShipCard(SDL_Renderer* renderer, BitmapFont& font, FleetShip& ship,
-					const SDL_Rect& rect, bool isHuman) {
-	SDL_Color fill = isHuman ? colorFromHex(0x14213D) : colorFromHex(0x2F1847);
-	SDL_Color border = isHuman ? colorFromHex(0x3A506B) : colorFromHex(0x6247AA);
-	if (!ship.active) {
-		fill = colorFromHex(0x1F1F2E);
-		border = colorFromHex(0x4A4E69);
-	}
-	drawPanel(renderer, rect, fill, border);
-
-	auto [prevRect, nextRect] = arrowRectsForCard(rect);
-	renderArrow(renderer, prevRect, false);
-	renderArrow(renderer, nextRect, true);
-
-	SDL_Rect toggleRect = toggleRectForCard(rect);
-	SDL_Color toggleFill = ship.active ? colorFromHex(0x2EC4B6) : colorFromHex(0x8D99AE);
-	drawPanel(renderer, toggleRect, toggleFill, colorFromHex(0x011627));
-	const char* toggleText = ship.active ? "ACTIVE" : "INACTIVE";
-	font.drawText(renderer, toggleText, toggleRect.x + 8, toggleRect.y + 6, colorFromHex(0x011627), 1);
-
-	std::string title = ship.loadout.design() ? ship.loadout.design()->name : "NO DESIGN";
-	font.drawText(renderer, title, rect.x + 50, rect.y + 16, colorFromHex(0xF0F4EF), 1);
-
-	ShipDerivedStats stats = ship.loadout.derivedStats();
-	std::ostringstream statLine;
-	statLine << "H" << stats.hull << " D" << stats.dice << " C" << stats.computer
-			 << " S" << stats.shield;
-	font.drawText(renderer, statLine.str(), rect.x + 20, rect.y + 52, colorFromHex(0xF4F1BB), 1);
-
-	std::string energyLine = "ENERGY " + std::to_string(stats.energyUsed) + "/" +
-							 std::to_string(stats.energyAvailable);
-	font.drawText(renderer, energyLine, rect.x + rect.w - 200, rect.y + 52, colorFromHex(0xF4F1BB), 1);
-
-	std::string error = ship.loadout.validationError();
-	if (ship.active && !error.empty()) {
-		font.drawText(renderer, error, rect.x + 20, rect.y + rect.h - 28, colorFromHex(0xEF233C), 1);
-	} else if (!ship.active) {
-		font.drawText(renderer, "Ship inactive", rect.x + 20, rect.y + rect.h - 28,
-				  colorFromHex(0xADB5BD), 1);
-	}
-
-	for (size_t slotIndex = 0; slotIndex < ship.loadout.slotCount(); ++slotIndex) {
-		SDL_Rect slotRect = slotRectInCard(rect, slotIndex);
-		const SlotBlueprint& blueprint = ship.loadout.design()->slots[slotIndex];
-		SDL_Color fillColor = slotColor(blueprint.preferredType);
-		drawPanel(renderer, slotRect, fillColor, colorFromHex(0x000000));
-		font.drawText(renderer, slotLabel(blueprint.preferredType),
-				  slotRect.x + 4, slotRect.y + 4, colorFromHex(0x000000), 1);
-		const ModuleSpec* activeModule = ship.loadout.activeModuleAt(slotIndex);
-		if (activeModule) {
-			bool isTile = ship.loadout.moduleAt(slotIndex) != nullptr;
-			SDL_Color textColor = isTile ? colorFromHex(0x000000) : colorFromHex(0x222222);
-			font.drawText(renderer, activeModule->shortLabel, slotRect.x + 4, slotRect.y + 32,
-					  textColor, 1);
-		}
-	}
-}
-
-void renderDragGhost(SDL_Renderer* renderer, BitmapFont& font, const DragPayload& drag) {
-	if (!drag.active || !drag.spec) {
-		return;
-	}
-	SDL_Rect ghost{drag.mouseX - 50, drag.mouseY - 20, 100, 40};
-	drawPanel(renderer, ghost, slotColor(drag.spec->slot), colorFromHex(0xFFFFFF));
-	font.drawText(renderer, drag.spec->shortLabel, ghost.x + 6, ghost.y + 10, colorFromHex(0x000000), 1);
-}
-
-std::vector<ShipLoadout> collectFleet(const std::vector<FleetShip>& fleet) {
-	std::vector<ShipLoadout> result;
-	result.reserve(fleet.size());
-	for (const FleetShip& ship : fleet) {
-		if (!ship.active) {
-			continue;
-		}
-		result.push_back(ship.loadout);
-	}
-	return result;
-}
-
-bool fleetReady(const std::vector<FleetShip>& fleet) {
-	bool hasActive = false;
-	for (const FleetShip& ship : fleet) {
-		if (!ship.active) {
-			continue;
-		}
-		hasActive = true;
-		if (!ship.loadout.isValid()) {
-			return false;
+		} else if (arg == "--solution-store" && i + 1 < argc) {
+			solutionStore = SolutionStore::open(argv[++i]);
+		} else if (arg == "--record" && i + 1 < argc) {
+			try {
+				recorder = std::make_unique<WorkloadRecorder>(argv[++i]);
+			} catch (const std::exception& error) {
+				std::cerr << error.what() << "\n";
+				return 1;
+			}
+		} else {
+			std::cerr << "Usage: " << argv[0] << " [--catalog <file>] [--solution-store <file>] [--record <file>]\n";
+			return 1;
 		}
 	}
-	return hasActive;
-}
-
-const std::vector<const ShipDesign*>& designOptionsFor(
-	const FleetShip& ship,
-	const std::vector<const ShipDesign*>& humanDesigns,
-	const std::vector<const ShipDesign*>& alienDesigns) {
-	return ship.faction == Faction::Human ? humanDesigns : alienDesigns;
-}
-
-}  // namespace
-
-int main(int argc, char** argv) {
-	(void)argc;
-	(void)argv;
 
 	if (SDL_Init(SDL_INIT_VIDEO) != 0) {
 		std::cerr << "Failed to init SDL: " << SDL_GetError() << "\n";
@@ -478,7 +56,11 @@ int main(int argc, char** argv) {
 		return 1;
 	}
 
-	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	// Vsync caps redraws at the display rate during drags; not every driver offers it.
+	SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+	if (!renderer) {
+		renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	}
 	if (!renderer) {
 		std::cerr << "Failed to create renderer: " << SDL_GetError() << "\n";
 		SDL_DestroyWindow(window);
@@ -486,295 +68,36 @@ int main(int argc, char** argv) {
 		return 1;
 	}
 
-	BitmapFont& font = BitmapFont::instance();
-
-	SDL_Rect paletteRect{20, 20, 320, 680};
-	SDL_Rect dropdownRect{paletteRect.x + 16, paletteRect.y + 16, paletteRect.w - 32, 34};
-	SDL_Rect paletteGridRect{paletteRect.x + 16, dropdownRect.y + dropdownRect.h + 12,
-							paletteRect.w - 32, paletteRect.h - dropdownRect.h - 120};
-	SDL_Rect humanArea{360, 20, 900, 320};
-	SDL_Rect alienArea{360, 360, 900, 320};
-	SDL_Rect simulateButton{paletteRect.x + 20, paletteRect.y + paletteRect.h - 60,
-							 paletteRect.w - 40, 40};
-
-	const auto& moduleSpecs = TechCatalog::modules();
-	std::vector<const ModuleSpec*> moduleRefs;
-	for (const ModuleSpec& spec : moduleSpecs) {
-		if (spec.blueprintOnly) {
-			continue;
-		}
-		moduleRefs.push_back(&spec);
-	}
-	std::vector<ModuleCategory> moduleCategories = buildModuleCategories(moduleRefs);
-	size_t activeCategory = 0;
-	std::vector<CategoryOption> categoryOptions = buildCategoryOptions(dropdownRect, moduleCategories);
-	std::vector<PaletteEntry> paletteEntries =
-		buildPalette(moduleCategories[activeCategory].modules, paletteGridRect);
-	auto rebuildPaletteEntries = [&]() {
-		paletteEntries = buildPalette(moduleCategories[activeCategory].modules, paletteGridRect);
-	};
-	bool dropdownOpen = false;
-
-	std::vector<const ShipDesign*> humanDesigns = TechCatalog::factionDesigns(Faction::Human);
-	std::vector<const ShipDesign*> alienDesigns = TechCatalog::factionDesigns(Faction::Orion);
-
-	std::vector<FleetShip> humanFleet = createFleet(Faction::Human, humanDesigns);
-	std::vector<FleetShip> alienFleet = createFleet(Faction::Orion, alienDesigns);
-
-	DragPayload drag;
-	std::string statusMessage;
-	Uint32 statusTimer = 0;
-	auto setStatus = [&](const std::string& msg) {
-		statusMessage = msg;
-		statusTimer = SDL_GetTicks();
-	};
-
-	BattleSimulator simulator;
-	BattleSummary summary;
-	bool summaryReady = false;
-
-	bool running = true;
-	bool simulatePressed = false;
-
-	while (running) {
-		std::vector<SDL_Rect> humanCards = layoutCards(humanArea, humanFleet.size());
-		std::vector<SDL_Rect> alienCards = layoutCards(alienArea, alienFleet.size());
-
-		std::vector<SlotRect> slotRects = buildSlotRects(humanFleet, humanCards);
-		std::vector<SlotRect> alienSlotRects = buildSlotRects(alienFleet, alienCards);
-		slotRects.insert(slotRects.end(), alienSlotRects.begin(), alienSlotRects.end());
-
-		std::vector<ArrowRect> arrows = buildArrows(humanFleet, humanCards);
-		std::vector<ArrowRect> alienArrows = buildArrows(alienFleet, alienCards);
-		arrows.insert(arrows.end(), alienArrows.begin(), alienArrows.end());
-
-		std::vector<ToggleRect> toggles = buildToggles(humanFleet, humanCards);
-		std::vector<ToggleRect> alienToggles = buildToggles(alienFleet, alienCards);
-		toggles.insert(toggles.end(), alienToggles.begin(), alienToggles.end());
-
-		auto findSlot = [&](int x, int y) -> SlotRect* {
-			for (auto& slot : slotRects) {
-				if (pointInRect(x, y, slot.rect)) {
-					return &slot;
-				}
+	FleetBuilderOptions options;
+	options.store = solutionStore;
+	options.recorder = recorder.get();
+	// Scoped so the builder (and any solve in flight) goes before the renderer.
+	{
+		FleetBuilder builder(std::move(options));
+		bool running = true;
+		while (running) {
+			// Block until something happens unless a repaint is already due; a
+			// visible status message wakes the loop when it expires.
+			SDL_Event event;
+			bool haveEvent = false;
+			if (builder.needsRedraw()) {
+				haveEvent = SDL_PollEvent(&event);
+			} else if (std::optional<Uint32> timeout = builder.millisUntilTimeout()) {
+				haveEvent = SDL_WaitEventTimeout(&event, static_cast<int>(*timeout) + 1);
+			} else {
+				haveEvent = SDL_WaitEvent(&event);
 			}
-			return nullptr;
-		};
-
-		auto paletteAt = [&](int x, int y) -> const PaletteEntry* {
-			for (const PaletteEntry& entry : paletteEntries) {
-				if (pointInRect(x, y, entry.rect)) {
-					return &entry;
-				}
-			}
-			return nullptr;
-		};
-
-		auto cycleDesign = [&](FleetShip& ship, int delta) {
-			const auto& options = designOptionsFor(ship, humanDesigns, alienDesigns);
-			if (options.empty()) {
-				return;
-			}
-			size_t newIndex = (ship.designIndex + options.size() + static_cast<size_t>(delta)) % options.size();
-			assignDesign(ship, options, newIndex);
-			summaryReady = false;
-			setStatus("Design updated.");
-		};
-
-		auto completeDrag = [&](int mx, int my) {
-			if (!drag.active || !drag.spec) {
-				drag.active = false;
-				return;
+			for (; haveEvent && running; haveEvent = SDL_PollEvent(&event)) {
+				running = builder.handleEvent(event);
 			}
-			bool placed = false;
-			for (auto& slot : slotRects) {
-				if (!slot.ship->loadout.isSlotCompatible(slot.slotIndex, *drag.spec)) {
-					continue;
-				}
-				if (pointInRect(mx, my, slot.rect)) {
-					if (ensureModulePlacement(*slot.ship, slot.slotIndex, drag.spec)) {
-						placed = true;
-						summaryReady = false;
-						setStatus("Module installed.");
-					} else {
-						setStatus("Not enough energy for module.");
-					}
-					break;
-				}
+			if (running && builder.needsRedraw()) {
+				builder.render(renderer);
+				SDL_RenderPresent(renderer);
 			}
-			if (!placed && !drag.fromPalette && drag.sourceShip && drag.sourceSlot >= 0) {
-				ensureModulePlacement(*drag.sourceShip, drag.sourceSlot, drag.spec);
-			}
-			drag.active = false;
-		};
-
-		SDL_Event event;
-		while (SDL_PollEvent(&event)) {
-			switch (event.type) {
-				case SDL_QUIT:
-					running = false;
-					break;
-				case SDL_KEYDOWN:
-					if (event.key.keysym.sym == SDLK_ESCAPE) {
-						running = false;
-					}
-					break;
-				case SDL_MOUSEBUTTONDOWN: {
-					int mx = event.button.x;
-					int my = event.button.y;
-					if (event.button.button == SDL_BUTTON_LEFT) {
-						bool handled = false;
-						if (pointInRect(mx, my, dropdownRect)) {
-							dropdownOpen = !dropdownOpen;
-							handled = true;
-						} else if (dropdownOpen) {
-							for (const CategoryOption& option : categoryOptions) {
-								if (pointInRect(mx, my, option.rect)) {
-									if (option.index < moduleCategories.size() && activeCategory != option.index) {
-										activeCategory = option.index;
-										rebuildPaletteEntries();
-										setStatus(std::string("Showing ") + moduleCategories[activeCategory].name +
-												 " modules.");
-									}
-									handled = true;
-									break;
-								}
-							}
-							dropdownOpen = false;
-							handled = true;
-						}
-
-						if (!handled) {
-							for (auto& toggle : toggles) {
-								if (pointInRect(mx, my, toggle.rect)) {
-									toggle.ship->active = !toggle.ship->active;
-									summaryReady = false;
-									setStatus(toggle.ship->active ? "Ship activated." : "Ship deactivated.");
-									handled = true;
-									break;
-								}
-							}
-						}
-
-						if (!handled) {
-							for (auto& arrow : arrows) {
-								if (pointInRect(mx, my, arrow.rect)) {
-									cycleDesign(*arrow.ship, arrow.delta);
-									handled = true;
-									break;
-								}
-							}
-						}
-						if (!handled) {
-							if (const PaletteEntry* entry = paletteAt(mx, my)) {
-								drag.active = true;
-								drag.spec = entry->spec;
-								drag.sourceShip = nullptr;
-								drag.sourceSlot = -1;
-								drag.fromPalette = true;
-								drag.mouseX = mx;
-								drag.mouseY = my;
-								handled = true;
-							}
-						}
-						if (!handled) {
-							if (SlotRect* slot = findSlot(mx, my)) {
-								if (const ModuleSpec* module = slot->ship->loadout.moduleAt(slot->slotIndex)) {
-									drag.active = true;
-									drag.spec = module;
-									drag.sourceShip = slot->ship;
-									drag.sourceSlot = static_cast<int>(slot->slotIndex);
-									drag.fromPalette = false;
-									drag.mouseX = mx;
-									drag.mouseY = my;
-									slot->ship->loadout.clearModule(slot->slotIndex);
-									handled = true;
-								}
-							}
-						}
-						if (!handled && pointInRect(mx, my, simulateButton)) {
-							simulatePressed = true;
-						}
-					} else if (event.button.button == SDL_BUTTON_RIGHT) {
-						if (SlotRect* slot = findSlot(mx, my)) {
-							slot->ship->loadout.clearModule(slot->slotIndex);
-							summaryReady = false;
-							setStatus("Module removed.");
-						}
-					}
-					break;
-				}
-				case SDL_MOUSEBUTTONUP: {
-					int mx = event.button.x;
-					int my = event.button.y;
-					if (event.button.button == SDL_BUTTON_LEFT) {
-						if (drag.active) {
-							completeDrag(mx, my);
-						} else if (simulatePressed && pointInRect(mx, my, simulateButton)) {
-							if (!fleetReady(humanFleet) || !fleetReady(alienFleet)) {
-								setStatus("Activate at least one valid ship per fleet before simulating.");
-							} else {
-								summary = simulator.simulate(collectFleet(humanFleet), collectFleet(alienFleet));
-								summaryReady = true;
-								setStatus("Simulation complete.");
-							}
-						}
-						simulatePressed = false;
-					}
-					break;
-				}
-				case SDL_MOUSEMOTION:
-					if (drag.active) {
-						drag.mouseX = event.motion.x;
-						drag.mouseY = event.motion.y;
-					}
-					break;
-				default:
-					break;
-			}
-		}
-
-		SDL_SetRenderDrawColor(renderer, 14, 20, 37, 255);
-		SDL_RenderClear(renderer);
-
-		renderPalette(renderer, font, paletteRect, dropdownRect,
-				 moduleCategories[activeCategory].name, dropdownOpen,
-				 categoryOptions, paletteEntries);
-
-		for (size_t i = 0; i < humanFleet.size() && i < humanCards.size(); ++i) {
-			renderShipCard(renderer, font, humanFleet[i], humanCards[i], true);
 		}
-		for (size_t i = 0; i < alienFleet.size() && i < alienCards.size(); ++i) {
-			renderShipCard(renderer, font, alienFleet[i], alienCards[i], false);
-		}
-
-		SDL_Color buttonColor = simulatePressed ? colorFromHex(0xFF9F1C) : colorFromHex(0x2EC4B6);
-		drawPanel(renderer, simulateButton, buttonColor, colorFromHex(0x011627));
-		font.drawText(renderer, "SIMULATE BATTLE", simulateButton.x + 20, simulateButton.y + 10,
-				  colorFromHex(0x011627), 1);
-
-		if (summaryReady) {
-			std::ostringstream lines;
-			lines.precision(1);
-			lines << std::fixed;
-			lines << "HUMAN WIN " << summary.humanWin * 100.0 << "%\n";
-			lines << "ALIEN WIN " << summary.alienWin * 100.0 << "%\n";
-			lines << "DRAW " << summary.draw * 100.0 << "%\n";
-			lines << "EXP ROUNDS " << summary.expectedRounds;
-			font.drawText(renderer, lines.str(), paletteRect.x + 10, paletteRect.y + paletteRect.h - 180,
-					  colorFromHex(0xF1FAEE), 1);
-		}
-
-		if (!statusMessage.empty() && SDL_GetTicks() - statusTimer < 4000) {
-			font.drawText(renderer, statusMessage, paletteRect.x + 10, paletteRect.y + paletteRect.h - 24,
-					  colorFromHex(0xFF5964), 1);
-		}
-
-		renderDragGhost(renderer, font, drag);
-
-		SDL_RenderPresent(renderer);
 	}
 
+	BitmapFont::instance().releaseAtlas();
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
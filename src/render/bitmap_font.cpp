@@ -12,10 +12,9 @@ BitmapFont& BitmapFont::instance() {
 
 BitmapFont::BitmapFont() {
     auto addGlyph = [this](char c, std::initializer_list<uint8_t> rows, int width) {
-        Glyph glyph;
+        Glyph& glyph = glyphs_[static_cast<unsigned char>(c)];
         glyph.width = width;
-        glyph.rows.assign(rows.begin(), rows.end());
-        glyphs_.emplace(c, std::move(glyph));
+        std::copy(rows.begin(), rows.end(), glyph.rows.begin());
     };
 
     // Uppercase characters (5x7 patterns)
@@ -61,26 +60,79 @@ BitmapFont::BitmapFont() {
     addGlyph('-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, 5);
     addGlyph(':', {0x00, 0x06, 0x06, 0x00, 0x06, 0x06, 0x00}, 5);
     addGlyph('.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x06}, 5);
+    addGlyph('%', {0x19, 0x19, 0x02, 0x04, 0x08, 0x13, 0x13}, 5);
+    addGlyph('/', {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x10}, 5);
+    addGlyph('_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}, 5);
     addGlyph(' ', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 3);
 }
 
 const BitmapFont::Glyph* BitmapFont::glyphFor(char c) const {
-    auto it = glyphs_.find(c);
-    if (it != glyphs_.end()) {
-        return &it->second;
+    unsigned char code = static_cast<unsigned char>(c);
+    if (code >= kGlyphCount || glyphs_[code].width == 0) {
+        return nullptr;
     }
-    return nullptr;
+    return &glyphs_[code];
 }
 
-void BitmapFont::drawText(SDL_Renderer* renderer, const std::string& text,
-                          int x, int y, SDL_Color color, int scale) const {
-    if (!renderer) {
-        return;
+SDL_Texture* BitmapFont::atlasFor(SDL_Renderer* renderer) const {
+    if (renderer == atlasRenderer_ && (atlas_ || atlasFailed_)) {
+        return atlas_;
+    }
+    // A different renderer owns (or owned) the old texture; it is freed with
+    // that renderer.
+    atlasRenderer_ = renderer;
+    atlas_ = nullptr;
+    atlasFailed_ = false;
+
+    const int width = kAtlasColumns * kCellSize;
+    const int height = (kGlyphCount / kAtlasColumns) * kCellSize;
+    std::vector<Uint32> pixels(static_cast<size_t>(width) * height, 0);
+    for (int row = 0; row < kCellSize; ++row) {
+        for (int col = 0; col < kCellSize; ++col) {
+            pixels[static_cast<size_t>((kSolidCell / kAtlasColumns) * kCellSize + row) * width +
+                   (kSolidCell % kAtlasColumns) * kCellSize + col] = 0xFFFFFFFFu;
+        }
+    }
+    for (int code = 0; code < kGlyphCount; ++code) {
+        const Glyph& glyph = glyphs_[code];
+        int originX = (code % kAtlasColumns) * kCellSize;
+        int originY = (code / kAtlasColumns) * kCellSize;
+        for (int row = 0; row < kGlyphRows; ++row) {
+            for (int col = 0; col < glyph.width; ++col) {
+                if (glyph.rows[row] & (1 << (glyph.width - 1 - col))) {
+                    pixels[static_cast<size_t>(originY + row) * width + originX + col] = 0xFFFFFFFFu;
+                }
+            }
+        }
     }
+
+    SDL_Texture* texture =
+        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (!texture || SDL_UpdateTexture(texture, nullptr, pixels.data(), width * 4) != 0) {
+        if (texture) {
+            SDL_DestroyTexture(texture);
+        }
+        atlasFailed_ = true;
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    atlas_ = texture;
+    return atlas_;
+}
+
+void BitmapFont::releaseAtlas() {
+    if (atlas_) {
+        SDL_DestroyTexture(atlas_);
+    }
+    atlas_ = nullptr;
+    atlasRenderer_ = nullptr;
+    atlasFailed_ = false;
+}
+
+void BitmapFont::layoutQuads(std::string_view text, int x, int y, int scale) const {
+    quads_.clear();
     int cursorX = x;
     int cursorY = y;
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-
     for (char c : text) {
         if (c == '\n') {
             cursorY += lineHeight(scale);
@@ -95,21 +147,56 @@ void BitmapFont::drawText(SDL_Renderer* renderer, const std::string& text,
             cursorX += scale * 4;
             continue;
         }
-        for (size_t row = 0; row < glyph->rows.size(); ++row) {
-            uint8_t bits = glyph->rows[row];
-            for (int col = 0; col < glyph->width; ++col) {
-                int bitIndex = glyph->width - 1 - col;
-                if (bits & (1 << bitIndex)) {
-                    SDL_Rect pixel{cursorX + col * scale, cursorY + static_cast<int>(row) * scale, scale, scale};
-                    SDL_RenderFillRect(renderer, &pixel);
+        int code = static_cast<unsigned char>(c);
+        if (c != ' ') {  // blank cell, nothing to draw
+            quads_.push_back({{(code % kAtlasColumns) * kCellSize, (code / kAtlasColumns) * kCellSize, glyph->width,
+                               kGlyphRows},
+                              {cursorX, cursorY, glyph->width * scale, kGlyphRows * scale}});
+        }
+        cursorX += (glyph->width + 1) * scale;
+    }
+}
+
+void BitmapFont::drawText(SDL_Renderer* renderer, std::string_view text,
+                          int x, int y, SDL_Color color, int scale) const {
+    if (!renderer) {
+        return;
+    }
+    immediate_.begin(renderer);
+    drawText(immediate_, text, x, y, color, scale);
+    immediate_.flush();
+}
+
+void BitmapFont::drawText(RenderBatch& batch, std::string_view text,
+                          int x, int y, SDL_Color color, int scale) const {
+    SDL_Texture* atlas = batch.renderer() ? atlasFor(batch.renderer()) : nullptr;
+    layoutQuads(text, x, y, scale);
+    for (const Quad& quad : quads_) {
+        if (atlas) {
+            batch.copy(atlas, quad.source, quad.target, color);
+            continue;
+        }
+        const Glyph& glyph = glyphs_[(quad.source.y / kCellSize) * kAtlasColumns + quad.source.x / kCellSize];
+        for (int row = 0; row < kGlyphRows; ++row) {
+            for (int col = 0; col < glyph.width; ++col) {
+                if (glyph.rows[row] & (1 << (glyph.width - 1 - col))) {
+                    batch.fillRect({quad.target.x + col * scale, quad.target.y + row * scale, scale, scale}, color);
                 }
             }
         }
-        cursorX += (glyph->width + 1) * scale;
     }
 }
 
-int BitmapFont::measureTextWidth(const std::string& text, int scale) const {
+void BitmapFont::shareAtlas(RenderBatch& batch) const {
+    if (SDL_Texture* atlas = batch.renderer() ? atlasFor(batch.renderer()) : nullptr) {
+        batch.setSolidSource(atlas, {(static_cast<float>((kSolidCell % kAtlasColumns) * kCellSize) + 0.5f * kCellSize) /
+                                         static_cast<float>(kAtlasColumns * kCellSize),
+                                     (static_cast<float>((kSolidCell / kAtlasColumns) * kCellSize) + 0.5f * kCellSize) /
+                                         static_cast<float>((kGlyphCount / kAtlasColumns) * kCellSize)});
+    }
+}
+
+int BitmapFont::measureTextWidth(std::string_view text, int scale) const {
     int width = 0;
     for (char c : text) {
         if (c == '\n') {
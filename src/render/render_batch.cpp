@@ -0,0 +1,166 @@
+#include "render/render_batch.hpp"
+
+#include <cmath>
+
+namespace eclipse {
+
+void RenderBatch::begin(SDL_Renderer* renderer) {
+    renderer_ = renderer;
+    solidTexture_ = nullptr;
+    primitives_.clear();
+}
+
+void RenderBatch::setSolidSource(SDL_Texture* texture, SDL_FPoint texel) {
+    solidTexture_ = texture;
+    solidTexel_ = texel;
+}
+
+void RenderBatch::fillRect(const SDL_Rect& rect, SDL_Color color) {
+    if (rect.w > 0 && rect.h > 0) {
+        primitives_.push_back({Kind::Fill, nullptr, {}, rect, color});
+    }
+}
+
+void RenderBatch::drawRect(const SDL_Rect& rect, SDL_Color color) {
+    if (rect.w <= 0 || rect.h <= 0) {
+        return;
+    }
+    fillRect({rect.x, rect.y, rect.w, 1}, color);
+    if (rect.h > 1) {
+        fillRect({rect.x, rect.y + rect.h - 1, rect.w, 1}, color);
+    }
+    fillRect({rect.x, rect.y + 1, 1, rect.h - 2}, color);
+    if (rect.w > 1) {
+        fillRect({rect.x + rect.w - 1, rect.y + 1, 1, rect.h - 2}, color);
+    }
+}
+
+void RenderBatch::drawLine(SDL_Point from, SDL_Point to, SDL_Color color) {
+    primitives_.push_back({Kind::Line, nullptr, {}, {from.x, from.y, to.x, to.y}, color});
+}
+
+void RenderBatch::copy(SDL_Texture* texture, const SDL_Rect& source, const SDL_Rect& target, SDL_Color color) {
+    primitives_.push_back({Kind::Copy, texture, source, target, color});
+}
+
+void RenderBatch::appendQuad(const SDL_FPoint (&corners)[4], const SDL_FPoint (&texels)[4], SDL_Color color) {
+    int base = static_cast<int>(vertices_.size());
+    for (int corner = 0; corner < 4; ++corner) {
+        vertices_.push_back({corners[corner], color, texels[corner]});
+    }
+    for (int corner : {0, 1, 2, 0, 2, 3}) {
+        indices_.push_back(base + corner);
+    }
+}
+
+void RenderBatch::appendPrimitive(const Primitive& primitive) {
+    SDL_FPoint solid[4] = {solidTexel_, solidTexel_, solidTexel_, solidTexel_};
+    switch (primitive.kind) {
+        case Kind::Fill: {
+            auto left = static_cast<float>(primitive.target.x);
+            auto top = static_cast<float>(primitive.target.y);
+            auto right = left + static_cast<float>(primitive.target.w);
+            auto bottom = top + static_cast<float>(primitive.target.h);
+            appendQuad({{left, top}, {right, top}, {right, bottom}, {left, bottom}}, solid, primitive.color);
+            break;
+        }
+        case Kind::Line: {
+            // A one-pixel-wide quad through the pixel centres, extended half a
+            // pixel past each end so both endpoints are covered as with
+            // SDL_RenderDrawLine.
+            float x0 = static_cast<float>(primitive.target.x) + 0.5f;
+            float y0 = static_cast<float>(primitive.target.y) + 0.5f;
+            float x1 = static_cast<float>(primitive.target.w) + 0.5f;
+            float y1 = static_cast<float>(primitive.target.h) + 0.5f;
+            float length = std::hypot(x1 - x0, y1 - y0);
+            float dx = length > 0.0f ? (x1 - x0) / length * 0.5f : 0.5f;
+            float dy = length > 0.0f ? (y1 - y0) / length * 0.5f : 0.0f;
+            appendQuad({{x0 - dx + dy, y0 - dy - dx},
+                        {x1 + dx + dy, y1 + dy - dx},
+                        {x1 + dx - dy, y1 + dy + dx},
+                        {x0 - dx - dy, y0 - dy + dx}},
+                       solid, primitive.color);
+            break;
+        }
+        case Kind::Copy: {
+            int width = 0;
+            int height = 0;
+            SDL_QueryTexture(primitive.texture, nullptr, nullptr, &width, &height);
+            float scaleU = width > 0 ? 1.0f / static_cast<float>(width) : 0.0f;
+            float scaleV = height > 0 ? 1.0f / static_cast<float>(height) : 0.0f;
+            float u0 = static_cast<float>(primitive.source.x) * scaleU;
+            float v0 = static_cast<float>(primitive.source.y) * scaleV;
+            float u1 = static_cast<float>(primitive.source.x + primitive.source.w) * scaleU;
+            float v1 = static_cast<float>(primitive.source.y + primitive.source.h) * scaleV;
+            auto left = static_cast<float>(primitive.target.x);
+            auto top = static_cast<float>(primitive.target.y);
+            auto right = left + static_cast<float>(primitive.target.w);
+            auto bottom = top + static_cast<float>(primitive.target.h);
+            appendQuad({{left, top}, {right, top}, {right, bottom}, {left, bottom}},
+                       {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}}, primitive.color);
+            break;
+        }
+    }
+}
+
+void RenderBatch::replay(const Primitive& primitive) {
+    const SDL_Color& color = primitive.color;
+    switch (primitive.kind) {
+        case Kind::Fill:
+            SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRect(renderer_, &primitive.target);
+            break;
+        case Kind::Line:
+            SDL_SetRenderDrawColor(renderer_, color.r, color.g, color.b, color.a);
+            SDL_RenderDrawLine(renderer_, primitive.target.x, primitive.target.y, primitive.target.w,
+                               primitive.target.h);
+            break;
+        case Kind::Copy:
+            SDL_SetTextureColorMod(primitive.texture, color.r, color.g, color.b);
+            SDL_SetTextureAlphaMod(primitive.texture, color.a);
+            SDL_RenderCopy(renderer_, primitive.texture, &primitive.source, &primitive.target);
+            break;
+    }
+    ++drawCalls_;
+}
+
+void RenderBatch::flush() {
+    drawCalls_ = 0;
+    if (!renderer_) {
+        primitives_.clear();
+        return;
+    }
+    bool geometry = true;
+    size_t start = 0;
+    while (start < primitives_.size()) {
+        SDL_Texture* texture = primitives_[start].texture ? primitives_[start].texture : solidTexture_;
+        size_t end = start;
+        vertices_.clear();
+        indices_.clear();
+        for (; end < primitives_.size(); ++end) {
+            SDL_Texture* next = primitives_[end].texture ? primitives_[end].texture : solidTexture_;
+            if (next != texture) {
+                break;
+            }
+            if (geometry) {
+                appendPrimitive(primitives_[end]);
+            }
+        }
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        if (geometry && SDL_RenderGeometry(renderer_, texture, vertices_.data(), static_cast<int>(vertices_.size()),
+                                           indices_.data(), static_cast<int>(indices_.size())) == 0) {
+            ++drawCalls_;
+            start = end;
+            continue;
+        }
+#endif
+        geometry = false;
+        for (size_t i = start; i < end; ++i) {
+            replay(primitives_[i]);
+        }
+        start = end;
+    }
+    primitives_.clear();
+}
+
+}  // namespace eclipse
@@ -0,0 +1,93 @@
+#include "server/protocol.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#include "game/fleet_codec.hpp"
+
+namespace eclipse::protocol {
+
+namespace {
+std::string_view nextToken(std::string_view& text) {
+    size_t start = text.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        text = {};
+        return {};
+    }
+    size_t end = text.find(' ', start);
+    std::string_view token = text.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+    text = end == std::string_view::npos ? std::string_view{} : text.substr(end);
+    return token;
+}
+
+std::string_view trim(std::string_view text) {
+    size_t start = text.find_first_not_of(" \r\n\t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = text.find_last_not_of(" \r\n\t");
+    return text.substr(start, end - start + 1);
+}
+
+std::runtime_error protocolError(std::string_view what, std::string_view token) {
+    return std::runtime_error(std::string(what) + " '" + std::string(token) + "'");
+}
+}  // namespace
+
+void parseRequest(std::string_view line, Request& request) {
+    line = trim(line);
+    request.id = std::string(nextToken(line));
+    if (request.id.empty()) {
+        throw std::runtime_error("empty request");
+    }
+    std::string_view verb = nextToken(line);
+    if (verb == "stats") {
+        request.verb = Verb::Stats;
+        return;
+    }
+    if (verb != "solve") {
+        throw protocolError("unknown verb", verb);
+    }
+    request.verb = Verb::Solve;
+    std::string_view deadline = nextToken(line);
+    auto [end, error] = std::from_chars(deadline.data(), deadline.data() + deadline.size(), request.deadlineMs);
+    if (error != std::errc() || end != deadline.data() + deadline.size()) {
+        throw protocolError("bad deadline", deadline);
+    }
+    Matchup matchup = parseMatchup(line);
+    request.humans = std::move(matchup.humans);
+    request.aliens = std::move(matchup.aliens);
+}
+
+std::string formatSolveRequest(std::string_view id, std::uint32_t deadlineMs,
+                               const std::vector<ShipLoadout>& humans,
+                               const std::vector<ShipLoadout>& aliens) {
+    std::string line(id);
+    line += " solve ";
+    line += std::to_string(deadlineMs);
+    line += ' ';
+    line += formatFleet(humans);
+    line += " vs ";
+    line += formatFleet(aliens);
+    line += '\n';
+    return line;
+}
+
+std::string formatResult(std::string_view id, const BattleSummary& summary) {
+    char numbers[128];
+    std::snprintf(numbers, sizeof(numbers), " ok %.9f %.9f %.9f %.6f\n", summary.humanWin, summary.alienWin,
+                  summary.draw, summary.expectedRounds);
+    return std::string(id) + numbers;
+}
+
+std::string formatTimeout(std::string_view id) {
+    return std::string(id) + " timeout\n";
+}
+
+std::string formatError(std::string_view id, std::string_view message) {
+    return std::string(id.empty() ? std::string_view("-") : id) + " error " + std::string(message) + "\n";
+}
+
+}  // namespace eclipse::protocol
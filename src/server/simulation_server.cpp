@@ -0,0 +1,551 @@
+#include "server/simulation_server.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/solution_store.hpp"
+#include "game/solve_cache.hpp"
+#include "server/protocol.hpp"
+#include "util/thread_pool.hpp"
+
+namespace eclipse {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct StateKeyHash {
+    std::size_t operator()(const StateKey& key) const noexcept {
+        return static_cast<std::size_t>(key.lo ^ (key.hi * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+std::runtime_error socketError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+void setNonBlocking(int fd) {
+    int flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+struct InFlight;
+struct Waiter;
+
+struct Connection {
+    int fd = -1;
+    // I/O thread only. After the client half-closes, inputDone stops reads but
+    // the connection stays open until every waiter is answered and flushed.
+    std::string input;
+    bool inputDone = false;
+    std::vector<std::weak_ptr<Waiter>> waiters;
+
+    std::mutex mutex;
+    std::string output;
+    std::size_t pending = 0;  // waiters not yet answered
+    bool closed = false;
+};
+
+struct Waiter {
+    std::shared_ptr<Connection> connection;
+    std::string id;
+    Clock::time_point deadline;
+    std::weak_ptr<InFlight> flight;
+    std::atomic<bool> answered{false};
+};
+
+struct InFlight {
+    StateKey key;
+    std::vector<std::shared_ptr<Waiter>> waiters;  // guarded by Impl::flightMutex
+    std::size_t live = 0;                          // waiters not yet answered
+    std::stop_source stop;
+};
+
+struct DeadlineOrder {
+    bool operator()(const std::shared_ptr<Waiter>& a, const std::shared_ptr<Waiter>& b) const {
+        return a->deadline > b->deadline;
+    }
+};
+}  // namespace
+
+struct SimulationServer::Impl {
+    ServerOptions options;
+    std::shared_ptr<SolveCache> cache;
+    ThreadPool pool;
+
+    int unixListener = -1;
+    int tcpListener = -1;
+    int boundTcpPort = 0;
+    int wakeRead = -1;
+    int wakeWrite = -1;
+    std::atomic<bool> stopping{false};
+
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::priority_queue<std::shared_ptr<Waiter>, std::vector<std::shared_ptr<Waiter>>, DeadlineOrder> deadlines;
+
+    std::mutex flightMutex;
+    std::unordered_map<StateKey, std::shared_ptr<InFlight>, StateKeyHash> inFlight;
+
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> cacheHits{0};
+    std::atomic<std::uint64_t> coalesced{0};
+    std::atomic<std::uint64_t> solved{0};
+    std::atomic<std::uint64_t> timeouts{0};
+    std::atomic<std::uint64_t> cancelled{0};
+    std::atomic<std::uint64_t> errors{0};
+
+    explicit Impl(ServerOptions serverOptions)
+        : options(std::move(serverOptions)),
+          cache(std::make_shared<SolveCache>(options.cacheCapacity)),
+          pool(options.threads ? options.threads : std::thread::hardware_concurrency()) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            throw socketError("pipe");
+        }
+        wakeRead = fds[0];
+        wakeWrite = fds[1];
+        setNonBlocking(wakeRead);
+        setNonBlocking(wakeWrite);
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(flightMutex);
+            for (auto& entry : inFlight) {
+                entry.second->stop.request_stop();
+            }
+        }
+        pool.wait();
+        for (const auto& connection : connections) {
+            ::close(connection->fd);
+        }
+        for (int fd : {unixListener, tcpListener, wakeRead, wakeWrite}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        if (unixListener >= 0) {
+            ::unlink(options.unixPath.c_str());
+        }
+    }
+
+    void wake() {
+        char byte = 1;
+        [[maybe_unused]] auto written = ::write(wakeWrite, &byte, 1);
+    }
+
+    void reply(const std::shared_ptr<Connection>& connection, const std::string& line, bool waited = false) {
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            if (waited) {
+                connection->pending -= 1;
+            }
+            if (connection->closed) {
+                return;
+            }
+            connection->output += line;
+        }
+        wake();
+    }
+
+    // Drops a waiter from its solve. Once nobody is waiting the solve is
+    // stopped, and a later request for the same matchup starts afresh.
+    void release(const std::shared_ptr<Waiter>& waiter) {
+        auto flight = waiter->flight.lock();
+        if (!flight) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(flightMutex);
+        if (--flight->live == 0) {
+            flight->stop.request_stop();
+            auto it = inFlight.find(flight->key);
+            if (it != inFlight.end() && it->second == flight) {
+                inFlight.erase(it);
+            }
+        }
+    }
+
+    // The client is gone: nobody will read the replies its waiters are owed.
+    void abandon(Connection& connection) {
+        for (const auto& weak : connection.waiters) {
+            auto waiter = weak.lock();
+            if (waiter && !waiter->answered.exchange(true)) {
+                release(waiter);
+            }
+        }
+        connection.waiters.clear();
+    }
+
+    void listen() {
+        if (unixListener >= 0 || tcpListener >= 0) {
+            return;
+        }
+        if (!options.unixPath.empty()) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (options.unixPath.size() >= sizeof(address.sun_path)) {
+                throw std::runtime_error("socket path too long: " + options.unixPath);
+            }
+            std::strcpy(address.sun_path, options.unixPath.c_str());
+            unixListener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            ::unlink(options.unixPath.c_str());
+            if (unixListener < 0 || ::bind(unixListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                ::listen(unixListener, SOMAXCONN) != 0) {
+                throw socketError("cannot listen on " + options.unixPath);
+            }
+            setNonBlocking(unixListener);
+        }
+        if (options.tcpPort > 0) {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<std::uint16_t>(options.tcpPort));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            tcpListener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int reuse = 1;
+            ::setsockopt(tcpListener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (tcpListener < 0 || ::bind(tcpListener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                ::listen(tcpListener, SOMAXCONN) != 0) {
+                throw socketError("cannot listen on 127.0.0.1:" + std::to_string(options.tcpPort));
+            }
+            socklen_t length = sizeof(address);
+            ::getsockname(tcpListener, reinterpret_cast<sockaddr*>(&address), &length);
+            boundTcpPort = ntohs(address.sin_port);
+            setNonBlocking(tcpListener);
+        }
+        if (unixListener < 0 && tcpListener < 0) {
+            throw std::runtime_error("no listener configured");
+        }
+    }
+
+    void accept(int listener) {
+        for (;;) {
+            int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            auto connection = std::make_shared<Connection>();
+            connection->fd = fd;
+            connections.push_back(std::move(connection));
+        }
+    }
+
+    std::string statsLine(const std::string& id) const {
+        ServerStats current = snapshot();
+        return id + " stats requests=" + std::to_string(current.requests) +
+               " cache_hits=" + std::to_string(current.cacheHits) +
+               " coalesced=" + std::to_string(current.coalesced) + " solved=" + std::to_string(current.solved) +
+               " timeouts=" + std::to_string(current.timeouts) +
+               " cancelled=" + std::to_string(current.cancelled) + " errors=" + std::to_string(current.errors) +
+               " cache_entries=" + std::to_string(current.cacheEntries) + "\n";
+    }
+
+    ServerStats snapshot() const {
+        ServerStats current;
+        current.requests = requests.load();
+        current.cacheHits = cacheHits.load();
+        current.coalesced = coalesced.load();
+        current.solved = solved.load();
+        current.timeouts = timeouts.load();
+        current.cancelled = cancelled.load();
+        current.errors = errors.load();
+        current.cacheEntries = cache->size();
+        return current;
+    }
+
+    void handleLine(const std::shared_ptr<Connection>& connection, std::string_view line) {
+        requests.fetch_add(1, std::memory_order_relaxed);
+        protocol::Request request;
+        try {
+            protocol::parseRequest(line, request);
+        } catch (const std::exception& error) {
+            errors.fetch_add(1, std::memory_order_relaxed);
+            reply(connection, protocol::formatError(request.id, error.what()));
+            return;
+        }
+        if (request.verb == protocol::Verb::Stats) {
+            reply(connection, statsLine(request.id));
+            return;
+        }
+
+        StateKey key = BattleSimulator::matchupKey(request.humans, request.aliens);
+        BattleSummary known;
+        if (cache->find(key, known) || (options.store && options.store->find(key, known))) {
+            cacheHits.fetch_add(1, std::memory_order_relaxed);
+            reply(connection, protocol::formatResult(request.id, known));
+            return;
+        }
+
+        auto waiter = std::make_shared<Waiter>();
+        {
+            std::lock_guard<std::mutex> lock(connection->mutex);
+            connection->pending += 1;
+        }
+        std::erase_if(connection->waiters, [](const std::weak_ptr<Waiter>& weak) {
+            auto waiter = weak.lock();
+            return !waiter || waiter->answered.load();
+        });
+        connection->waiters.push_back(waiter);
+        waiter->connection = connection;
+        waiter->id = request.id;
+        auto budget = request.deadlineMs ? std::chrono::milliseconds(request.deadlineMs) : options.defaultDeadline;
+        waiter->deadline = Clock::now() + budget;
+
+        std::shared_ptr<InFlight> flight;
+        bool start = false;
+        {
+            std::lock_guard<std::mutex> lock(flightMutex);
+            auto& slot = inFlight[key];
+            if (slot) {
+                coalesced.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                slot = std::make_shared<InFlight>();
+                slot->key = key;
+                start = true;
+            }
+            flight = slot;
+            flight->waiters.push_back(waiter);
+            flight->live += 1;
+            waiter->flight = flight;
+        }
+        deadlines.push(waiter);
+        if (start) {
+            pool.submit([this, flight, humans = std::move(request.humans), aliens = std::move(request.aliens)] {
+                solve(flight, humans, aliens);
+            });
+        }
+    }
+
+    void solve(const std::shared_ptr<InFlight>& flight, const std::vector<ShipLoadout>& humans,
+               const std::vector<ShipLoadout>& aliens) {
+        std::optional<BattleSummary> result;
+        std::string failure;
+        if (flight->stop.stop_requested()) {
+            cancelled.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            BattleSimulator simulator(options.store);
+            simulator.setSharedCache(cache);
+            try {
+                result = simulator.simulate(humans, aliens, flight->stop.get_token());
+                // Terminal matchups (a side with no valid ship) never reach the
+                // solver's memo, so record the top level explicitly.
+                cache->insert(flight->key, *result);
+                solved.fetch_add(1, std::memory_order_relaxed);
+            } catch (const SimulationCancelled&) {
+                cancelled.fetch_add(1, std::memory_order_relaxed);
+            } catch (const std::exception& error) {
+                errors.fetch_add(1, std::memory_order_relaxed);
+                failure = error.what();
+            }
+        }
+        std::vector<std::shared_ptr<Waiter>> waiters;
+        {
+            std::lock_guard<std::mutex> lock(flightMutex);
+            auto it = inFlight.find(flight->key);
+            if (it != inFlight.end() && it->second == flight) {
+                inFlight.erase(it);
+            }
+            waiters.swap(flight->waiters);
+        }
+        for (const auto& waiter : waiters) {
+            if (waiter->answered.exchange(true)) {
+                continue;
+            }
+            if (result) {
+                reply(waiter->connection, protocol::formatResult(waiter->id, *result), true);
+            } else if (!failure.empty()) {
+                reply(waiter->connection, protocol::formatError(waiter->id, failure), true);
+            } else {
+                reply(waiter->connection, protocol::formatTimeout(waiter->id), true);
+            }
+        }
+    }
+
+    void expire(const std::shared_ptr<Waiter>& waiter) {
+        if (waiter->answered.exchange(true)) {
+            return;
+        }
+        timeouts.fetch_add(1, std::memory_order_relaxed);
+        reply(waiter->connection, protocol::formatTimeout(waiter->id), true);
+        release(waiter);
+    }
+
+    int pollTimeout() {
+        while (!deadlines.empty() && deadlines.top()->answered.load()) {
+            deadlines.pop();
+        }
+        if (deadlines.empty()) {
+            return -1;
+        }
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadlines.top()->deadline - Clock::now());
+        return static_cast<int>(std::max<std::int64_t>(0, remaining.count()));
+    }
+
+    void readFrom(const std::shared_ptr<Connection>& connection) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t count = ::recv(connection->fd, buffer, sizeof(buffer), 0);
+            if (count > 0) {
+                connection->input.append(buffer, static_cast<size_t>(count));
+                continue;
+            }
+            if (count == 0) {
+                // Half-closed (shutdown(SHUT_WR), nc -N): the requests are in,
+                // but the replies still have to go out.
+                connection->inputDone = true;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                connection->closed = true;
+            }
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        size_t start = 0;
+        for (size_t end = connection->input.find('\n'); end != std::string::npos;
+             end = connection->input.find('\n', start)) {
+            std::string_view line(connection->input.data() + start, end - start);
+            if (!line.empty() && line != "\r") {
+                handleLine(connection, line);
+            }
+            start = end + 1;
+        }
+        connection->input.erase(0, start);
+        if (connection->inputDone && !connection->input.empty()) {
+            // A last request without its newline.
+            std::string line = std::move(connection->input);
+            connection->input.clear();
+            if (line != "\r") {
+                handleLine(connection, line);
+            }
+        }
+    }
+
+    bool writeTo(const std::shared_ptr<Connection>& connection) {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        while (!connection->output.empty() && !connection->closed) {
+            ssize_t count = ::send(connection->fd, connection->output.data(), connection->output.size(), MSG_NOSIGNAL);
+            if (count > 0) {
+                connection->output.erase(0, static_cast<size_t>(count));
+            } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            } else {
+                connection->closed = true;
+            }
+        }
+        return !connection->output.empty() && !connection->closed;
+    }
+
+    void run() {
+        listen();
+        std::vector<pollfd> fds;
+        std::vector<bool> wantsWrite;
+        while (!stopping.load()) {
+            fds.clear();
+            fds.push_back({wakeRead, POLLIN, 0});
+            for (int listener : {unixListener, tcpListener}) {
+                fds.push_back({listener, static_cast<short>(listener >= 0 ? POLLIN : 0), 0});
+            }
+            for (const auto& connection : connections) {
+                short events = connection->inputDone ? 0 : POLLIN;
+                {
+                    std::lock_guard<std::mutex> lock(connection->mutex);
+                    if (!connection->output.empty()) {
+                        events |= POLLOUT;
+                    }
+                }
+                fds.push_back({connection->fd, events, 0});
+            }
+            if (::poll(fds.data(), fds.size(), pollTimeout()) < 0 && errno != EINTR) {
+                throw socketError("poll");
+            }
+            char drain[256];
+            while (::read(wakeRead, drain, sizeof(drain)) > 0) {
+            }
+            // Snapshot before accepting so indices line up with fds.
+            std::vector<std::shared_ptr<Connection>> polled = connections;
+            for (size_t i = 0; i < 2; ++i) {
+                if (fds[1 + i].revents & POLLIN) {
+                    accept(fds[1 + i].fd);
+                }
+            }
+            for (size_t i = 0; i < polled.size(); ++i) {
+                short revents = fds[3 + i].revents;
+                if (!polled[i]->inputDone && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                    readFrom(polled[i]);
+                } else if (polled[i]->inputDone && (revents & (POLLHUP | POLLERR))) {
+                    // Both directions are gone, so the pending replies cannot be delivered.
+                    std::lock_guard<std::mutex> lock(polled[i]->mutex);
+                    polled[i]->closed = true;
+                }
+            }
+            auto now = Clock::now();
+            while (!deadlines.empty() && deadlines.top()->deadline <= now) {
+                auto waiter = deadlines.top();
+                deadlines.pop();
+                expire(waiter);
+            }
+            for (const auto& connection : connections) {
+                writeTo(connection);
+            }
+            std::erase_if(connections, [this](const std::shared_ptr<Connection>& connection) {
+                bool done = false;
+                {
+                    std::lock_guard<std::mutex> lock(connection->mutex);
+                    done = connection->closed ||
+                           (connection->inputDone && connection->pending == 0 && connection->output.empty());
+                }
+                if (done) {
+                    abandon(*connection);
+                    ::close(connection->fd);
+                }
+                return done;
+            });
+        }
+    }
+};
+
+SimulationServer::SimulationServer(ServerOptions options) : impl_(std::make_unique<Impl>(std::move(options))) {}
+
+SimulationServer::~SimulationServer() = default;
+
+void SimulationServer::listen() {
+    impl_->listen();
+}
+
+void SimulationServer::run() {
+    impl_->run();
+}
+
+void SimulationServer::stop() {
+    impl_->stopping.store(true);
+    impl_->wake();
+}
+
+ServerStats SimulationServer::stats() const {
+    return impl_->snapshot();
+}
+
+int SimulationServer::tcpPort() const {
+    return impl_->boundTcpPort;
+}
+
+}  // namespace eclipse
@@ -0,0 +1,1518 @@
+#include "ui/fleet_builder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/fleet_codec.hpp"
+#include "game/matchup_matrix.hpp"
+#include "game/slot_sensitivity.hpp"
+#include "game/solution_store.hpp"
+#include "game/solve_cache.hpp"
+#include "game/tech_catalog.hpp"
+#include "game/workload_log.hpp"
+#include "render/bitmap_font.hpp"
+#include "render/render_batch.hpp"
+
+namespace eclipse {
+
+namespace {
+struct PaletteEntry {
+    const ModuleSpec* spec;
+    SDL_Rect rect;
+};
+
+struct FleetShip {
+    ShipLoadout loadout;
+    size_t designIndex = 0;
+    Faction faction = Faction::Human;
+    bool active = true;
+};
+
+struct SlotRect {
+    FleetShip* ship;
+    size_t slotIndex;
+    SDL_Rect rect;
+};
+
+struct ArrowRect {
+    FleetShip* ship;
+    SDL_Rect rect;
+    int delta;
+};
+
+struct ToggleRect {
+    FleetShip* ship;
+    SDL_Rect rect;
+};
+
+struct DragPayload {
+    bool active = false;
+    const ModuleSpec* spec = nullptr;
+    FleetShip* sourceShip = nullptr;
+    int sourceSlot = -1;
+    bool fromPalette = false;
+    int mouseX = 0;
+    int mouseY = 0;
+};
+
+struct ModuleCategory {
+    std::string name;
+    std::vector<const ModuleSpec*> modules;
+};
+
+struct CategoryOption {
+    size_t index;
+    SDL_Rect rect;
+    std::string label;
+};
+
+// How long a status message stays on screen.
+constexpr Uint32 kStatusMillis = 4000;
+// How often the performance overlay repaints while a solve is running.
+constexpr Uint32 kHudRefreshMillis = 250;
+
+// The last render() times, for the overlay's percentiles.
+struct FrameTimes {
+    std::array<double, 120> millis{};
+    size_t count = 0;
+
+    void add(double value) { millis[count++ % millis.size()] = value; }
+
+    double percentile(double p) const {
+        size_t size = std::min(count, millis.size());
+        if (size == 0) {
+            return 0.0;
+        }
+        std::array<double, 120> sorted = millis;
+        auto rank = static_cast<size_t>(p * static_cast<double>(size - 1) + 0.5);
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank),
+                         sorted.begin() + static_cast<std::ptrdiff_t>(size));
+        return sorted[rank];
+    }
+};
+
+// Handed from the background solve to the UI thread through an SDL user event.
+struct SimulationResult {
+    int job = 0;
+    Matchup matchup;
+    BattleSummary summary;
+    SolveStats stats;
+    double milliseconds = 0.0;
+    std::string error;
+    bool cancelled = false;
+};
+
+// One solved cell of the matchup matrix, handed over like SimulationResult.
+struct MatrixResult {
+    int job = 0;
+    MatrixCell cell;
+};
+
+// Module ranking from slotSensitivity(), handed over the same way.
+struct SensitivityResult {
+    int job = 0;
+    SensitivityReport report;
+    std::string error;
+    bool cancelled = false;
+};
+
+using ModuleValues = std::unordered_map<const ModuleSpec*, double>;
+
+SDL_Point rectCenter(const SDL_Rect& rect) {
+    return SDL_Point{rect.x + rect.w / 2, rect.y + rect.h / 2};
+}
+
+bool pointInRect(int x, int y, const SDL_Rect& rect) {
+    return x >= rect.x && x <= rect.x + rect.w && y >= rect.y && y <= rect.y + rect.h;
+}
+
+SDL_Color colorFromHex(uint32_t hex, uint8_t alpha = 255) {
+    SDL_Color c;
+    c.r = static_cast<uint8_t>((hex >> 16) & 0xFF);
+    c.g = static_cast<uint8_t>((hex >> 8) & 0xFF);
+    c.b = static_cast<uint8_t>(hex & 0xFF);
+    c.a = alpha;
+    return c;
+}
+
+const char* slotLabel(SlotType slot) {
+    switch (slot) {
+        case SlotType::Weapon: return "WEAPON";
+        case SlotType::Drive: return "DRIVE";
+        case SlotType::Computer: return "COMP";
+        case SlotType::Shield: return "SHIELD";
+        case SlotType::Power: return "POWER";
+        case SlotType::Support: return "SUP";
+    }
+    return "";
+}
+
+const char* slotCategoryLabel(SlotType slot) {
+    switch (slot) {
+        case SlotType::Weapon: return "Weapons";
+        case SlotType::Drive: return "Drives";
+        case SlotType::Computer: return "Computers";
+        case SlotType::Shield: return "Shields";
+        case SlotType::Power: return "Power";
+        case SlotType::Support: return "Support";
+    }
+    return "Modules";
+}
+
+SDL_Color slotColor(SlotType slot) {
+    switch (slot) {
+        case SlotType::Weapon: return colorFromHex(0xE07A5F);
+        case SlotType::Drive: return colorFromHex(0x3D405B);
+        case SlotType::Computer: return colorFromHex(0x81B29A);
+        case SlotType::Shield: return colorFromHex(0xF2CC8F);
+        case SlotType::Power: return colorFromHex(0x118AB2);
+        case SlotType::Support: return colorFromHex(0x6C757D);
+    }
+    return colorFromHex(0xFFFFFF);
+}
+
+void drawPanel(RenderBatch& batch, const SDL_Rect& rect, SDL_Color fill, SDL_Color border) {
+    batch.fillRect(rect, fill);
+    batch.drawRect(rect, border);
+}
+
+SDL_Rect slotRectInCard(const SDL_Rect& cardRect, size_t slotIndex) {
+    constexpr int columns = 3;
+    constexpr int slotHeight = 60;
+    int availableWidth = cardRect.w - 40;
+    int spacing = 10;
+    int slotWidth = (availableWidth - (columns - 1) * spacing);
+    slotWidth = std::max(slotWidth / columns, 60);
+    int row = static_cast<int>(slotIndex) / columns;
+    int col = static_cast<int>(slotIndex) % columns;
+    SDL_Rect rect;
+    rect.x = cardRect.x + 20 + col * (slotWidth + spacing);
+    rect.y = cardRect.y + 90 + row * (slotHeight + spacing);
+    rect.w = slotWidth;
+    rect.h = slotHeight;
+    return rect;
+}
+
+std::pair<SDL_Rect, SDL_Rect> arrowRectsForCard(const SDL_Rect& rect) {
+    SDL_Rect left{rect.x + 10, rect.y + 10, 30, 30};
+    SDL_Rect right{rect.x + rect.w - 40, rect.y + 10, 30, 30};
+    return {left, right};
+}
+
+SDL_Rect toggleRectForCard(const SDL_Rect& rect) {
+    return SDL_Rect{rect.x + rect.w - 130, rect.y + 10, 80, 28};
+}
+
+void assignDesign(FleetShip& ship, std::span<const ShipDesign* const> options, size_t index) {
+    if (options.empty()) {
+        ship.loadout.setDesign(nullptr);
+        return;
+    }
+    ship.designIndex = index % options.size();
+    ship.loadout.setDesign(options[ship.designIndex]);
+}
+
+bool ensureModulePlacement(FleetShip& ship, size_t slotIndex, const ModuleSpec* spec) {
+    if (!spec) {
+        ship.loadout.clearModule(slotIndex);
+        return true;
+    }
+    ship.loadout.setModule(slotIndex, spec);
+    if (!ship.loadout.satisfiesEnergy()) {
+        ship.loadout.clearModule(slotIndex);
+        return false;
+    }
+    return true;
+}
+
+std::vector<FleetShip> createFleet(Faction faction,
+                                   std::span<const ShipDesign* const> options, size_t count) {
+    std::vector<FleetShip> fleet(count);
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        fleet[i].faction = faction;
+        if (!options.empty()) {
+            assignDesign(fleet[i], options, std::min(i, options.size() - 1));
+        }
+    }
+    return fleet;
+}
+
+std::vector<ModuleCategory> buildModuleCategories(const std::vector<const ModuleSpec*>& modules) {
+    std::vector<ModuleCategory> categories;
+    constexpr int maxPerCategory = 25;
+    const std::array<SlotType, 6> order = {
+        SlotType::Weapon, SlotType::Drive, SlotType::Computer,
+        SlotType::Shield, SlotType::Power, SlotType::Support};
+    for (SlotType slot : order) {
+        std::vector<const ModuleSpec*> filtered;
+        std::copy_if(modules.begin(), modules.end(), std::back_inserter(filtered), [&](const ModuleSpec* spec) {
+            return spec->slot == slot;
+        });
+        if (filtered.empty()) {
+            continue;
+        }
+        int chunks = static_cast<int>((filtered.size() + maxPerCategory - 1) / maxPerCategory);
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            int start = chunk * maxPerCategory;
+            int end = std::min(start + maxPerCategory, static_cast<int>(filtered.size()));
+            ModuleCategory category;
+            category.name = slotCategoryLabel(slot);
+            if (chunks > 1) {
+                category.name += " " + std::to_string(chunk + 1);
+            }
+            category.modules.insert(category.modules.end(), filtered.begin() + start, filtered.begin() + end);
+            categories.push_back(std::move(category));
+        }
+    }
+    if (categories.empty()) {
+        ModuleCategory fallback;
+        fallback.name = "Modules";
+        fallback.modules = modules;
+        categories.push_back(std::move(fallback));
+    }
+    return categories;
+}
+
+std::vector<PaletteEntry> buildPalette(const std::vector<const ModuleSpec*>& modules,
+                                       const SDL_Rect& area) {
+    std::vector<PaletteEntry> entries;
+    constexpr int columns = 5;
+    constexpr int rows = 5;
+    const int spacing = 6;
+    int tileWidth = (area.w - (columns + 1) * spacing) / columns;
+    int tileHeight = (area.h - (rows + 1) * spacing) / rows;
+    for (size_t i = 0; i < modules.size() && i < static_cast<size_t>(columns * rows); ++i) {
+        int row = static_cast<int>(i) / columns;
+        int col = static_cast<int>(i) % columns;
+        SDL_Rect rect;
+        rect.x = area.x + spacing + col * (tileWidth + spacing);
+        rect.y = area.y + spacing + row * (tileHeight + spacing);
+        rect.w = tileWidth;
+        rect.h = tileHeight;
+        entries.push_back({modules[i], rect});
+    }
+    return entries;
+}
+
+std::vector<CategoryOption> buildCategoryOptions(const SDL_Rect& dropdown,
+                                                 const std::vector<ModuleCategory>& categories) {
+    std::vector<CategoryOption> options;
+    int optionHeight = 26;
+    int spacing = 4;
+    for (size_t i = 0; i < categories.size(); ++i) {
+        SDL_Rect rect;
+        rect.x = dropdown.x;
+        rect.y = dropdown.y + dropdown.h + spacing + static_cast<int>(i) * (optionHeight + spacing);
+        rect.w = dropdown.w;
+        rect.h = optionHeight;
+        options.push_back({i, rect, categories[i].name});
+    }
+    return options;
+}
+
+std::vector<SDL_Rect> layoutCards(const SDL_Rect& area, size_t count) {
+    std::vector<SDL_Rect> rects;
+    if (count == 0) {
+        return rects;
+    }
+    int spacing = 10;
+    int cardWidth = (area.w - (static_cast<int>(count) + 1) * spacing) / static_cast<int>(count);
+    int cardHeight = area.h - 2 * spacing;
+    for (size_t i = 0; i < count; ++i) {
+        SDL_Rect rect;
+        rect.x = area.x + spacing + static_cast<int>(i) * (cardWidth + spacing);
+        rect.y = area.y + spacing;
+        rect.w = cardWidth;
+        rect.h = cardHeight;
+        rects.push_back(rect);
+    }
+    return rects;
+}
+
+std::vector<SlotRect> buildSlotRects(std::vector<FleetShip>& fleet,
+                                     const std::vector<SDL_Rect>& cardRects) {
+    std::vector<SlotRect> slots;
+    for (size_t i = 0; i < fleet.size() && i < cardRects.size(); ++i) {
+        FleetShip& ship = fleet[i];
+        for (size_t slotIndex = 0; slotIndex < ship.loadout.slotCount(); ++slotIndex) {
+            slots.push_back({&ship, slotIndex, slotRectInCard(cardRects[i], slotIndex)});
+        }
+    }
+    return slots;
+}
+
+std::vector<ArrowRect> buildArrows(std::vector<FleetShip>& fleet,
+                                   const std::vector<SDL_Rect>& cardRects) {
+    std::vector<ArrowRect> arrows;
+    for (size_t i = 0; i < fleet.size() && i < cardRects.size(); ++i) {
+        auto [left, right] = arrowRectsForCard(cardRects[i]);
+        arrows.push_back({&fleet[i], left, -1});
+        arrows.push_back({&fleet[i], right, +1});
+    }
+    return arrows;
+}
+
+std::vector<ToggleRect> buildToggles(std::vector<FleetShip>& fleet,
+                                     const std::vector<SDL_Rect>& cardRects) {
+    std::vector<ToggleRect> toggles;
+    for (size_t i = 0; i < fleet.size() && i < cardRects.size(); ++i) {
+        toggles.push_back({&fleet[i], toggleRectForCard(cardRects[i])});
+    }
+    return toggles;
+}
+
+// Uniform grid over the window; each cell lists the hit regions overlapping
+// it, so a lookup tests a handful of rects instead of every one on screen.
+enum class HitKind : std::uint8_t { Slot, Arrow, Toggle, Palette };
+
+class HitGrid {
+public:
+    static constexpr int kCellSize = 64;
+
+    void reset(int width, int height) {
+        columns_ = std::max(1, (width + kCellSize - 1) / kCellSize);
+        rows_ = std::max(1, (height + kCellSize - 1) / kCellSize);
+        cells_.assign(static_cast<size_t>(columns_) * rows_, {});
+    }
+
+    void insert(const SDL_Rect& rect, HitKind kind, size_t index) {
+        int firstColumn = std::clamp(rect.x / kCellSize, 0, columns_ - 1);
+        // pointInRect includes the right and bottom edges.
+        int lastColumn = std::clamp((rect.x + rect.w) / kCellSize, 0, columns_ - 1);
+        int firstRow = std::clamp(rect.y / kCellSize, 0, rows_ - 1);
+        int lastRow = std::clamp((rect.y + rect.h) / kCellSize, 0, rows_ - 1);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                cells_[static_cast<size_t>(row) * columns_ + column].push_back({rect, kind, index});
+            }
+        }
+    }
+
+    // Index of the first region of `kind` containing the point, in insertion order.
+    std::optional<size_t> find(int x, int y, HitKind kind) const {
+        if (x < 0 || y < 0 || x / kCellSize >= columns_ || y / kCellSize >= rows_) {
+            return std::nullopt;
+        }
+        for (const Entry& entry : cells_[static_cast<size_t>(y / kCellSize) * columns_ + x / kCellSize]) {
+            if (entry.kind == kind && pointInRect(x, y, entry.rect)) {
+                return entry.index;
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    struct Entry {
+        SDL_Rect rect;
+        HitKind kind;
+        size_t index;
+    };
+
+    int columns_ = 1;
+    int rows_ = 1;
+    std::vector<std::vector<Entry>> cells_;
+};
+
+// Card, slot, arrow and toggle rects for both fleets plus their hit grid.
+// Rebuilt only when a design (and so a slot count), the palette page or the
+// window size changes.
+struct UiLayout {
+    std::vector<SDL_Rect> humanCards;
+    std::vector<SDL_Rect> alienCards;
+    std::vector<SlotRect> slots;
+    std::vector<ArrowRect> arrows;
+    std::vector<ToggleRect> toggles;
+    HitGrid grid;
+};
+
+void buildLayout(UiLayout& layout, int width, int height,
+                 std::vector<FleetShip>& humanFleet, const SDL_Rect& humanArea,
+                 std::vector<FleetShip>& alienFleet, const SDL_Rect& alienArea,
+                 const std::vector<PaletteEntry>& paletteEntries) {
+    layout.humanCards = layoutCards(humanArea, humanFleet.size());
+    layout.alienCards = layoutCards(alienArea, alienFleet.size());
+
+    layout.slots = buildSlotRects(humanFleet, layout.humanCards);
+    std::vector<SlotRect> alienSlots = buildSlotRects(alienFleet, layout.alienCards);
+    layout.slots.insert(layout.slots.end(), alienSlots.begin(), alienSlots.end());
+
+    layout.arrows = buildArrows(humanFleet, layout.humanCards);
+    std::vector<ArrowRect> alienArrows = buildArrows(alienFleet, layout.alienCards);
+    layout.arrows.insert(layout.arrows.end(), alienArrows.begin(), alienArrows.end());
+
+    layout.toggles = buildToggles(humanFleet, layout.humanCards);
+    std::vector<ToggleRect> alienToggles = buildToggles(alienFleet, layout.alienCards);
+    layout.toggles.insert(layout.toggles.end(), alienToggles.begin(), alienToggles.end());
+
+    layout.grid.reset(width, height);
+    for (size_t i = 0; i < layout.slots.size(); ++i) {
+        layout.grid.insert(layout.slots[i].rect, HitKind::Slot, i);
+    }
+    for (size_t i = 0; i < layout.arrows.size(); ++i) {
+        layout.grid.insert(layout.arrows[i].rect, HitKind::Arrow, i);
+    }
+    for (size_t i = 0; i < layout.toggles.size(); ++i) {
+        layout.grid.insert(layout.toggles[i].rect, HitKind::Toggle, i);
+    }
+    for (size_t i = 0; i < paletteEntries.size(); ++i) {
+        layout.grid.insert(paletteEntries[i].rect, HitKind::Palette, i);
+    }
+}
+
+// Red for -1 through amber at 0 to teal for +1.
+SDL_Color edgeColor(double edge) {
+    edge = std::clamp(edge, -1.0, 1.0);
+    SDL_Color even = colorFromHex(0xFFB703);
+    SDL_Color to = edge < 0.0 ? colorFromHex(0xE63946) : colorFromHex(0x2EC4B6);
+    double t = std::abs(edge);
+    auto mix = [t](Uint8 a, Uint8 b) { return static_cast<Uint8>(a + (b - a) * t + 0.5); };
+    return SDL_Color{mix(even.r, to.r), mix(even.g, to.g), mix(even.b, to.b), 255};
+}
+
+// Red when the column fleet wins, teal when the row fleet does.
+SDL_Color heatColor(const BattleSummary& summary) {
+    return edgeColor(summary.humanWin - summary.alienWin);
+}
+
+// With module values, each tile gets a strip showing the best change in the
+// human win chance from fitting it anywhere in the fleet ("--" where it fits
+// nowhere legal); +/-20 points saturate the colour.
+void renderPalette(RenderBatch& batch, BitmapFont& font, const SDL_Rect& area,
+                   const SDL_Rect& dropdownRect, const std::string& categoryName,
+                   bool dropdownOpen, const std::vector<CategoryOption>& options,
+                   const std::vector<PaletteEntry>& entries, const ModuleValues* values) {
+    drawPanel(batch, area, colorFromHex(0x1B1F3B), colorFromHex(0x394989));
+    SDL_Color dropdownFill = colorFromHex(0x23395B);
+    drawPanel(batch, dropdownRect, dropdownFill, colorFromHex(0xF4F1DE));
+    font.drawText(batch, categoryName, dropdownRect.x + 8, dropdownRect.y + 8,
+                  colorFromHex(0xF7FFF7), 1);
+    int arrowX = dropdownRect.x + dropdownRect.w - 20;
+    SDL_Color arrowColor = colorFromHex(0xF4F1DE);
+    batch.drawLine({arrowX - 6, dropdownRect.y + 12}, {arrowX, dropdownRect.y + 18}, arrowColor);
+    batch.drawLine({arrowX + 6, dropdownRect.y + 12}, {arrowX, dropdownRect.y + 18}, arrowColor);
+
+    for (const PaletteEntry& entry : entries) {
+        SDL_Color fill = slotColor(entry.spec->slot);
+        drawPanel(batch, entry.rect, fill, colorFromHex(0x000000));
+        font.drawText(batch, entry.spec->shortLabel, entry.rect.x + 6, entry.rect.y + 6,
+                      colorFromHex(0x000000), 1);
+        std::string energy = "E:" + std::to_string(entry.spec->energyCost) +
+                             " P:" + std::to_string(entry.spec->energyProvided);
+        font.drawText(batch, energy, entry.rect.x + 6, entry.rect.y + 24, colorFromHex(0x000000), 1);
+        if (values) {
+            SDL_Rect strip{entry.rect.x + 3, entry.rect.y + entry.rect.h - 19, entry.rect.w - 6, 16};
+            auto value = values->find(entry.spec);
+            std::string label = "--";
+            if (value == values->end()) {
+                batch.fillRect(strip, colorFromHex(0x5C677D));
+            } else {
+                std::ostringstream text;
+                text.precision(1);
+                text << std::fixed << std::showpos << value->second * 100.0;
+                label = text.str();
+                batch.fillRect(strip, edgeColor(value->second * 5.0));
+            }
+            font.drawText(batch, label, strip.x + (strip.w - font.measureTextWidth(label, 1)) / 2, strip.y + 4,
+                          colorFromHex(0x011627), 1);
+        }
+    }
+
+    if (dropdownOpen) {
+        for (const CategoryOption& option : options) {
+            SDL_Color fill = option.label == categoryName ? colorFromHex(0x2E5A88)
+                                                          : colorFromHex(0x1D2D50);
+            drawPanel(batch, option.rect, fill, colorFromHex(0xF4F1DE));
+            font.drawText(batch, option.label.c_str(), option.rect.x + 6, option.rect.y + 6,
+                          colorFromHex(0xF7FFF7), 1);
+        }
+    }
+
+    font.drawText(batch, "Drag modules onto ships. Right click removes.",
+                  area.x + 12, area.y + area.h - 60, colorFromHex(0xF4F1DE), 1);
+}
+
+void renderArrow(RenderBatch& batch, const SDL_Rect& rect, bool isRight) {
+    SDL_Color white = colorFromHex(0xFFFFFF);
+    batch.drawRect(rect, white);
+    SDL_Point top = isRight ? SDL_Point{rect.x + 6, rect.y + 6} : SDL_Point{rect.x + rect.w - 6, rect.y + 6};
+    SDL_Point mid = isRight ? SDL_Point{rect.x + rect.w - 6, rect.y + rect.h / 2}
+                            : SDL_Point{rect.x + 6, rect.y + rect.h / 2};
+    SDL_Point bottom = isRight ? SDL_Point{rect.x + 6, rect.y + rect.h - 6}
+                               : SDL_Point{rect.x + rect.w - 6, rect.y + rect.h - 6};
+    batch.drawLine(top, mid, white);
+    batch.drawLine(mid, bottom, white);
+}
+
+void renderShipCard(RenderBatch& batch, BitmapFont& font, FleetShip& ship,
+                    const SDL_Rect& rect, bool isHuman) {
+    SDL_Color fill = isHuman ? colorFromHex(0x14213D) : colorFromHex(0x2F1847);
+    SDL_Color border = isHuman ? colorFromHex(0x3A506B) : colorFromHex(0x6247AA);
+    if (!ship.active) {
+        fill = colorFromHex(0x1F1F2E);
+        border = colorFromHex(0x4A4E69);
+    }
+    drawPanel(batch, rect, fill, border);
+
+    auto [prevRect, nextRect] = arrowRectsForCard(rect);
+    renderArrow(batch, prevRect, false);
+    renderArrow(batch, nextRect, true);
+
+    SDL_Rect toggleRect = toggleRectForCard(rect);
+    SDL_Color toggleFill = ship.active ? colorFromHex(0x2EC4B6) : colorFromHex(0x8D99AE);
+    drawPanel(batch, toggleRect, toggleFill, colorFromHex(0x011627));
+    const char* toggleText = ship.active ? "ACTIVE" : "INACTIVE";
+    font.drawText(batch, toggleText, toggleRect.x + 8, toggleRect.y + 6, colorFromHex(0x011627), 1);
+
+    std::string_view title = ship.loadout.design() ? ship.loadout.design()->name : "NO DESIGN";
+    font.drawText(batch, title, rect.x + 50, rect.y + 16, colorFromHex(0xF0F4EF), 1);
+
+    const ShipDerivedStats& stats = ship.loadout.derivedStats();
+    std::ostringstream statLine;
+    statLine << "H" << stats.hull << " D" << stats.dice << " C" << stats.computer
+             << " S" << stats.shield;
+    font.drawText(batch, statLine.str(), rect.x + 20, rect.y + 52, colorFromHex(0xF4F1BB), 1);
+
+    std::string energyLine = "ENERGY " + std::to_string(stats.energyUsed) + "/" +
+                             std::to_string(stats.energyAvailable);
+    font.drawText(batch, energyLine, rect.x + rect.w - 200, rect.y + 52, colorFromHex(0xF4F1BB), 1);
+
+    std::string_view error = ship.loadout.validationError();
+    if (ship.active && !error.empty()) {
+        font.drawText(batch, error, rect.x + 20, rect.y + rect.h - 28, colorFromHex(0xEF233C), 1);
+    } else if (!ship.active) {
+        font.drawText(batch, "Ship inactive", rect.x + 20, rect.y + rect.h - 28,
+                      colorFromHex(0xADB5BD), 1);
+    }
+
+    for (size_t slotIndex = 0; slotIndex < ship.loadout.slotCount(); ++slotIndex) {
+        SDL_Rect slotRect = slotRectInCard(rect, slotIndex);
+        const SlotBlueprint& blueprint = ship.loadout.design()->slots[slotIndex];
+        SDL_Color fillColor = slotColor(blueprint.preferredType);
+        drawPanel(batch, slotRect, fillColor, colorFromHex(0x000000));
+        font.drawText(batch, slotLabel(blueprint.preferredType),
+                      slotRect.x + 4, slotRect.y + 4, colorFromHex(0x000000), 1);
+        const ModuleSpec* activeModule = ship.loadout.activeModuleAt(slotIndex);
+        if (activeModule) {
+            bool isTile = ship.loadout.moduleAt(slotIndex) != nullptr;
+            SDL_Color textColor = isTile ? colorFromHex(0x000000) : colorFromHex(0x222222);
+            font.drawText(batch, activeModule->shortLabel, slotRect.x + 4, slotRect.y + 32,
+                          textColor, 1);
+        }
+    }
+}
+
+void renderDragGhost(RenderBatch& batch, BitmapFont& font, const DragPayload& drag) {
+    if (!drag.active || !drag.spec) {
+        return;
+    }
+    SDL_Rect ghost{drag.mouseX - 50, drag.mouseY - 20, 100, 40};
+    drawPanel(batch, ghost, slotColor(drag.spec->slot), colorFromHex(0xFFFFFF));
+    font.drawText(batch, drag.spec->shortLabel, ghost.x + 6, ghost.y + 10, colorFromHex(0x000000), 1);
+}
+
+// Frame statistics and the solver's published counters in a corner of the
+// screen. Only relaxed atomic loads touch the simulator and the shared cache,
+// so it can be drawn while solves are running on worker threads. storeSize is
+// the solution store's entry count as of the last finished solve, if any.
+void renderHud(RenderBatch& batch, BitmapFont& font, int screenWidth, const FrameTimes& frames, int drawCalls,
+               const SolveProgress& progress, const SolveCache& shared, std::optional<std::size_t> storeSize) {
+    auto load = [](const std::atomic<std::uint64_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    };
+    std::uint64_t expanded = load(progress.statesExpanded);
+    std::uint64_t hits = load(progress.memoHits) + load(progress.sharedHits) + load(progress.storeHits);
+    constexpr double kMegabyte = 1024.0 * 1024.0;
+
+    std::ostringstream lines;
+    lines << std::fixed;
+    lines.precision(2);
+    lines << "FRAME P50 " << frames.percentile(0.5) << " P95 " << frames.percentile(0.95) << " MAX "
+          << frames.percentile(1.0) << " MS\n";
+    lines << "DRAW CALLS " << drawCalls << "\n";
+    lines.precision(1);
+    if (progress.solving.load(std::memory_order_relaxed)) {
+        lines << "SOLVING\n";
+    } else {
+        lines << "LAST SOLVE " << static_cast<double>(load(progress.lastSolveMicros)) / 1000.0 << " MS\n";
+    }
+    lines << "STATES " << expanded << "\n";
+    lines << "CACHE HIT " << (hits + expanded == 0 ? 0.0 : 100.0 * static_cast<double>(hits) /
+                                                                static_cast<double>(hits + expanded))
+          << "%\n";
+    lines << "MEMO " << static_cast<double>(load(progress.memoBytes)) / kMegabyte << " MB  SHARED "
+          << static_cast<double>(shared.memoryBytes()) / kMegabyte << " MB";
+    if (storeSize) {
+        lines << "\nSTORE " << *storeSize << " SOLUTIONS";
+    }
+
+    SDL_Rect panel{screenWidth - 300, 10, 290, (storeSize ? 7 : 6) * font.lineHeight(1) + 16};
+    drawPanel(batch, panel, colorFromHex(0x011627), colorFromHex(0x2EC4B6));
+    font.drawText(batch, lines.str(), panel.x + 8, panel.y + 8, colorFromHex(0xF1FAEE), 1);
+}
+
+// Heatmap of the row fleet's win chance against each column fleet; cells not
+// solved yet stay dark.
+void renderMatrix(RenderBatch& batch, BitmapFont& font, const SDL_Rect& area,
+                  const std::vector<MatrixEntry>& entries,
+                  const std::vector<std::optional<BattleSummary>>& cells, size_t solved) {
+    drawPanel(batch, area, colorFromHex(0x0B132B), colorFromHex(0x1C2541));
+    std::ostringstream title;
+    title << "MATCHUP MATRIX - ROW FLEET WIN % AS HUMANS  " << solved << "/" << cells.size() << " SOLVED";
+    font.drawText(batch, title.str(), area.x + 12, area.y + 10, colorFromHex(0xF1FAEE), 1);
+    if (entries.empty()) {
+        return;
+    }
+
+    constexpr int labelWidth = 64;
+    constexpr int headerHeight = 18;
+    int count = static_cast<int>(entries.size());
+    int top = area.y + 30 + headerHeight;
+    int left = area.x + 12 + labelWidth;
+    int cellWidth = std::max(8, (area.x + area.w - 12 - left) / count);
+    int cellHeight = std::max(8, (area.y + area.h - 12 - top) / count);
+    SDL_Color label = colorFromHex(0xA9BCD0);
+    for (int i = 0; i < count; ++i) {
+        const std::string& name = entries[static_cast<size_t>(i)].label;
+        font.drawText(batch, name, area.x + 12, top + i * cellHeight + (cellHeight - font.lineHeight(1)) / 2, label,
+                      1);
+        int width = font.measureTextWidth(name, 1);
+        font.drawText(batch, name, left + i * cellWidth + std::max(0, (cellWidth - width) / 2), area.y + 30, label,
+                      1);
+    }
+    for (int row = 0; row < count; ++row) {
+        for (int column = 0; column < count; ++column) {
+            SDL_Rect cell{left + column * cellWidth, top + row * cellHeight, cellWidth - 2, cellHeight - 2};
+            const std::optional<BattleSummary>& summary = cells[static_cast<size_t>(row * count + column)];
+            if (!summary) {
+                batch.fillRect(cell, colorFromHex(0x1D2D44));
+                continue;
+            }
+            batch.fillRect(cell, heatColor(*summary));
+            std::string percent = std::to_string(static_cast<int>(summary->humanWin * 100.0 + 0.5));
+            int width = font.measureTextWidth(percent, 1);
+            font.drawText(batch, percent, cell.x + (cell.w - width) / 2,
+                          cell.y + (cell.h - font.lineHeight(1)) / 2, colorFromHex(0x011627), 1);
+        }
+    }
+}
+
+std::vector<ShipLoadout> collectFleet(const std::vector<FleetShip>& fleet) {
+    std::vector<ShipLoadout> result;
+    result.reserve(fleet.size());
+    for (const FleetShip& ship : fleet) {
+        if (!ship.active) {
+            continue;
+        }
+        result.push_back(ship.loadout);
+    }
+    return result;
+}
+
+bool fleetReady(const std::vector<FleetShip>& fleet) {
+    bool hasActive = false;
+    for (const FleetShip& ship : fleet) {
+        if (!ship.active) {
+            continue;
+        }
+        hasActive = true;
+        if (!ship.loadout.isValid()) {
+            return false;
+        }
+    }
+    return hasActive;
+}
+
+std::span<const ShipDesign* const> designOptionsFor(
+    const FleetShip& ship,
+    std::span<const ShipDesign* const> humanDesigns,
+    std::span<const ShipDesign* const> alienDesigns) {
+    return ship.faction == Faction::Human ? humanDesigns : alienDesigns;
+}
+
+}  // namespace
+
+struct FleetBuilder::Impl {
+    explicit Impl(FleetBuilderOptions opts)
+        : options(std::move(opts)), simulator(options.store) {
+        simulator.setSharedCache(sharedCache);
+        std::vector<const ModuleSpec*> moduleRefs;
+        for (const ModuleSpec& spec : TechCatalog::modules()) {
+            if (spec.blueprintOnly) {
+                continue;
+            }
+            moduleRefs.push_back(&spec);
+        }
+        moduleCategories = buildModuleCategories(moduleRefs);
+        categoryOptions = buildCategoryOptions(dropdownRect, moduleCategories);
+        rebuildPaletteEntries();
+
+        humanDesigns = TechCatalog::factionDesigns(Faction::Human);
+        alienDesigns = TechCatalog::factionDesigns(Faction::Orion);
+        humanFleet = createFleet(Faction::Human, humanDesigns, options.shipsPerSide);
+        alienFleet = createFleet(Faction::Orion, alienDesigns, options.shipsPerSide);
+
+        if (options.backgroundSolves) {
+            Uint32 first = SDL_RegisterEvents(3);
+            if (first != static_cast<Uint32>(-1)) {
+                simulationDoneEvent = first;
+                matrixCellEvent = first + 1;
+                sensitivityDoneEvent = first + 2;
+            }
+        }
+    }
+
+    FleetBuilderOptions options;
+    BitmapFont& font = BitmapFont::instance();
+    RenderBatch batch;
+
+    SDL_Rect paletteRect{20, 20, 320, 680};
+    SDL_Rect dropdownRect{paletteRect.x + 16, paletteRect.y + 16, paletteRect.w - 32, 34};
+    SDL_Rect paletteGridRect{paletteRect.x + 16, dropdownRect.y + dropdownRect.h + 12,
+                             paletteRect.w - 32, paletteRect.h - dropdownRect.h - 120};
+    SDL_Rect humanArea{360, 20, 900, 320};
+    SDL_Rect alienArea{360, 360, 900, 320};
+    SDL_Rect simulateButton{paletteRect.x + 20, paletteRect.y + paletteRect.h - 60,
+                            paletteRect.w - 40, 40};
+
+    std::vector<ModuleCategory> moduleCategories;
+    size_t activeCategory = 0;
+    std::vector<CategoryOption> categoryOptions;
+    std::vector<PaletteEntry> paletteEntries;
+    bool dropdownOpen = false;
+
+    std::span<const ShipDesign* const> humanDesigns;
+    std::span<const ShipDesign* const> alienDesigns;
+    std::vector<FleetShip> humanFleet;
+    std::vector<FleetShip> alienFleet;
+
+    DragPayload drag;
+    std::string statusMessage;
+    Uint32 statusTimer = 0;
+
+    BattleSimulator simulator;
+    BattleSummary summary;
+    bool summaryReady = false;
+
+    // Background solves report through this SDL user event; editing a fleet
+    // cancels the solve in flight.
+    Uint32 simulationDoneEvent = 0;
+    std::jthread solver;
+    int solveJob = 0;
+    bool solving = false;
+
+    bool simulatePressed = false;
+    bool redraw = true;
+    bool statusDrawn = false;  // the last frame showed the status message
+
+    // Solved sub-battles kept for the life of the screen, so the matrix, the
+    // module ranking and the main simulator only solve what an edit actually
+    // changed.
+    std::shared_ptr<SolveCache> sharedCache = std::make_shared<SolveCache>();
+    // Entries in options.store, read on the UI thread after each solve; the
+    // HUD cannot take the store's lock while a solve may be flushing it.
+    std::optional<std::size_t> storeSize;
+
+    // Matchup matrix mode, toggled with M: every faction blueprint, plus the
+    // fleets being built when they are ready, against each other. Cells are
+    // solved on a pool sharing sharedCache and arrive one SDL user event each.
+    bool matrixMode = false;
+    std::vector<MatrixEntry> matrixEntries;
+    std::vector<std::optional<BattleSummary>> matrixCells;
+    size_t matrixSolved = 0;
+    std::string matrixKey;  // the entries the cells belong to
+    Uint32 matrixCellEvent = 0;
+    Uint32 matrixStarted = 0;
+    int matrixJob = 0;
+    std::jthread matrixSolver;
+
+    // Palette tinting, toggled with V: every module's best marginal value for
+    // the human fleet, re-ranked in the background after each edit.
+    bool valueMode = false;
+    ModuleValues moduleValues;  // empty until the ranking for the current fleets arrives
+    Uint32 sensitivityDoneEvent = 0;
+    int sensitivityJob = 0;
+    std::jthread sensitivitySolver;
+
+    // Performance overlay, toggled with F3.
+    bool hudVisible = false;
+    FrameTimes frameTimes;
+    Uint32 renderTicks = 0;  // when the last frame was drawn
+
+    UiLayout layout;
+    bool layoutDirty = true;
+    int width = 1280;
+    int height = 720;
+    int drawCalls = 0;
+
+    void rebuildPaletteEntries() {
+        paletteEntries = buildPalette(moduleCategories[activeCategory].modules, paletteGridRect);
+        layoutDirty = true;
+    }
+
+    void setStatus(const std::string& msg) {
+        statusMessage = msg;
+        statusTimer = SDL_GetTicks();
+    }
+
+    void invalidateSummary() {
+        summaryReady = false;
+        if (solving) {
+            solver.request_stop();
+        }
+        if (valueMode) {
+            startSensitivity();
+        }
+    }
+
+    void ensureLayout() {
+        if (layoutDirty) {
+            buildLayout(layout, width, height, humanFleet, humanArea, alienFleet, alienArea, paletteEntries);
+            layoutDirty = false;
+        }
+    }
+
+    std::vector<FleetShip>& fleet(FleetSide side) { return side == FleetSide::Human ? humanFleet : alienFleet; }
+
+    const std::vector<SDL_Rect>& cards(FleetSide side) {
+        ensureLayout();
+        return side == FleetSide::Human ? layout.humanCards : layout.alienCards;
+    }
+
+    SlotRect* findSlot(int x, int y) {
+        std::optional<size_t> index = layout.grid.find(x, y, HitKind::Slot);
+        return index ? &layout.slots[*index] : nullptr;
+    }
+
+    const PaletteEntry* paletteAt(int x, int y) {
+        std::optional<size_t> index = layout.grid.find(x, y, HitKind::Palette);
+        return index ? &paletteEntries[*index] : nullptr;
+    }
+
+    void cycleDesign(FleetShip& ship, int delta) {
+        auto designs = designOptionsFor(ship, humanDesigns, alienDesigns);
+        if (designs.empty()) {
+            return;
+        }
+        size_t newIndex = (ship.designIndex + designs.size() + static_cast<size_t>(delta)) % designs.size();
+        assignDesign(ship, designs, newIndex);
+        layoutDirty = true;
+        invalidateSummary();
+        setStatus("Design updated.");
+    }
+
+    void completeDrag(int mx, int my) {
+        if (!drag.active || !drag.spec) {
+            drag.active = false;
+            return;
+        }
+        bool placed = false;
+        SlotRect* slot = findSlot(mx, my);
+        if (slot && slot->ship->loadout.isSlotCompatible(slot->slotIndex, *drag.spec)) {
+            if (ensureModulePlacement(*slot->ship, slot->slotIndex, drag.spec)) {
+                placed = true;
+                invalidateSummary();
+                setStatus("Module installed.");
+            } else {
+                setStatus("Not enough energy for module.");
+            }
+        }
+        if (!placed && !drag.fromPalette && drag.sourceShip && drag.sourceSlot >= 0) {
+            ensureModulePlacement(*drag.sourceShip, drag.sourceSlot, drag.spec);
+        }
+        drag.active = false;
+    }
+
+    static std::unique_ptr<SimulationResult> solve(BattleSimulator& simulator, int job, Matchup matchup,
+                                                   std::stop_token stop) {
+        auto result = std::make_unique<SimulationResult>();
+        result->job = job;
+        auto started = std::chrono::steady_clock::now();
+        try {
+            result->summary = simulator.simulate(matchup.humans, matchup.aliens, stop);
+        } catch (const std::exception& error) {
+            result->cancelled = stop.stop_requested();
+            result->error = error.what();
+        }
+        result->stats = simulator.lastStats();
+        result->milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        result->matchup = std::move(matchup);
+        return result;
+    }
+
+    void startSimulation(Matchup matchup) {
+        ++solveJob;
+        solving = true;
+        summaryReady = false;
+        if (!options.backgroundSolves) {
+            finishSimulation(*solve(simulator, solveJob, std::move(matchup), {}));
+            return;
+        }
+        solver = std::jthread([this, job = solveJob, matchup = std::move(matchup)](std::stop_token stop) mutable {
+            std::unique_ptr<SimulationResult> result = solve(simulator, job, std::move(matchup), stop);
+            SDL_Event done{};
+            done.type = simulationDoneEvent;
+            done.user.data1 = result.get();
+            if (SDL_PushEvent(&done) == 1) {
+                result.release();
+            }
+        });
+    }
+
+    void finishSimulation(SimulationResult& result) {
+        // Every request is logged, superseded and failed ones included, so a
+        // replay sees the load the session actually put on the solver.
+        if (options.recorder) {
+            WorkloadOutcome outcome = result.cancelled        ? WorkloadOutcome::Cancelled
+                                      : !result.error.empty() ? WorkloadOutcome::Error
+                                                              : WorkloadOutcome::Ok;
+            options.recorder->record(
+                WorkloadEntry{result.matchup, result.summary, result.stats, result.milliseconds, outcome});
+        }
+        if (options.store) {
+            storeSize = options.store->size();
+        }
+        if (result.job != solveJob) {
+            return;
+        }
+        solving = false;
+        if (result.cancelled) {
+            setStatus("Simulation cancelled.");
+        } else if (!result.error.empty()) {
+            setStatus("Simulation failed: " + result.error);
+        } else {
+            summary = result.summary;
+            summaryReady = true;
+            setStatus("Simulation complete.");
+        }
+    }
+
+    void storeMatrixCell(const MatrixCell& cell) {
+        std::optional<BattleSummary>& slot = matrixCells[cell.row * matrixEntries.size() + cell.column];
+        if (!slot) {
+            ++matrixSolved;
+        }
+        slot = cell.summary;
+        if (matrixSolved == matrixCells.size()) {
+            setStatus("Matrix solved in " + std::to_string(SDL_GetTicks() - matrixStarted) + " ms.");
+        }
+    }
+
+    // Shows the matrix, restarting the solve if the fleets being built changed
+    // since it was started. Blueprint cells come back from the shared cache.
+    void showMatrix() {
+        matrixMode = true;
+        simulatePressed = false;
+        if (drag.active) {
+            completeDrag(-1, -1);  // off every slot, so a moved module goes back
+        }
+        std::vector<MatrixEntry> entries = factionDesignEntries();
+        if (fleetReady(humanFleet)) {
+            entries.push_back({"FLEET H", collectFleet(humanFleet)});
+        }
+        if (fleetReady(alienFleet)) {
+            entries.push_back({"FLEET A", collectFleet(alienFleet)});
+        }
+        std::string key;
+        for (const MatrixEntry& entry : entries) {
+            key += entry.label + ":" + formatFleet(entry.fleet) + ";";
+        }
+        if (key == matrixKey) {
+            return;
+        }
+        matrixKey = std::move(key);
+        matrixEntries = entries;
+        matrixCells.assign(entries.size() * entries.size(), std::nullopt);
+        matrixSolved = 0;
+        matrixStarted = SDL_GetTicks();
+        ++matrixJob;
+        setStatus("Solving matrix...");
+
+        MatrixOptions matrixOptions;
+        matrixOptions.cache = sharedCache;
+        if (!options.backgroundSolves) {
+            std::mutex mutex;
+            solveMatrix(matrixEntries, matrixOptions, [&](const MatrixCell& cell) {
+                std::lock_guard<std::mutex> lock(mutex);
+                storeMatrixCell(cell);
+            });
+            return;
+        }
+        // Leave a core for the UI thread.
+        matrixOptions.threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        // Assigning stops and joins the previous solve.
+        matrixSolver = std::jthread([entries = std::move(entries), matrixOptions, event = matrixCellEvent,
+                                     job = matrixJob](std::stop_token stop) {
+            solveMatrix(entries, matrixOptions, [event, job](const MatrixCell& cell) {
+                auto result = std::make_unique<MatrixResult>(MatrixResult{job, cell});
+                SDL_Event done{};
+                done.type = event;
+                done.user.data1 = result.get();
+                if (SDL_PushEvent(&done) == 1) {
+                    result.release();
+                }
+            }, stop);
+        });
+    }
+
+    static std::unique_ptr<SensitivityResult> rank(int job, Matchup matchup, SensitivityOptions options,
+                                                   std::stop_token stop) {
+        auto result = std::make_unique<SensitivityResult>();
+        result->job = job;
+        try {
+            result->report = slotSensitivity(matchup.humans, matchup.aliens, options, stop);
+        } catch (const std::exception& error) {
+            result->cancelled = stop.stop_requested();
+            result->error = error.what();
+        }
+        return result;
+    }
+
+    // Ranks every single-slot change to the human fleet; assigning the worker
+    // stops and joins a ranking still running for the previous fleets.
+    void startSensitivity() {
+        ++sensitivityJob;
+        moduleValues.clear();
+        if (!fleetReady(humanFleet) || !fleetReady(alienFleet)) {
+            sensitivitySolver = std::jthread();
+            setStatus("Module values need a valid fleet on both sides.");
+            return;
+        }
+        Matchup matchup{collectFleet(humanFleet), collectFleet(alienFleet)};
+        SensitivityOptions sensitivityOptions;
+        sensitivityOptions.cache = sharedCache;
+        if (!options.backgroundSolves) {
+            finishSensitivity(*rank(sensitivityJob, std::move(matchup), sensitivityOptions, {}));
+            return;
+        }
+        sensitivityOptions.threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        sensitivitySolver = std::jthread([job = sensitivityJob, matchup = std::move(matchup), sensitivityOptions,
+                                          event = sensitivityDoneEvent](std::stop_token stop) mutable {
+            std::unique_ptr<SensitivityResult> result = rank(job, std::move(matchup), sensitivityOptions, stop);
+            SDL_Event done{};
+            done.type = event;
+            done.user.data1 = result.get();
+            if (SDL_PushEvent(&done) == 1) {
+                result.release();
+            }
+        });
+    }
+
+    void finishSensitivity(const SensitivityResult& result) {
+        if (result.job != sensitivityJob || !valueMode || result.cancelled) {
+            return;
+        }
+        if (!result.error.empty()) {
+            setStatus("Module ranking failed: " + result.error);
+            return;
+        }
+        for (const SlotChange& change : result.report.changes) {
+            if (!change.after) {
+                continue;
+            }
+            auto [it, inserted] = moduleValues.emplace(change.after, change.delta);
+            if (!inserted) {
+                it->second = std::max(it->second, change.delta);
+            }
+        }
+        if (result.report.changes.empty()) {
+            setStatus("No legal single-slot change.");
+            return;
+        }
+        const SlotChange& best = result.report.changes.front();
+        std::ostringstream status;
+        status.precision(1);
+        status << std::fixed << "Best: ship " << best.ship + 1 << " slot " << best.slot + 1 << " "
+               << (best.after ? best.after->shortLabel : std::string_view("clear")) << " " << std::showpos
+               << best.delta * 100.0 << "%";
+        setStatus(status.str());
+    }
+
+    void mouseDown(const SDL_MouseButtonEvent& button) {
+        int mx = button.x;
+        int my = button.y;
+        if (button.button == SDL_BUTTON_LEFT) {
+            bool handled = false;
+            if (pointInRect(mx, my, dropdownRect)) {
+                dropdownOpen = !dropdownOpen;
+                handled = true;
+            } else if (dropdownOpen) {
+                for (const CategoryOption& option : categoryOptions) {
+                    if (pointInRect(mx, my, option.rect)) {
+                        if (option.index < moduleCategories.size() && activeCategory != option.index) {
+                            activeCategory = option.index;
+                            rebuildPaletteEntries();
+                            setStatus(std::string("Showing ") + moduleCategories[activeCategory].name + " modules.");
+                        }
+                        break;
+                    }
+                }
+                dropdownOpen = false;
+                handled = true;
+            }
+
+            if (!handled) {
+                if (std::optional<size_t> index = layout.grid.find(mx, my, HitKind::Toggle)) {
+                    FleetShip& ship = *layout.toggles[*index].ship;
+                    ship.active = !ship.active;
+                    invalidateSummary();
+                    setStatus(ship.active ? "Ship activated." : "Ship deactivated.");
+                    handled = true;
+                }
+            }
+
+            if (!handled) {
+                if (std::optional<size_t> index = layout.grid.find(mx, my, HitKind::Arrow)) {
+                    cycleDesign(*layout.arrows[*index].ship, layout.arrows[*index].delta);
+                    handled = true;
+                }
+            }
+            if (!handled) {
+                if (const PaletteEntry* entry = paletteAt(mx, my)) {
+                    drag.active = true;
+                    drag.spec = entry->spec;
+                    drag.sourceShip = nullptr;
+                    drag.sourceSlot = -1;
+                    drag.fromPalette = true;
+                    drag.mouseX = mx;
+                    drag.mouseY = my;
+                    handled = true;
+                }
+            }
+            if (!handled) {
+                if (SlotRect* slot = findSlot(mx, my)) {
+                    if (const ModuleSpec* module = slot->ship->loadout.moduleAt(slot->slotIndex)) {
+                        drag.active = true;
+                        drag.spec = module;
+                        drag.sourceShip = slot->ship;
+                        drag.sourceSlot = static_cast<int>(slot->slotIndex);
+                        drag.fromPalette = false;
+                        drag.mouseX = mx;
+                        drag.mouseY = my;
+                        slot->ship->loadout.clearModule(slot->slotIndex);
+                        handled = true;
+                    }
+                }
+            }
+            if (!handled && pointInRect(mx, my, simulateButton)) {
+                simulatePressed = true;
+            }
+        } else if (button.button == SDL_BUTTON_RIGHT) {
+            if (SlotRect* slot = findSlot(mx, my)) {
+                slot->ship->loadout.clearModule(slot->slotIndex);
+                invalidateSummary();
+                setStatus("Module removed.");
+            }
+        }
+    }
+
+    void mouseUp(const SDL_MouseButtonEvent& button) {
+        if (button.button != SDL_BUTTON_LEFT) {
+            return;
+        }
+        if (drag.active) {
+            completeDrag(button.x, button.y);
+        } else if (simulatePressed && pointInRect(button.x, button.y, simulateButton)) {
+            if (solving) {
+                setStatus("Simulation already running.");
+            } else if (!fleetReady(humanFleet) || !fleetReady(alienFleet)) {
+                setStatus("Activate at least one valid ship per fleet before simulating.");
+            } else {
+                setStatus("Simulating...");
+                startSimulation(Matchup{collectFleet(humanFleet), collectFleet(alienFleet)});
+            }
+        }
+        simulatePressed = false;
+    }
+
+    bool handleEvent(const SDL_Event& event) {
+        if (event.type != SDL_MOUSEMOTION || drag.active) {
+            redraw = true;
+        }
+        if (simulationDoneEvent != 0 && event.type == simulationDoneEvent) {
+            std::unique_ptr<SimulationResult> result(static_cast<SimulationResult*>(event.user.data1));
+            finishSimulation(*result);
+            return true;
+        }
+        if (sensitivityDoneEvent != 0 && event.type == sensitivityDoneEvent) {
+            std::unique_ptr<SensitivityResult> result(static_cast<SensitivityResult*>(event.user.data1));
+            finishSensitivity(*result);
+            return true;
+        }
+        if (matrixCellEvent != 0 && event.type == matrixCellEvent) {
+            std::unique_ptr<MatrixResult> result(static_cast<MatrixResult*>(event.user.data1));
+            if (result->job == matrixJob) {
+                storeMatrixCell(result->cell);
+            }
+            return true;
+        }
+        ensureLayout();
+        switch (event.type) {
+            case SDL_QUIT:
+                return false;
+            case SDL_KEYDOWN:
+                if (event.key.keysym.sym == SDLK_F3) {
+                    hudVisible = !hudVisible;
+                } else if (event.key.keysym.sym == SDLK_v) {
+                    valueMode = !valueMode;
+                    if (valueMode) {
+                        startSensitivity();
+                    } else {
+                        sensitivitySolver.request_stop();
+                        moduleValues.clear();
+                    }
+                } else if (event.key.keysym.sym == SDLK_m) {
+                    if (matrixMode) {
+                        matrixMode = false;
+                    } else {
+                        showMatrix();
+                    }
+                }
+                return event.key.keysym.sym != SDLK_ESCAPE;
+            case SDL_MOUSEBUTTONDOWN:
+                if (!matrixMode) {  // the matrix covers the fleets and is view-only
+                    mouseDown(event.button);
+                }
+                break;
+            case SDL_MOUSEBUTTONUP:
+                if (!matrixMode) {
+                    mouseUp(event.button);
+                }
+                break;
+            case SDL_WINDOWEVENT:
+                if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    width = event.window.data1;
+                    height = event.window.data2;
+                    layoutDirty = true;
+                }
+                break;
+            case SDL_MOUSEMOTION:
+                if (drag.active) {
+                    drag.mouseX = event.motion.x;
+                    drag.mouseY = event.motion.y;
+                }
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+
+    // Time until the status message expires or, while a solve runs with the
+    // overlay up, until the overlay is due for a repaint.
+    std::optional<Uint32> timeout() const {
+        std::optional<Uint32> wait;
+        Uint32 now = SDL_GetTicks();
+        Uint32 shown = now - statusTimer;
+        if (!statusMessage.empty() && shown < kStatusMillis) {
+            wait = kStatusMillis - shown;
+        }
+        if (hudVisible && solving) {
+            Uint32 since = now - renderTicks;
+            Uint32 refresh = since < kHudRefreshMillis ? kHudRefreshMillis - since : 0;
+            wait = wait ? std::min(*wait, refresh) : refresh;
+        }
+        return wait;
+    }
+
+    bool needsRedraw() const {
+        if (redraw) {
+            return true;
+        }
+        if (statusDrawn && SDL_GetTicks() - statusTimer >= kStatusMillis) {
+            return true;
+        }
+        return hudVisible && solving && SDL_GetTicks() - renderTicks >= kHudRefreshMillis;
+    }
+
+    void render(SDL_Renderer* renderer) {
+        auto started = std::chrono::steady_clock::now();
+        int outputWidth = 0;
+        int outputHeight = 0;
+        if (SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight) == 0 &&
+            (outputWidth != width || outputHeight != height)) {
+            width = outputWidth;
+            height = outputHeight;
+            layoutDirty = true;
+        }
+        ensureLayout();
+        redraw = false;
+
+        SDL_SetRenderDrawColor(renderer, 14, 20, 37, 255);
+        SDL_RenderClear(renderer);
+        batch.begin(renderer);
+        font.shareAtlas(batch);
+
+        renderPalette(batch, font, paletteRect, dropdownRect, moduleCategories[activeCategory].name, dropdownOpen,
+                      categoryOptions, paletteEntries,
+                      valueMode && !moduleValues.empty() ? &moduleValues : nullptr);
+
+        if (matrixMode) {
+            SDL_Rect matrixArea{humanArea.x, humanArea.y, humanArea.w, alienArea.y + alienArea.h - humanArea.y};
+            renderMatrix(batch, font, matrixArea, matrixEntries, matrixCells, matrixSolved);
+        } else {
+            for (size_t i = 0; i < humanFleet.size() && i < layout.humanCards.size(); ++i) {
+                renderShipCard(batch, font, humanFleet[i], layout.humanCards[i], true);
+            }
+            for (size_t i = 0; i < alienFleet.size() && i < layout.alienCards.size(); ++i) {
+                renderShipCard(batch, font, alienFleet[i], layout.alienCards[i], false);
+            }
+        }
+
+        SDL_Color buttonColor = simulatePressed || solving ? colorFromHex(0xFF9F1C) : colorFromHex(0x2EC4B6);
+        drawPanel(batch, simulateButton, buttonColor, colorFromHex(0x011627));
+        font.drawText(batch, "SIMULATE BATTLE", simulateButton.x + 20, simulateButton.y + 10,
+                      colorFromHex(0x011627), 1);
+
+        if (summaryReady) {
+            std::ostringstream lines;
+            lines.precision(1);
+            lines << std::fixed;
+            lines << "HUMAN WIN " << summary.humanWin * 100.0 << "%\n";
+            lines << "ALIEN WIN " << summary.alienWin * 100.0 << "%\n";
+            lines << "DRAW " << summary.draw * 100.0 << "%\n";
+            lines << "EXP ROUNDS " << summary.expectedRounds;
+            font.drawText(batch, lines.str(), paletteRect.x + 10, paletteRect.y + paletteRect.h - 180,
+                          colorFromHex(0xF1FAEE), 1);
+        }
+
+        statusDrawn = !statusMessage.empty() && SDL_GetTicks() - statusTimer < kStatusMillis;
+        if (statusDrawn) {
+            font.drawText(batch, statusMessage, paletteRect.x + 10, paletteRect.y + paletteRect.h - 24,
+                          colorFromHex(0xFF5964), 1);
+        }
+
+        renderDragGhost(batch, font, drag);
+
+        if (hudVisible) {
+            renderHud(batch, font, width, frameTimes, drawCalls, simulator.progress(), *sharedCache, storeSize);
+        }
+
+        batch.flush();
+        drawCalls = batch.drawCalls();
+        renderTicks = SDL_GetTicks();
+        frameTimes.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+    }
+};
+
+FleetBuilder::FleetBuilder(FleetBuilderOptions options) : impl_(std::make_unique<Impl>(std::move(options))) {}
+
+FleetBuilder::~FleetBuilder() = default;
+
+bool FleetBuilder::handleEvent(const SDL_Event& event) {
+    return impl_->handleEvent(event);
+}
+
+bool FleetBuilder::needsRedraw() const {
+    return impl_->needsRedraw();
+}
+
+std::optional<Uint32> FleetBuilder::millisUntilTimeout() const {
+    return impl_->timeout();
+}
+
+void FleetBuilder::render(SDL_Renderer* renderer) {
+    impl_->render(renderer);
+}
+
+int FleetBuilder::lastDrawCalls() const {
+    return impl_->drawCalls;
+}
+
+void FleetBuilder::setHudVisible(bool visible) {
+    impl_->hudVisible = visible;
+    impl_->redraw = true;
+}
+
+bool FleetBuilder::hudVisible() const {
+    return impl_->hudVisible;
+}
+
+bool FleetBuilder::solving() const {
+    return impl_->solving;
+}
+
+bool FleetBuilder::summaryReady() const {
+    return impl_->summaryReady;
+}
+
+std::size_t FleetBuilder::paletteSize() const {
+    return impl_->paletteEntries.size();
+}
+
+std::size_t FleetBuilder::categoryCount() const {
+    return impl_->categoryOptions.size();
+}
+
+std::size_t FleetBuilder::slotCount(FleetSide side, std::size_t ship) const {
+    const std::vector<FleetShip>& fleet = impl_->fleet(side);
+    return ship < fleet.size() ? fleet[ship].loadout.slotCount() : 0;
+}
+
+std::optional<SDL_Point> FleetBuilder::paletteCenter(std::size_t index) const {
+    if (index >= impl_->paletteEntries.size()) {
+        return std::nullopt;
+    }
+    return rectCenter(impl_->paletteEntries[index].rect);
+}
+
+std::optional<SDL_Point> FleetBuilder::categoryCenter(std::size_t index) const {
+    if (index >= impl_->categoryOptions.size()) {
+        return std::nullopt;
+    }
+    return rectCenter(impl_->categoryOptions[index].rect);
+}
+
+std::optional<SDL_Point> FleetBuilder::slotCenter(FleetSide side, std::size_t ship, std::size_t slot) const {
+    const std::vector<SDL_Rect>& cards = impl_->cards(side);
+    if (ship >= cards.size() || slot >= slotCount(side, ship)) {
+        return std::nullopt;
+    }
+    return rectCenter(slotRectInCard(cards[ship], slot));
+}
+
+std::optional<SDL_Point> FleetBuilder::arrowCenter(FleetSide side, std::size_t ship, int delta) const {
+    const std::vector<SDL_Rect>& cards = impl_->cards(side);
+    if (ship >= cards.size()) {
+        return std::nullopt;
+    }
+    auto [previous, next] = arrowRectsForCard(cards[ship]);
+    return rectCenter(delta < 0 ? previous : next);
+}
+
+std::optional<SDL_Point> FleetBuilder::toggleCenter(FleetSide side, std::size_t ship) const {
+    const std::vector<SDL_Rect>& cards = impl_->cards(side);
+    if (ship >= cards.size()) {
+        return std::nullopt;
+    }
+    return rectCenter(toggleRectForCard(cards[ship]));
+}
+
+SDL_Point FleetBuilder::dropdownCenter() const {
+    return rectCenter(impl_->dropdownRect);
+}
+
+SDL_Point FleetBuilder::simulateCenter() const {
+    return rectCenter(impl_->simulateButton);
+}
+
+}  // namespace eclipse
@@ -1,24 +1,582 @@
 #include "game/battle_simulator.hpp"
+#include "game/catalog_source.hpp"
+#include "game/fleet_codec.hpp"
+#include "game/matchup_matrix.hpp"
+#include "game/slot_sensitivity.hpp"
+#include "game/solution_store.hpp"
+#include "game/solve_cache.hpp"
 #include "game/tech_catalog.hpp"
+#include "game/workload_log.hpp"
+#include "server/protocol.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <map>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <sstream>
+#include <stop_token>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 using namespace eclipse;
 
 namespace {
-const ShipDesign* findDesign(std::string_view id) {
-    for (const ShipDesign& design : TechCatalog::shipDesigns()) {
-        if (design.id == id) {
-            return &design;
+std::string catalogText(const CatalogView& catalog) {
+    std::ostringstream out;
+    writeCatalogText(catalog, out);
+    return out.str();
+}
+
+void catalogSourcesMatchBuiltin() {
+    const std::string builtin = catalogText(TechCatalog::view());
+
+    auto text = CatalogSource::loadFile(std::string(ECLIPSE_DATA_DIR) + "/base_catalog.txt");
+    assert(catalogText(text->view()) == builtin);
+
+    const std::string binaryPath = "battle_sim_tests_catalog.bin";
+    writeCatalogBinary(text->view(), binaryPath);
+    TechCatalog::loadFromFile(binaryPath);
+    assert(catalogText(TechCatalog::view()) == builtin);
+    const ShipDesign* orion = TechCatalog::findDesign("ORI_INT");
+    assert(orion && orion->slots[3].preprint == TechCatalog::findModule("ORION_SHIELD_MALUS"));
+    TechCatalog::useBuiltin();
+    std::remove(binaryPath.c_str());
+
+    bool rejected = false;
+    try {
+        CatalogSource::parseText("design BAD\n  slot weapon NOT_A_MODULE\n");
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+void mirrorMatchIsSymmetric() {
+    const ShipDesign* cruiser = TechCatalog::findDesign("HUM_CRU");
+    std::vector<ShipLoadout> fleet{ShipLoadout(cruiser), ShipLoadout(cruiser), ShipLoadout(cruiser)};
+    BattleSummary summary = BattleSimulator().simulate(fleet, fleet);
+    assert(std::fabs(summary.humanWin - summary.alienWin) < 1e-12);
+    assert(std::fabs(summary.humanWin + summary.alienWin + summary.draw - 1.0) < 1e-9);
+}
+
+void solutionStoreRoundTrip() {
+    const std::string storePath = "battle_sim_tests_store.bin";
+    std::remove(storePath.c_str());
+    const ShipDesign* cruiser = TechCatalog::findDesign("HUM_CRU");
+    const ShipDesign* orion = TechCatalog::findDesign("ORI_CRU");
+    std::vector<ShipLoadout> humans{ShipLoadout(cruiser), ShipLoadout(cruiser)};
+    std::vector<ShipLoadout> aliens{ShipLoadout(orion), ShipLoadout(orion)};
+    BattleSummary fresh = BattleSimulator().simulate(humans, aliens);
+
+    std::size_t solved = 0;
+    {
+        auto store = SolutionStore::open(storePath);
+        BattleSummary first = BattleSimulator(store).simulate(humans, aliens);
+        assert(first.humanWin == fresh.humanWin && first.expectedRounds == fresh.expectedRounds);
+        solved = store->size();
+        assert(solved > 0);
+    }
+    {
+        auto store = SolutionStore::open(storePath);
+        assert(store->size() == solved);
+        BattleSummary reloaded = BattleSimulator(store).simulate(humans, aliens);
+        assert(reloaded.humanWin == fresh.humanWin && reloaded.draw == fresh.draw);
+        assert(store->size() == solved);
+        store->compact();
+        assert(store->size() == solved);
+        BattleSummary compacted = BattleSimulator(store).simulate(humans, aliens);
+        assert(compacted.alienWin == fresh.alienWin);
+    }
+    std::remove(storePath.c_str());
+
+    // A store grown only by flushes, as the GUI grows one, never holds more than
+    // the tail limit in memory: opening folds an oversized tail into the sorted
+    // run, and so does the flush that pushes the tail past the limit.
+    {
+        auto store = std::make_shared<SolutionStore>(storePath, solved);
+        BattleSimulator(store).simulate(humans, aliens);
+        assert(store->tailSize() == solved);
+    }
+    {
+        auto store = std::make_shared<SolutionStore>(storePath, 4);
+        assert(store->size() == solved && store->tailSize() == 0);
+        BattleSimulator simulator(store);
+        BattleSummary mapped = simulator.simulate(humans, aliens);
+        assert(mapped.humanWin == fresh.humanWin && simulator.lastStats().storeHits == 1);
+        std::vector<ShipLoadout> more{ShipLoadout(cruiser), ShipLoadout(cruiser), ShipLoadout(cruiser)};
+        simulator.simulate(more, aliens);
+        assert(store->size() > solved + 4 && store->tailSize() <= 4);
+        assert(simulator.simulate(more, aliens).humanWin == BattleSimulator().simulate(more, aliens).humanWin);
+    }
+    std::remove(storePath.c_str());
+}
+
+void cancelledSimulationThrows() {
+    std::stop_source stop;
+    stop.request_stop();
+    const ShipDesign* cruiser = TechCatalog::findDesign("HUM_CRU");
+    bool cancelled = false;
+    try {
+        BattleSimulator().simulate({ShipLoadout(cruiser)}, {ShipLoadout(cruiser)}, stop.get_token());
+    } catch (const SimulationCancelled&) {
+        cancelled = true;
+    }
+    assert(cancelled);
+}
+
+void progressMirrorsLastStats() {
+    const ShipDesign* cruiser = TechCatalog::findDesign("HUM_CRU");
+    std::vector<ShipLoadout> fleet{ShipLoadout(cruiser), ShipLoadout(cruiser)};
+    BattleSimulator simulator;
+    simulator.simulate(fleet, fleet);
+    const SolveProgress& progress = simulator.progress();
+    assert(!progress.solving.load());
+    assert(progress.completedSolves.load() == 1);
+    assert(progress.statesExpanded.load() == simulator.lastStats().statesExpanded);
+    assert(progress.memoHits.load() == simulator.lastStats().memoHits);
+    assert(progress.memoBytes.load() > 0);
+
+    std::stop_source stop;
+    stop.request_stop();
+    try {
+        simulator.simulate(fleet, {ShipLoadout(cruiser)}, stop.get_token());
+    } catch (const SimulationCancelled&) {
+    }
+    assert(!progress.solving.load());
+    assert(progress.completedSolves.load() == 1);
+}
+
+void matrixMatchesSingleSolves() {
+    std::vector<MatrixEntry> entries{{"a", parseFleet("HUM_CRU HUM_INT")},
+                                     {"b", parseFleet("ORI_CRU ORI_INT")},
+                                     {"c", parseFleet("ERI_CRU")}};
+    MatrixOptions options;
+    options.threads = 3;
+    std::vector<MatrixCell> cells(entries.size() * entries.size());
+    std::vector<int> seen(cells.size(), 0);
+    std::mutex mutex;
+    std::size_t solved = solveMatrix(entries, options, [&](const MatrixCell& cell) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cells[cell.row * entries.size() + cell.column] = cell;
+        ++seen[cell.row * entries.size() + cell.column];
+    });
+    assert(solved == cells.size());
+    for (std::size_t row = 0; row < entries.size(); ++row) {
+        for (std::size_t column = 0; column < entries.size(); ++column) {
+            const MatrixCell& cell = cells[row * entries.size() + column];
+            assert(seen[row * entries.size() + column] == 1);
+            BattleSummary alone = BattleSimulator().simulate(entries[row].fleet, entries[column].fleet);
+            assert(std::abs(cell.summary.humanWin - alone.humanWin) < 1e-12);
+            assert(std::abs(cell.summary.alienWin - alone.alienWin) < 1e-12);
+        }
+    }
+
+    std::stop_source stop;
+    stop.request_stop();
+    assert(solveMatrix(entries, options, [](const MatrixCell&) { assert(false); }, stop.get_token()) == 0);
+
+    bool rethrown = false;
+    try {
+        solveMatrix(entries, options, [](const MatrixCell&) { throw std::runtime_error("cell sink failed"); });
+    } catch (const std::runtime_error& error) {
+        rethrown = std::string(error.what()) == "cell sink failed";
+    }
+    assert(rethrown);
+    assert(factionDesignEntries().size() == 16);
+}
+
+void sensitivityRanksSingleSlotChanges() {
+    std::vector<ShipLoadout> humans = parseFleet("HUM_INT HUM_INT");
+    std::vector<ShipLoadout> aliens = parseFleet("ORI_CRU");
+    SensitivityOptions options;
+    options.threads = 2;
+    SensitivityReport report = slotSensitivity(humans, aliens, options);
+
+    BattleSummary baseline = BattleSimulator().simulate(humans, aliens);
+    assert(std::abs(report.baseline.humanWin - baseline.humanWin) < 1e-12);
+    assert(!report.changes.empty());
+    // The same edit to either interceptor is one battle, and so are edits that
+    // leave the combat stats alone.
+    assert(report.solved * 2 <= report.changes.size());
+    for (std::size_t i = 0; i < report.changes.size(); ++i) {
+        const SlotChange& change = report.changes[i];
+        assert(i == 0 || report.changes[i - 1].delta >= change.delta);
+        assert(change.after && change.after != humans[change.ship].activeModuleAt(change.slot));
+        assert(!change.after->blueprintOnly);
+        std::vector<ShipLoadout> variant = humans;
+        variant[change.ship].setModule(change.slot, change.after);
+        assert(variant[change.ship].isValid());
+        if (i % 7 == 0) {
+            BattleSummary alone = BattleSimulator().simulate(variant, aliens);
+            assert(std::abs(change.summary.humanWin - alone.humanWin) < 1e-12);
+            assert(std::abs(change.delta - (alone.humanWin - baseline.humanWin)) < 1e-12);
+        }
+    }
+
+    std::stop_source stop;
+    stop.request_stop();
+    bool cancelled = false;
+    try {
+        slotSensitivity(humans, aliens, options, stop.get_token());
+    } catch (const SimulationCancelled&) {
+        cancelled = true;
+    }
+    assert(cancelled);
+}
+
+void midBattlePositionsComeFromTheCache() {
+    std::vector<ShipLoadout> humans = parseFleet("HUM_CRU HUM_INT");
+    std::vector<ShipLoadout> aliens = parseFleet("ORI_CRU");
+    BattleSimulator simulator;
+    simulator.setSharedCache(std::make_shared<SolveCache>());
+    BattleSummary full = simulator.simulate(humans, aliens);
+
+    BattlePosition start{humans, aliens, {}, {}, false};
+    BattleSummary again = simulator.simulateFrom(start);
+    assert(std::abs(again.humanWin - full.humanWin) < 1e-12);
+    assert(simulator.lastStats().statesExpanded == 0);
+
+    // Hits go to the smallest ship first, so losing the interceptor in the first
+    // round was passed through above and is a lookup.
+    BattlePosition damaged{humans, aliens, {ShipStatus{}, ShipStatus{0, false}}, {}, true};
+    BattleSummary fromCache = simulator.simulateFrom(damaged);
+    assert(simulator.lastStats().statesExpanded == 0);
+    assert(simulator.lastStats().sharedHits == 1);
+    BattleSummary fresh = BattleSimulator().simulateFrom(damaged);
+    assert(std::abs(fromCache.humanWin - fresh.humanWin) < 1e-12);
+    assert(std::abs(fromCache.expectedRounds - fresh.expectedRounds) < 1e-12);
+    assert(BattleSimulator::positionKey(damaged) != BattleSimulator::positionKey(start));
+
+    // Destroyed ships drop out, and an overstated hull is capped.
+    int cruiserHull = std::max(1, humans[0].derivedStats().hull);
+    BattlePosition cruiserOnly{{humans[0]}, aliens, {ShipStatus{cruiserHull + 5, false}}, {}, true};
+    assert(BattleSimulator::positionKey(damaged) == BattleSimulator::positionKey(cruiserOnly));
+    BattlePosition scratched{humans, aliens, {ShipStatus{cruiserHull - 1, false}}, {}, true};
+    assert(BattleSimulator::positionKey(scratched) != BattleSimulator::positionKey(damaged));
+    BattlePosition humansLost{humans, aliens, {ShipStatus{0, false}, ShipStatus{-2, false}}, {}, true};
+    assert(BattleSimulator().simulateFrom(humansLost).alienWin == 1.0);
+}
+
+// Human win chance by expanding round() to the end, as the solver does: a round
+// that leaves the state unchanged is repeated until something happens.
+double humanWinByRounds(RoundTransitions& transitions, StateHandle state, std::map<StateHandle, double>& memo) {
+    switch (transitions.outcome(state)) {
+    case BattleOutcome::HumansWin:
+        return 1.0;
+    case BattleOutcome::AliensWin:
+    case BattleOutcome::Draw:
+        return 0.0;
+    case BattleOutcome::Fighting:
+        break;
+    }
+    if (auto it = memo.find(state); it != memo.end()) {
+        return it->second;
+    }
+    double stay = 0.0;
+    double win = 0.0;
+    for (const Transition& next : transitions.round(state)) {
+        if (next.state == state) {
+            stay += next.probability;
+        } else {
+            win += next.probability * humanWinByRounds(transitions, next.state, memo);
+        }
+    }
+    double result = stay < 1.0 ? win / (1.0 - stay) : 0.0;
+    memo[state] = result;
+    return result;
+}
+
+void roundTransitionsReproduceTheSolver() {
+    Matchup matchup = parseMatchup("HUM_INT[3=ANCIENT_MISSILE] HUM_CRU vs ORI_INT ORI_INT");
+    BattlePosition start{matchup.humans, matchup.aliens, {}, {}, false};
+    RoundTransitions transitions;
+    StateHandle root = transitions.intern(start);
+    assert(transitions.intern(start) == root);
+    assert(transitions.key(root) == BattleSimulator::positionKey(start));
+    assert(!transitions.missilesResolved(root));
+
+    std::span<const Transition> first = transitions.round(root);
+    double total = 0.0;
+    for (std::size_t i = 0; i < first.size(); ++i) {
+        total += first[i].probability;
+        assert(i == 0 || first[i - 1].probability >= first[i].probability);
+        assert(transitions.missilesResolved(first[i].state));
+    }
+    assert(std::abs(total - 1.0) < 1e-12);
+
+    std::map<StateHandle, double> memo;
+    double win = humanWinByRounds(transitions, root, memo);
+    assert(std::abs(win - BattleSimulator().simulate(matchup.humans, matchup.aliens).humanWin) < 1e-9);
+
+    // The second pass is answered from the per-state cache.
+    std::size_t interned = transitions.size();
+    assert(transitions.round(root).data() == first.data());
+    memo.clear();
+    assert(humanWinByRounds(transitions, root, memo) == win);
+    assert(transitions.size() == interned);
+
+    // Firing each initiative bucket in turn composes to the full round.
+    StateHandle fighting = first.front().state;
+    std::map<StateHandle, double> composed{{fighting, 1.0}};
+    std::vector<int> initiatives(transitions.initiatives(fighting).begin(), transitions.initiatives(fighting).end());
+    assert(initiatives.size() > 1);
+    for (int initiative : initiatives) {
+        std::map<StateHandle, double> next;
+        for (const auto& [state, probability] : composed) {
+            for (const Transition& step : transitions.volley(state, initiative)) {
+                next[step.state] += probability * step.probability;
+            }
+        }
+        composed = std::move(next);
+    }
+    std::span<const Transition> round = transitions.round(fighting);
+    assert(composed.size() == round.size());
+    for (const Transition& next : round) {
+        assert(std::abs(composed[next.state] - next.probability) < 1e-12);
+    }
+
+    bool rejected = false;
+    try {
+        transitions.round(static_cast<StateHandle>(transitions.size()));
+    } catch (const std::out_of_range&) {
+        rejected = true;
+    }
+    assert(rejected);
+    transitions.clear();
+    assert(transitions.size() == 0);
+}
+
+void protocolRoundTrip() {
+    ShipLoadout ship(TechCatalog::findDesign("HUM_INT"));
+    ship.setModule(3, TechCatalog::findModule("ANCIENT_MISSILE"));
+    std::vector<ShipLoadout> fleet{ship, ShipLoadout(TechCatalog::findDesign("HUM_CRU"))};
+    std::string line = protocol::formatSolveRequest("7", 250, fleet, {ShipLoadout(TechCatalog::findDesign("ORI_INT"))});
+
+    protocol::Request request;
+    protocol::parseRequest(line, request);
+    assert(request.id == "7" && request.deadlineMs == 250);
+    assert(request.humans.size() == 2 && request.aliens.size() == 1);
+    assert(TechCatalog::signature(request.humans[0]) == TechCatalog::signature(ship));
+    assert(BattleSimulator::matchupKey(request.humans, request.aliens) ==
+           BattleSimulator::matchupKey(fleet, {ShipLoadout(TechCatalog::findDesign("ORI_INT"))}));
+
+    bool rejected = false;
+    try {
+        protocol::parseRequest("8 solve 0 HUM_INT[9=PLASMA_CANNON] vs ORI_INT", request);
+    } catch (const std::runtime_error&) {
+        rejected = request.id == "8";
+    }
+    assert(rejected);
+}
+
+void fleetCodecRoundTrip() {
+    ShipLoadout ship(TechCatalog::findDesign("HUM_INT"));
+    ship.setModule(3, TechCatalog::findModule("ANCIENT_MISSILE"));
+    std::vector<Matchup> matchups{
+        {{ship, ShipLoadout(TechCatalog::findDesign("HUM_CRU"))}, {ShipLoadout(TechCatalog::findDesign("ORI_INT"))}},
+        {{ShipLoadout(TechCatalog::findDesign("ERI_DRE"))}, {ship, ship}},
+    };
+    auto sameMatchup = [](const Matchup& a, const Matchup& b) {
+        return BattleSimulator::matchupKey(a.humans, a.aliens) == BattleSimulator::matchupKey(b.humans, b.aliens) &&
+               TechCatalog::signature(a.humans[0]) == TechCatalog::signature(b.humans[0]);
+    };
+
+    std::ostringstream text;
+    writeMatchupsText(text, matchups);
+    std::vector<Matchup> parsed = parseMatchupsText("# saved fleets\n" + text.str());
+    assert(parsed.size() == 2 && sameMatchup(parsed[0], matchups[0]) && sameMatchup(parsed[1], matchups[1]));
+    assert(formatLoadout(ship) == "HUM_INT[3=ANCIENT_MISSILE]");
+
+    std::vector<std::byte> bytes = encodeMatchups(matchups);
+    MatchupArchive archive(bytes);
+    assert(archive.size() == 2);
+    MatchupView first = *archive.begin();
+    assert(first.humans().size() == 2 && first.aliens().size() == 1);
+    LoadoutView view = *first.humans().begin();
+    assert(view.design() == TechCatalog::designId("HUM_INT") && view.module(3) == TechCatalog::moduleId("ANCIENT_MISSILE"));
+    std::vector<Matchup> decoded = archive.toMatchups();
+    assert(sameMatchup(decoded[0], matchups[0]) && sameMatchup(decoded[1], matchups[1]));
+
+    bool rejected = false;
+    try {
+        MatchupArchive truncated(std::span<const std::byte>(bytes).first(bytes.size() - 1));
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+}
+
+void workloadEntryRoundTrip() {
+    WorkloadEntry entry;
+    entry.matchup = parseMatchup("HUM_INT[3=ANCIENT_MISSILE] HUM_CRU vs ORI_INT");
+    BattleSimulator simulator;
+    entry.summary = simulator.simulate(entry.matchup.humans, entry.matchup.aliens);
+    entry.stats = simulator.lastStats();
+    entry.milliseconds = 1.5;
+    assert(entry.stats.statesExpanded > 0 && entry.stats.transitions >= entry.stats.statesExpanded);
+
+    WorkloadEntry parsed = parseWorkloadEntry(formatWorkloadEntry(entry));
+    assert(parsed.summary.humanWin == entry.summary.humanWin);
+    assert(parsed.summary.expectedRounds == entry.summary.expectedRounds);
+    assert(parsed.stats.statesExpanded == entry.stats.statesExpanded && parsed.stats.memoHits == entry.stats.memoHits);
+    assert(formatMatchup(parsed.matchup) == formatMatchup(entry.matchup));
+    assert(parsed.outcome == WorkloadOutcome::Ok);
+
+    entry.outcome = WorkloadOutcome::Cancelled;
+    std::string line = formatWorkloadEntry(entry);
+    assert(line.rfind("cancelled ", 0) == 0);
+    assert(parseWorkloadEntry(line).outcome == WorkloadOutcome::Cancelled);
+    WorkloadEntry legacy = parseWorkloadEntry(line.substr(line.find(' ') + 1), 1);
+    assert(legacy.outcome == WorkloadOutcome::Ok && legacy.stats.statesExpanded == entry.stats.statesExpanded);
+}
+
+void samplingAgreesWithExactSolver() {
+    for (const char* text : {"HUM_INT[3=ANCIENT_MISSILE] HUM_CRU vs ORI_INT ORI_INT", "ERI_CRU vs PLA_STA"}) {
+        Matchup matchup = parseMatchup(text);
+        BattleSummary exact = BattleSimulator().simulate(matchup.humans, matchup.aliens);
+        SampledSummary sampled = BattleSimulator::sample(matchup.humans, matchup.aliens, 20000, 42);
+        double n = static_cast<double>(sampled.trials);
+        auto close = [&](double p, double estimate) {
+            return std::abs(estimate - p) <= 5.0 * std::sqrt(p * (1.0 - p) / n) + 1e-12;
+        };
+        assert(close(exact.humanWin, sampled.estimate.humanWin));
+        assert(close(exact.alienWin, sampled.estimate.alienWin));
+        assert(std::abs(exact.expectedRounds - sampled.estimate.expectedRounds) <=
+               5.0 * std::sqrt(sampled.roundsVariance / n));
+    }
+}
+
+void horizonConvergesToFullSolve() {
+    Matchup matchup = parseMatchup("HUM_INT[3=ANCIENT_MISSILE] HUM_CRU vs ORI_INT ORI_INT");
+    BattleSimulator simulator;
+    BattleSummary full = simulator.simulate(matchup.humans, matchup.aliens);
+
+    HorizonSummary none = simulator.simulateRounds(matchup.humans, matchup.aliens, 0);
+    assert(none.expectedRounds == 0.0 && none.stillFighting > 0.0);
+
+    double previousWin = 0.0;
+    for (int rounds : {1, 2, 3, 10}) {
+        HorizonSummary horizon = simulator.simulateRounds(matchup.humans, matchup.aliens, rounds);
+        assert(std::abs(horizon.humanWin + horizon.alienWin + horizon.draw + horizon.stillFighting - 1.0) < 1e-12);
+        assert(horizon.humanWin >= previousWin && horizon.expectedRounds <= rounds);
+        previousWin = horizon.humanWin;
+    }
+
+    HorizonSummary longRun = simulator.simulateRounds(matchup.humans, matchup.aliens, 200);
+    assert(longRun.stillFighting < 1e-12);
+    assert(std::abs(longRun.humanWin - full.humanWin) < 1e-9);
+    assert(std::abs(longRun.expectedRounds - full.expectedRounds) < 1e-9);
+}
+
+void retreatPoliciesBehave() {
+    Matchup matchup = parseMatchup("HUM_INT HUM_CRU vs ORI_CRU ORI_INT");
+    BattleSimulator simulator;
+    BattleSummary plain = simulator.simulate(matchup.humans, matchup.aliens);
+
+    RetreatSummary never = simulator.simulate(matchup.humans, matchup.aliens, RetreatPolicy{}, RetreatPolicy{});
+    assert(never.humanWin == plain.humanWin && never.alienWin == plain.alienWin);
+    assert(never.humanRetreat == 0.0 && never.alienRetreat == 0.0);
+
+    auto humanValue = [](const RetreatSummary& summary, const RetreatPolicy& policy) {
+        return summary.humanWin + summary.alienRetreat + policy.escapeValue * summary.humanRetreat;
+    };
+    RetreatPolicy threshold{RetreatRule::Threshold, 0.4, 0.5};
+    RetreatPolicy optimal{RetreatRule::Optimal, 0.4, 0.5};
+    RetreatSummary byThreshold = simulator.simulate(matchup.humans, matchup.aliens, threshold, RetreatPolicy{});
+    RetreatSummary byOptimal = simulator.simulate(matchup.humans, matchup.aliens, optimal, RetreatPolicy{});
+    for (const RetreatSummary& summary : {byThreshold, byOptimal}) {
+        assert(std::abs(summary.humanWin + summary.alienWin + summary.draw + summary.humanRetreat +
+                        summary.alienRetreat - 1.0) < 1e-12);
+    }
+    assert(humanValue(byOptimal, optimal) >= humanValue(never, optimal) - 1e-12);
+    assert(humanValue(byOptimal, optimal) >= humanValue(byThreshold, threshold) - 1e-12);
+
+    // Starbases have no drives, so a fleet with one holds its ground.
+    Matchup outgunned = parseMatchup("HUM_CRU HUM_CRU vs ORI_CRU PLA_STA");
+    RetreatSummary held = simulator.simulate(outgunned.humans, outgunned.aliens, RetreatPolicy{}, optimal);
+    assert(held.alienRetreat == 0.0);
+
+    // Optimal values go through the shared cache keyed by both policies: a second
+    // simulator gets the whole answer from it, and other policies do not collide.
+    auto cache = std::make_shared<SolveCache>();
+    BattleSimulator first;
+    first.setSharedCache(cache);
+    RetreatSummary cold = first.simulate(matchup.humans, matchup.aliens, optimal, optimal);
+    BattleSimulator second;
+    second.setSharedCache(cache);
+    RetreatSummary warm = second.simulate(matchup.humans, matchup.aliens, optimal, optimal);
+    assert(second.lastStats().sharedHits >= 1 && second.lastStats().statesExpanded == 0);
+    assert(warm.humanWin == cold.humanWin && warm.humanRetreat == cold.humanRetreat &&
+           warm.alienRetreat == cold.alienRetreat && warm.expectedRounds == cold.expectedRounds);
+    RetreatSummary uncached = BattleSimulator().simulate(matchup.humans, matchup.aliens, optimal, optimal);
+    assert(std::abs(uncached.humanWin - cold.humanWin) < 1e-12);
+    RetreatPolicy eager{RetreatRule::Optimal, 0.4, 0.9};
+    RetreatSummary other = second.simulate(matchup.humans, matchup.aliens, eager, optimal);
+    assert(second.lastStats().statesExpanded > 0);
+    RetreatSummary otherAlone = BattleSimulator().simulate(matchup.humans, matchup.aliens, eager, optimal);
+    assert(std::abs(other.humanRetreat - otherAlone.humanRetreat) < 1e-12);
+}
+
+void multiSideBattlesAddUp() {
+    Matchup matchup = parseMatchup("HUM_INT HUM_CRU vs ORI_CRU ORI_INT");
+    BattleSimulator simulator;
+    BattleSummary plain = simulator.simulate(matchup.humans, matchup.aliens);
+
+    MultiBattleSummary pair = simulator.simulate({{matchup.humans}, {matchup.aliens}});
+    assert(pair.win.size() == 2 && pair.win[0] == plain.humanWin && pair.win[1] == plain.alienWin);
+
+    // A fleet with no valid ships drops out before the first volley.
+    MultiBattleSummary withEmpty = simulator.simulate({{matchup.humans}, {parseFleet("ERI_DRE")}, {matchup.aliens}});
+    assert(withEmpty.win[1] == 0.0);
+    assert(std::abs(withEmpty.win[0] - plain.humanWin) < 1e-12 && std::abs(withEmpty.win[2] - plain.alienWin) < 1e-12);
+
+    for (TargetRule rule : {TargetRule::Threat, TargetRule::Weakest}) {
+        MultiBattleSummary threeWay = simulator.simulate(
+            {{matchup.humans, rule}, {parseFleet("ERI_CRU ERI_INT[3=ANCIENT_MISSILE]"), rule}, {matchup.aliens, rule}});
+        double total = threeWay.draw;
+        for (double win : threeWay.win) {
+            assert(win > 0.0 && win < 1.0);
+            total += win;
         }
+        assert(std::abs(total - 1.0) < 1e-12);
+        assert(threeWay.expectedRounds >= 1.0);
     }
-    return nullptr;
 }
+
+void perTargetShieldsMatchSampling() {
+    Matchup uniform = parseMatchup("HUM_CRU HUM_INT vs ORI_CRU ORI_INT");
+    BattleSimulator averaged;
+    BattleSimulator perTarget;
+    perTarget.setShieldModel(ShieldModel::PerTarget);
+    BattleSummary uniformAveraged = averaged.simulate(uniform.humans, uniform.aliens);
+    BattleSummary uniformPerTarget = perTarget.simulate(uniform.humans, uniform.aliens);
+    assert(std::abs(uniformAveraged.humanWin - uniformPerTarget.humanWin) < 1e-12);
+
+    // Two shielded interceptors next to an unshielded cruiser: averaging the
+    // shield across the fleet misstates which hits can land.
+    Matchup mixed = parseMatchup("HUM_CRU HUM_INT[3=GAUSS_SHIELD] HUM_INT[3=GAUSS_SHIELD] vs ORI_CRU ORI_CRU ORI_INT");
+    BattleSummary exact = perTarget.simulate(mixed.humans, mixed.aliens);
+    BattleSummary approximate = averaged.simulate(mixed.humans, mixed.aliens);
+    assert(std::abs(exact.humanWin + exact.alienWin + exact.draw - 1.0) < 1e-9);
+    assert(std::abs(exact.humanWin - approximate.humanWin) > 0.01);
+    assert(BattleSimulator::matchupKey(mixed.humans, mixed.aliens) !=
+           BattleSimulator::matchupKey(mixed.humans, mixed.aliens, ShieldModel::PerTarget));
+
+    SampledSummary sampled = BattleSimulator::sample(mixed.humans, mixed.aliens, 20000, 7, ShieldModel::PerTarget);
+    double n = static_cast<double>(sampled.trials);
+    assert(std::abs(sampled.estimate.humanWin - exact.humanWin) <=
+           5.0 * std::sqrt(exact.humanWin * (1.0 - exact.humanWin) / n));
 }
 
+}  // namespace
+
 int main() {
-    const ShipDesign* interceptor = findDesign("HUM_INT");
+    const ShipDesign* interceptor = TechCatalog::findDesign("HUM_INT");
     assert(interceptor && "human interceptor design must exist");
     const ModuleSpec* drive = TechCatalog::findModule("NUCLEAR_DRIVE");
     const ModuleSpec* missile = TechCatalog::findModule("ANCIENT_MISSILE");
@@ -29,6 +587,16 @@ int main() {
 
     ShipLoadout vanillaShip(interceptor);
 
+    ModuleId missileId = TechCatalog::moduleId("ANCIENT_MISSILE");
+    assert(TechCatalog::module(missileId) == missile);
+    assert(TechCatalog::moduleId(missile) == missileId);
+    assert(TechCatalog::findModule("NOT_A_MODULE") == nullptr);
+    assert(TechCatalog::factionDesigns(Faction::Orion).size() == 4);
+    LoadoutSignature signature = TechCatalog::signature(missileShip);
+    assert(signature.design == TechCatalog::designId(interceptor));
+    assert(signature.modules[3] == missileId);
+    assert(TechCatalog::signature(TechCatalog::loadout(signature)) == signature);
+
     BattleSimulator simulator;
     BattleSummary summary = simulator.simulate({missileShip}, {vanillaShip});
 
@@ -36,5 +604,23 @@ int main() {
     assert(summary.humanWin > 0.5);
     assert(summary.draw >= 0.0);
 
+    mirrorMatchIsSymmetric();
+    solutionStoreRoundTrip();
+    cancelledSimulationThrows();
+    progressMirrorsLastStats();
+    matrixMatchesSingleSolves();
+    sensitivityRanksSingleSlotChanges();
+    midBattlePositionsComeFromTheCache();
+    roundTransitionsReproduceTheSolver();
+    protocolRoundTrip();
+    fleetCodecRoundTrip();
+    workloadEntryRoundTrip();
+    samplingAgreesWithExactSolver();
+    horizonConvergesToFullSolve();
+    retreatPoliciesBehave();
+    multiSideBattlesAddUp();
+    perTargetShieldsMatchSampling();
+    catalogSourcesMatchBuiltin();
+
     return 0;
 }
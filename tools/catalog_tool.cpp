@@ -0,0 +1,49 @@
+// Converts tech catalogs between the text and compiled binary formats.
+//
+//   eclipse_catalog text   <input|builtin> <output.txt>
+//   eclipse_catalog binary <input|builtin> <output.bin>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "game/catalog_source.hpp"
+#include "game/tech_catalog.hpp"
+
+using namespace eclipse;
+
+int main(int argc, char** argv) {
+    if (argc != 4) {
+        std::cerr << "usage: " << argv[0] << " <text|binary> <input|builtin> <output>\n";
+        return 2;
+    }
+    std::string format = argv[1];
+    std::string input = argv[2];
+    std::string output = argv[3];
+    try {
+        if (input != "builtin") {
+            TechCatalog::loadFromFile(input);
+        }
+        const CatalogView& catalog = TechCatalog::view();
+        if (format == "text") {
+            std::ofstream out(output);
+            if (!out) {
+                throw std::runtime_error("Cannot write '" + output + "'");
+            }
+            writeCatalogText(catalog, out);
+        } else if (format == "binary") {
+            writeCatalogBinary(catalog, output);
+        } else {
+            std::cerr << "unknown format '" << format << "'\n";
+            return 2;
+        }
+        std::cout << catalog.modules.size() << " modules, " << catalog.designs.size() << " designs -> "
+                  << output << "\n";
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
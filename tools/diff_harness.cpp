@@ -0,0 +1,443 @@
+// Differential correctness and performance harness for the battle solver.
+//
+//   eclipse_difftest [--cases N] [--seed N] [--max-ships N] [--engines a,b,...]
+//                    [--tolerance X] [--trials N] [--z X] [--threads N]
+//                    [--shields averaged|per-target] [--catalog file] [--verbose]
+//
+// Generates random legal matchups from the catalog (any faction, up to
+// --max-ships ships per side, free slots randomly fitted with parts that keep
+// the ship valid) and solves each with the frozen reference solver
+// (tools/reference_solver.hpp, a plain recursive port of the original solver
+// that shares no code with BattleSimulator) and with every engine in --engines:
+//
+//   plain     a fresh BattleSimulator per case, no shared cache or store
+//   cached    one simulator sharing a SolveCache across all cases
+//   parallel  all cases on a thread pool, every worker sharing one SolveCache
+//   store     a fresh SolutionStore, then a second pass answered from it
+//   sampling  BattleSimulator::sample() with --trials battles per case
+//
+// Exact engines must agree with the reference within --tolerance. Sampling
+// must agree within --z standard errors on each outcome probability and on the
+// expected round count. Reports each engine's time relative to the reference.
+// Every disagreeing case is shrunk, by dropping ships and stripping fitted
+// parts while it still disagrees, and printed in fleet_codec notation.
+// --shields selects the shield model of every engine, the reference included.
+// Exits with 1 on any disagreement.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/fleet_codec.hpp"
+#include "game/solution_store.hpp"
+#include "game/solve_cache.hpp"
+#include "game/tech_catalog.hpp"
+#include "reference_solver.hpp"
+#include "util/thread_pool.hpp"
+
+using namespace eclipse;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int cases = 200;
+    unsigned seed = 1;
+    int maxShips = 3;
+    std::vector<std::string> engines{"plain", "cached", "parallel", "store", "sampling"};
+    double tolerance = 1e-9;
+    std::uint64_t trials = 4000;
+    double z = 5.0;
+    unsigned threads = 0;
+    ShieldModel shields = ShieldModel::Averaged;
+    bool verbose = false;
+};
+
+// Decides whether an engine's answer for one matchup is acceptable.
+using Check = std::function<bool(const Matchup&, std::string& detail)>;
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    for (std::string item; std::getline(stream, item, ',');) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+double elapsedMs(Clock::time_point started) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+}
+
+ShipLoadout randomShip(const ShipDesign* design, std::mt19937& random) {
+    ShipLoadout ship(design);
+    auto modules = TechCatalog::modules();
+    std::uniform_int_distribution<size_t> pickModule(0, modules.size() - 1);
+    std::bernoulli_distribution fit(0.4);
+    for (size_t slot = 0; slot < ship.slotCount(); ++slot) {
+        if (!fit(random)) {
+            continue;
+        }
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            const ModuleSpec& module = modules[pickModule(random)];
+            if (module.blueprintOnly || !ship.isSlotCompatible(slot, module)) {
+                continue;
+            }
+            ship.setModule(slot, &module);
+            if (ship.isValid()) {
+                break;
+            }
+            ship.clearModule(slot);
+        }
+    }
+    return ship;
+}
+
+std::vector<ShipLoadout> randomFleet(int maxShips, std::mt19937& random) {
+    const Faction factions[] = {Faction::Human, Faction::Eridani, Faction::Planta, Faction::Orion};
+    auto designs = TechCatalog::factionDesigns(factions[std::uniform_int_distribution<int>(0, 3)(random)]);
+    std::uniform_int_distribution<size_t> pickDesign(0, designs.size() - 1);
+    int target = std::uniform_int_distribution<int>(1, maxShips)(random);
+    std::vector<ShipLoadout> fleet;
+    bool starbase = false;
+    while (static_cast<int>(fleet.size()) < target) {
+        const ShipDesign* design = designs[pickDesign(random)];
+        if (design->shipClass == ShipClass::Starbase) {
+            if (starbase) {
+                continue;
+            }
+            starbase = true;
+        }
+        ShipLoadout ship = randomShip(design, random);
+        if (ship.isValid()) {
+            fleet.push_back(std::move(ship));
+        }
+    }
+    return fleet;
+}
+
+double maxDifference(const BattleSummary& a, const BattleSummary& b) {
+    return std::max({std::abs(a.humanWin - b.humanWin), std::abs(a.alienWin - b.alienWin), std::abs(a.draw - b.draw),
+                     std::abs(a.expectedRounds - b.expectedRounds)});
+}
+
+std::string describe(const BattleSummary& summary) {
+    char text[160];
+    std::snprintf(text, sizeof(text), "human %.9f alien %.9f draw %.9f rounds %.6f", summary.humanWin,
+                  summary.alienWin, summary.draw, summary.expectedRounds);
+    return text;
+}
+
+BattleSimulator makeSimulator(const Options& options, std::shared_ptr<SolutionStore> store = nullptr) {
+    BattleSimulator simulator(std::move(store));
+    simulator.setShieldModel(options.shields);
+    return simulator;
+}
+
+BattleSummary reference(const Matchup& matchup, const Options& options) {
+    return reference::solve(matchup.humans, matchup.aliens, options.shields);
+}
+
+bool exactAgrees(const BattleSummary& expected, const BattleSummary& actual, double tolerance, std::string& detail) {
+    if (maxDifference(expected, actual) <= tolerance) {
+        return true;
+    }
+    detail = "expected " + describe(expected) + "\n    got      " + describe(actual);
+    return false;
+}
+
+// z-test of every outcome frequency and of the mean round count. A probability
+// the reference puts at exactly 0 or 1 must be matched exactly.
+bool sampleAgrees(const BattleSummary& expected, const SampledSummary& sampled, double z, std::string& detail) {
+    double n = static_cast<double>(sampled.trials);
+    auto within = [&](double p, double estimate) {
+        double error = std::sqrt(std::max(p * (1.0 - p), 0.0) / n);
+        return std::abs(estimate - p) <= z * error + 1e-12;
+    };
+    bool ok = within(expected.humanWin, sampled.estimate.humanWin) &&
+              within(expected.alienWin, sampled.estimate.alienWin) && within(expected.draw, sampled.estimate.draw) &&
+              std::abs(sampled.estimate.expectedRounds - expected.expectedRounds) <=
+                  z * std::sqrt(sampled.roundsVariance / n) + 1e-9;
+    if (!ok) {
+        detail = "expected " + describe(expected) + "\n    sampled  " + describe(sampled.estimate) + " (" +
+                 std::to_string(sampled.trials) + " trials)";
+    }
+    return ok;
+}
+
+// Greedily shrinks a failing matchup: drop a ship, or strip one fitted part,
+// whenever the smaller case still fails; repeat until nothing can be removed.
+Matchup minimize(Matchup matchup, const Check& check) {
+    std::string detail;
+    auto fails = [&](const Matchup& candidate) { return !check(candidate, detail); };
+    bool shrunk = true;
+    while (shrunk) {
+        shrunk = false;
+        for (std::vector<ShipLoadout>* fleet : {&matchup.humans, &matchup.aliens}) {
+            for (size_t i = 0; i < fleet->size() && fleet->size() > 1; ++i) {
+                Matchup candidate = matchup;
+                std::vector<ShipLoadout>& side = fleet == &matchup.humans ? candidate.humans : candidate.aliens;
+                side.erase(side.begin() + static_cast<long>(i));
+                if (fails(candidate)) {
+                    matchup = std::move(candidate);
+                    shrunk = true;
+                    break;
+                }
+            }
+            for (size_t i = 0; i < fleet->size(); ++i) {
+                for (size_t slot = 0; slot < (*fleet)[i].slotCount(); ++slot) {
+                    if (!(*fleet)[i].moduleAt(slot)) {
+                        continue;
+                    }
+                    Matchup candidate = matchup;
+                    std::vector<ShipLoadout>& side = fleet == &matchup.humans ? candidate.humans : candidate.aliens;
+                    side[i].clearModule(slot);
+                    if (side[i].isValid() && fails(candidate)) {
+                        matchup = std::move(candidate);
+                        shrunk = true;
+                    }
+                }
+            }
+        }
+    }
+    return matchup;
+}
+
+struct EngineReport {
+    std::string name;
+    double milliseconds = 0.0;
+    std::vector<size_t> failures;
+    std::vector<std::string> details;
+};
+
+// Runs an engine over every case; solve() returns its answer's check result.
+template <typename Solve>
+EngineReport runSequential(std::string name, const std::vector<Matchup>& cases, Solve solve) {
+    EngineReport report;
+    report.name = std::move(name);
+    auto started = Clock::now();
+    for (size_t i = 0; i < cases.size(); ++i) {
+        std::string detail;
+        if (!solve(i, detail)) {
+            report.failures.push_back(i);
+            report.details.push_back(detail);
+        }
+    }
+    report.milliseconds = elapsedMs(started);
+    return report;
+}
+
+int run(const Options& options) {
+    std::mt19937 random(options.seed);
+    std::vector<Matchup> cases;
+    cases.reserve(static_cast<size_t>(options.cases));
+    for (int i = 0; i < options.cases; ++i) {
+        Matchup matchup;
+        matchup.humans = randomFleet(options.maxShips, random);
+        matchup.aliens = randomFleet(options.maxShips, random);
+        cases.push_back(std::move(matchup));
+    }
+
+    std::vector<BattleSummary> expected(cases.size());
+    auto started = Clock::now();
+    for (size_t i = 0; i < cases.size(); ++i) {
+        expected[i] = reference(cases[i], options);
+    }
+    double referenceMs = elapsedMs(started);
+    std::cout << cases.size() << " cases, reference solver " << referenceMs << " ms\n";
+
+    // Minimization re-solves candidates one at a time, so the cached and
+    // parallel engines both shrink against a fresh shared cache.
+    Check sharedCacheCheck = [&options](const Matchup& matchup, std::string& detail) {
+        BattleSimulator fresh = makeSimulator(options);
+        fresh.setSharedCache(std::make_shared<SolveCache>());
+        return exactAgrees(reference(matchup, options), fresh.simulate(matchup.humans, matchup.aliens), options.tolerance,
+                           detail);
+    };
+    std::vector<EngineReport> reports;
+    std::vector<Check> checks;
+    for (const std::string& engine : options.engines) {
+        if (engine == "plain") {
+            reports.push_back(runSequential(engine, cases, [&](size_t i, std::string& detail) {
+                return exactAgrees(expected[i], makeSimulator(options).simulate(cases[i].humans, cases[i].aliens),
+                                   options.tolerance, detail);
+            }));
+            checks.push_back([&options](const Matchup& matchup, std::string& detail) {
+                return exactAgrees(reference(matchup, options),
+                                   makeSimulator(options).simulate(matchup.humans, matchup.aliens), options.tolerance,
+                                   detail);
+            });
+        } else if (engine == "cached") {
+            auto cache = std::make_shared<SolveCache>();
+            BattleSimulator simulator = makeSimulator(options);
+            simulator.setSharedCache(cache);
+            reports.push_back(runSequential(engine, cases, [&](size_t i, std::string& detail) {
+                return exactAgrees(expected[i], simulator.simulate(cases[i].humans, cases[i].aliens),
+                                   options.tolerance, detail);
+            }));
+            checks.push_back(sharedCacheCheck);
+        } else if (engine == "parallel") {
+            auto cache = std::make_shared<SolveCache>();
+            std::vector<BattleSummary> results(cases.size());
+            std::vector<char> failed(cases.size(), 0);
+            ThreadPool pool(options.threads ? options.threads : std::thread::hardware_concurrency());
+            auto parallelStarted = Clock::now();
+            for (size_t i = 0; i < cases.size(); ++i) {
+                pool.submit([&, i] {
+                    try {
+                        BattleSimulator simulator = makeSimulator(options);
+                        simulator.setSharedCache(cache);
+                        results[i] = simulator.simulate(cases[i].humans, cases[i].aliens);
+                    } catch (const std::exception&) {
+                        failed[i] = 1;
+                    }
+                });
+            }
+            pool.wait();
+            EngineReport report;
+            report.name = engine;
+            report.milliseconds = elapsedMs(parallelStarted);
+            for (size_t i = 0; i < cases.size(); ++i) {
+                std::string detail = "solver threw";
+                if (failed[i] || !exactAgrees(expected[i], results[i], options.tolerance, detail)) {
+                    report.failures.push_back(i);
+                    report.details.push_back(detail);
+                }
+            }
+            reports.push_back(std::move(report));
+            checks.push_back(sharedCacheCheck);
+        } else if (engine == "store") {
+            std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                         ("eclipse_difftest_" + std::to_string(options.seed) + ".bin");
+            std::filesystem::remove(path);
+            auto store = SolutionStore::open(path.string());
+            BattleSimulator writer = makeSimulator(options, store);
+            reports.push_back(runSequential("store", cases, [&](size_t i, std::string& detail) {
+                return exactAgrees(expected[i], writer.simulate(cases[i].humans, cases[i].aliens),
+                                   options.tolerance, detail);
+            }));
+            store->compact();
+            BattleSimulator reader = makeSimulator(options, SolutionStore::open(path.string()));
+            reports.push_back(runSequential("store-warm", cases, [&](size_t i, std::string& detail) {
+                return exactAgrees(expected[i], reader.simulate(cases[i].humans, cases[i].aliens),
+                                   options.tolerance, detail);
+            }));
+            auto check = [&options](const Matchup& matchup, std::string& detail) {
+                std::filesystem::path scratch = std::filesystem::temp_directory_path() / "eclipse_difftest_min.bin";
+                std::filesystem::remove(scratch);
+                BattleSimulator fresh = makeSimulator(options, SolutionStore::open(scratch.string()));
+                bool ok = exactAgrees(reference(matchup, options), fresh.simulate(matchup.humans, matchup.aliens),
+                                      options.tolerance, detail);
+                std::filesystem::remove(scratch);
+                return ok;
+            };
+            checks.push_back(check);
+            checks.push_back(check);
+            std::filesystem::remove(path);
+        } else if (engine == "sampling") {
+            reports.push_back(runSequential(engine, cases, [&](size_t i, std::string& detail) {
+                SampledSummary sampled = BattleSimulator::sample(cases[i].humans, cases[i].aliens, options.trials,
+                                                                 options.seed + i, options.shields);
+                return sampleAgrees(expected[i], sampled, options.z, detail);
+            }));
+            checks.push_back([&options](const Matchup& matchup, std::string& detail) {
+                SampledSummary sampled = BattleSimulator::sample(matchup.humans, matchup.aliens, options.trials,
+                                                                 options.seed, options.shields);
+                return sampleAgrees(reference(matchup, options), sampled, options.z, detail);
+            });
+        } else {
+            throw std::runtime_error("unknown engine '" + engine + "'");
+        }
+    }
+
+    bool anyFailure = false;
+    for (size_t e = 0; e < reports.size(); ++e) {
+        const EngineReport& report = reports[e];
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-10s %10.1f ms  x%.2f vs reference  %zu/%zu agree", report.name.c_str(),
+                      report.milliseconds, referenceMs / std::max(report.milliseconds, 1e-3),
+                      cases.size() - report.failures.size(), cases.size());
+        std::cout << line << "\n";
+        for (size_t f = 0; f < report.failures.size(); ++f) {
+            anyFailure = true;
+            const Matchup& failing = cases[report.failures[f]];
+            std::cout << "  case " << report.failures[f] << ": " << formatMatchup(failing) << "\n    "
+                      << report.details[f] << "\n";
+            if (f == 0 || options.verbose) {
+                Matchup smallest = minimize(failing, checks[e]);
+                std::cout << "    minimized: " << formatMatchup(smallest) << "\n";
+            }
+        }
+    }
+    return anyFailure ? 1 : 0;
+}
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--cases N] [--seed N] [--max-ships N] [--engines plain,cached,parallel,store,sampling]"
+                 " [--tolerance X] [--trials N] [--z X] [--threads N] [--shields averaged|per-target]"
+                 " [--catalog file] [--verbose]\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--verbose") {
+                options.verbose = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--cases") {
+                options.cases = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--seed") {
+                options.seed = static_cast<unsigned>(std::atoi(value.c_str()));
+            } else if (arg == "--max-ships") {
+                options.maxShips = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--engines") {
+                options.engines = splitList(value);
+            } else if (arg == "--tolerance") {
+                options.tolerance = std::stod(value);
+            } else if (arg == "--trials") {
+                options.trials = std::max<std::uint64_t>(1, std::stoull(value));
+            } else if (arg == "--z") {
+                options.z = std::stod(value);
+            } else if (arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--shields" && (value == "averaged" || value == "per-target")) {
+                options.shields = value == "averaged" ? ShieldModel::Averaged : ShieldModel::PerTarget;
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        return run(options);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// Fleet helper shared by the benchmark tools.
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "game/tech_catalog.hpp"
+#include "game/types.hpp"
+
+namespace eclipse {
+
+// Cycles through the faction's default designs that pass validation (several
+// fall short on energy as printed), within the per-class ship limits.
+inline std::vector<ShipLoadout> lineUp(Faction faction, int ships) {
+    std::vector<ShipLoadout> designs;
+    for (const ShipDesign* design : TechCatalog::factionDesigns(faction)) {
+        if (ShipLoadout ship(design); ship.isValid()) {
+            designs.push_back(ship);
+        }
+    }
+    std::vector<ShipLoadout> fleet;
+    std::array<int, 5> counts{};
+    for (std::size_t i = 0; !designs.empty() && static_cast<int>(fleet.size()) < ships && i < designs.size() * 16;
+         ++i) {
+        const ShipLoadout& ship = designs[i % designs.size()];
+        ShipClass shipClass = ship.design()->shipClass;
+        int& count = counts[static_cast<std::size_t>(shipClass)];
+        if (count < shipClassLimit(shipClass)) {
+            ++count;
+            fleet.push_back(ship);
+        }
+    }
+    return fleet;
+}
+
+}  // namespace eclipse
@@ -0,0 +1,139 @@
+// Win chances of every fleet against every other.
+//
+//   eclipse_matrix [--matchups file] [--threads N] [--per-target]
+//                  [--solution-store file] [--catalog file]
+//
+// By default the rows and columns are every faction blueprint as a one-ship
+// fleet; --matchups takes a saved matchup file (either fleet_codec format) and
+// uses both fleets of each matchup instead, labelled <n>H and <n>A. Cell (r, c)
+// is the chance that row r, fighting as the humans, beats column c. Cells are
+// solved in parallel with one shared cache; the tool prints the matrix, the
+// wall time against the summed per-cell time, and how often the cache hit.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/fleet_codec.hpp"
+#include "game/matchup_matrix.hpp"
+#include "game/solution_store.hpp"
+#include "game/solve_cache.hpp"
+#include "game/tech_catalog.hpp"
+
+using namespace eclipse;
+
+namespace {
+struct Options {
+    std::string matchups;
+    MatrixOptions matrix;
+};
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--matchups file] [--threads N] [--per-target] [--solution-store file] [--catalog file]\n";
+}
+
+std::vector<MatrixEntry> matchupEntries(const std::vector<Matchup>& matchups) {
+    std::vector<MatrixEntry> entries;
+    for (std::size_t i = 0; i < matchups.size(); ++i) {
+        entries.push_back({std::to_string(i) + "H", matchups[i].humans});
+        entries.push_back({std::to_string(i) + "A", matchups[i].aliens});
+    }
+    return entries;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<MatrixEntry> entries;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--per-target") {
+                options.matrix.shields = ShieldModel::PerTarget;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--matchups") {
+                options.matchups = value;
+            } else if (arg == "--threads") {
+                options.matrix.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--solution-store") {
+                options.matrix.store = SolutionStore::open(value);
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        entries = options.matchups.empty() ? factionDesignEntries() : matchupEntries(loadMatchups(options.matchups));
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    if (entries.empty()) {
+        std::cerr << "no fleets to compare\n";
+        return 1;
+    }
+
+    auto cache = std::make_shared<SolveCache>();
+    options.matrix.cache = cache;
+    std::vector<MatrixCell> cells(entries.size() * entries.size());
+    std::mutex mutex;
+    auto started = std::chrono::steady_clock::now();
+    std::size_t solved = 0;
+    try {
+        solved = solveMatrix(entries, options.matrix, [&](const MatrixCell& cell) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cells[cell.row * entries.size() + cell.column] = cell;
+        });
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    std::size_t labelWidth = 0;
+    for (const MatrixEntry& entry : entries) {
+        labelWidth = std::max(labelWidth, entry.label.size());
+    }
+    std::printf("%*s", static_cast<int>(labelWidth + 4), "");
+    for (std::size_t column = 0; column < entries.size(); ++column) {
+        std::printf("%6zu", column);
+    }
+    std::printf("\n");
+    double cellTotal = 0.0;
+    SolveStats totals;
+    for (std::size_t row = 0; row < entries.size(); ++row) {
+        std::printf("%2zu %-*s ", row, static_cast<int>(labelWidth), entries[row].label.c_str());
+        for (std::size_t column = 0; column < entries.size(); ++column) {
+            const MatrixCell& cell = cells[row * entries.size() + column];
+            std::printf("%6.1f", cell.summary.humanWin * 100.0);
+            cellTotal += cell.milliseconds;
+            totals.statesExpanded += cell.stats.statesExpanded;
+            totals.sharedHits += cell.stats.sharedHits;
+            totals.storeHits += cell.stats.storeHits;
+        }
+        std::printf("\n");
+    }
+
+    std::printf("%zu cells, %.1f ms wall, %.1f ms summed over cells (x%.2f)\n", solved, wall, cellTotal,
+                wall > 0.0 ? cellTotal / wall : 0.0);
+    std::printf("%llu states expanded, %llu shared cache hits, %llu store hits, %zu cached states\n",
+                static_cast<unsigned long long>(totals.statesExpanded),
+                static_cast<unsigned long long>(totals.sharedHits),
+                static_cast<unsigned long long>(totals.storeHits), cache->size());
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Cost of battles between three and four fleets.
+//
+//   eclipse_multiside_bench [--ships N] [--targeting threat|weakest]
+//                           [--repeat N] [--catalog file]
+//
+// Every combination of three factions, and all four together, fights with a
+// line-up of up to N ships per faction (cycling through its valid default
+// designs). For each battle the tool prints the best time of --repeat solves,
+// the states expanded (multi-fleet and two-sided endgames together) and each
+// faction's chance to be the last fleet standing.
+// The two-sided solves of the same line-ups are timed alongside for scale.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/tech_catalog.hpp"
+#include "line_up.hpp"
+
+using namespace eclipse;
+
+namespace {
+struct Options {
+    int ships = 3;
+    TargetRule targeting = TargetRule::Threat;
+    int repeat = 3;
+};
+
+const char* factionName(Faction faction) {
+    switch (faction) {
+        case Faction::Human: return "Human";
+        case Faction::Eridani: return "Eridani";
+        case Faction::Planta: return "Planta";
+        case Faction::Orion: return "Orion";
+    }
+    return "?";
+}
+
+double bestOf(int repeat, const std::function<void()>& solve) {
+    double best = 0.0;
+    for (int run = 0; run < repeat; ++run) {
+        auto started = std::chrono::steady_clock::now();
+        solve();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--ships N] [--targeting threat|weakest] [--repeat N] [--catalog file]\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--ships") {
+                options.ships = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--targeting" && (value == "threat" || value == "weakest")) {
+                options.targeting = value == "threat" ? TargetRule::Threat : TargetRule::Weakest;
+            } else if (arg == "--repeat") {
+                options.repeat = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+
+    const std::vector<std::vector<Faction>> battles{
+        {Faction::Human, Faction::Eridani, Faction::Planta},
+        {Faction::Human, Faction::Eridani, Faction::Orion},
+        {Faction::Human, Faction::Planta, Faction::Orion},
+        {Faction::Eridani, Faction::Planta, Faction::Orion},
+        {Faction::Human, Faction::Eridani, Faction::Planta, Faction::Orion},
+    };
+
+    double multiTotal = 0.0;
+    double pairTotal = 0.0;
+    for (const std::vector<Faction>& factions : battles) {
+        std::vector<CombatSide> sides;
+        for (Faction faction : factions) {
+            sides.push_back({lineUp(faction, options.ships), options.targeting});
+        }
+
+        BattleSimulator simulator;
+        MultiBattleSummary summary;
+        double multi = bestOf(options.repeat, [&] { summary = simulator.simulate(sides); });
+        SolveStats stats = simulator.lastStats();
+
+        // Every pairing of the same line-ups as ordinary two-sided battles.
+        double pairs = bestOf(options.repeat, [&] {
+            BattleSimulator pairSimulator;
+            for (size_t a = 0; a < sides.size(); ++a) {
+                for (size_t b = a + 1; b < sides.size(); ++b) {
+                    pairSimulator.simulate(sides[a].fleet, sides[b].fleet);
+                }
+            }
+        });
+        multiTotal += multi;
+        pairTotal += pairs;
+
+        std::string names;
+        for (Faction faction : factions) {
+            names += names.empty() ? "" : " vs ";
+            names += factionName(faction);
+        }
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-36s %9.2f ms (pairwise %7.2f ms)  %8llu states  %8llu memo hits",
+                      names.c_str(), multi, pairs, static_cast<unsigned long long>(stats.statesExpanded),
+                      static_cast<unsigned long long>(stats.memoHits));
+        std::cout << line << "\n   ";
+        for (size_t side = 0; side < factions.size(); ++side) {
+            std::snprintf(line, sizeof(line), " %s %.4f", factionName(factions[side]), summary.win[side]);
+            std::cout << line;
+        }
+        std::snprintf(line, sizeof(line), "  draw %.4f  rounds %.2f", summary.draw, summary.expectedRounds);
+        std::cout << line << "\n";
+    }
+    std::cout << "total " << multiTotal << " ms multi-fleet, " << pairTotal << " ms pairwise\n";
+    return 0;
+}
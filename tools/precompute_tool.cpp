@@ -0,0 +1,348 @@
+// Solves common fleet matchups offline and writes their summaries to a solution
+// store that BattleSimulator answers from directly.
+//
+//   eclipse_precompute <store> [--max-ships N] [--upgrades A,B,...|none]
+//                      [--attackers HUM,...] [--defenders ORI,ERI,PLA,HUM]
+//                      [--threads N] [--shard i/n] [--catalog file]
+//   eclipse_precompute --merge <store> <input>...
+//
+// Every ship is a faction's default design, optionally with one upgrade module
+// fitted. Fleets are all multisets of such ships up to --max-ships within the
+// per-class limits, and every attacker fleet is paired with every defender fleet.
+//
+// Matchups already present in the store are skipped, so an interrupted run
+// resumes where it stopped. --shard i/n solves every n-th matchup starting at i;
+// run one process per shard with its own store and combine them with --merge.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/solution_store.hpp"
+#include "game/tech_catalog.hpp"
+
+using namespace eclipse;
+
+namespace {
+struct Options {
+    std::string store;
+    int maxShips = 2;
+    std::vector<std::string> upgrades{"PLASMA_CANNON", "POSITRON_COMPUTER", "GAUSS_SHIELD", "IMPROVED_HULL"};
+    std::vector<Faction> attackers{Faction::Human};
+    std::vector<Faction> defenders{Faction::Orion, Faction::Eridani, Faction::Planta, Faction::Human};
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t shard = 0;
+    std::size_t shardCount = 1;
+};
+
+using Fleet = std::vector<ShipLoadout>;
+
+std::vector<std::string> splitList(std::string_view text) {
+    std::vector<std::string> items;
+    std::stringstream stream{std::string(text)};
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+Faction parseFaction(const std::string& code) {
+    if (code == "HUM") return Faction::Human;
+    if (code == "ERI") return Faction::Eridani;
+    if (code == "PLA") return Faction::Planta;
+    if (code == "ORI") return Faction::Orion;
+    throw std::runtime_error("unknown faction '" + code + "' (expected HUM, ERI, PLA or ORI)");
+}
+
+std::vector<Faction> parseFactions(std::string_view text) {
+    std::vector<Faction> factions;
+    for (const std::string& code : splitList(text)) {
+        factions.push_back(parseFaction(code));
+    }
+    return factions;
+}
+
+// Fits the upgrade over a part of the same slot type if possible, otherwise into
+// an empty slot; the first placement that leaves the ship valid wins.
+bool fitUpgrade(ShipLoadout& ship, const ModuleSpec* upgrade) {
+    for (bool sameType : {true, false}) {
+        for (size_t i = 0; i < ship.slotCount(); ++i) {
+            const ModuleSpec* current = ship.activeModuleAt(i);
+            bool candidate = sameType ? (current && current->slot == upgrade->slot && current != upgrade)
+                                      : current == nullptr;
+            if (!candidate || !ship.isSlotCompatible(i, *upgrade)) {
+                continue;
+            }
+            ShipLoadout trial = ship;
+            trial.setModule(i, upgrade);
+            if (trial.isValid()) {
+                ship = trial;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<ShipLoadout> shipVariants(Faction faction, const std::vector<const ModuleSpec*>& upgrades) {
+    std::vector<ShipLoadout> variants;
+    for (const ShipDesign* design : TechCatalog::factionDesigns(faction)) {
+        ShipLoadout base(design);
+        if (!base.isValid()) {
+            continue;
+        }
+        variants.push_back(base);
+        for (const ModuleSpec* upgrade : upgrades) {
+            ShipLoadout upgraded = base;
+            if (fitUpgrade(upgraded, upgrade)) {
+                variants.push_back(upgraded);
+            }
+        }
+    }
+    return variants;
+}
+
+void enumerateFleets(const std::vector<ShipLoadout>& variants, int maxShips, size_t first, Fleet& current,
+                     std::vector<Fleet>& fleets) {
+    if (!current.empty()) {
+        fleets.push_back(current);
+    }
+    if (static_cast<int>(current.size()) >= maxShips) {
+        return;
+    }
+    for (size_t i = first; i < variants.size(); ++i) {
+        ShipClass shipClass = variants[i].design()->shipClass;
+        int sameClass = static_cast<int>(std::count_if(current.begin(), current.end(), [&](const ShipLoadout& ship) {
+            return ship.design()->shipClass == shipClass;
+        }));
+        if (sameClass >= shipClassLimit(shipClass)) {
+            continue;
+        }
+        current.push_back(variants[i]);
+        enumerateFleets(variants, maxShips, i, current, fleets);
+        current.pop_back();
+    }
+}
+
+std::vector<Fleet> factionFleets(Faction faction, const Options& options,
+                                 const std::vector<const ModuleSpec*>& upgrades) {
+    std::vector<Fleet> fleets;
+    Fleet current;
+    enumerateFleets(shipVariants(faction, upgrades), options.maxShips, 0, current, fleets);
+    return fleets;
+}
+
+struct Matchups {
+    std::vector<std::vector<Fleet>> fleets;  // indexed like Faction
+    std::vector<std::pair<Faction, Faction>> pairings;
+    std::vector<std::size_t> pairingStart;
+    std::size_t total = 0;
+
+    std::pair<const Fleet*, const Fleet*> at(std::size_t index) const {
+        size_t pairing = static_cast<size_t>(
+            std::upper_bound(pairingStart.begin(), pairingStart.end(), index) - pairingStart.begin() - 1);
+        const auto& attackers = fleets[static_cast<size_t>(pairings[pairing].first)];
+        const auto& defenders = fleets[static_cast<size_t>(pairings[pairing].second)];
+        std::size_t local = index - pairingStart[pairing];
+        return {&attackers[local / defenders.size()], &defenders[local % defenders.size()]};
+    }
+};
+
+Matchups buildMatchups(const Options& options) {
+    std::vector<const ModuleSpec*> upgrades;
+    for (const std::string& id : options.upgrades) {
+        const ModuleSpec* spec = TechCatalog::findModule(id);
+        if (!spec) {
+            throw std::runtime_error("unknown upgrade module '" + id + "'");
+        }
+        upgrades.push_back(spec);
+    }
+    Matchups matchups;
+    matchups.fleets.resize(4);
+    for (Faction faction : {Faction::Human, Faction::Eridani, Faction::Planta, Faction::Orion}) {
+        matchups.fleets[static_cast<size_t>(faction)] = factionFleets(faction, options, upgrades);
+    }
+    for (Faction attacker : options.attackers) {
+        for (Faction defender : options.defenders) {
+            std::size_t count = matchups.fleets[static_cast<size_t>(attacker)].size() *
+                                matchups.fleets[static_cast<size_t>(defender)].size();
+            if (count == 0) {
+                continue;
+            }
+            matchups.pairings.emplace_back(attacker, defender);
+            matchups.pairingStart.push_back(matchups.total);
+            matchups.total += count;
+        }
+    }
+    return matchups;
+}
+
+int run(const Options& options) {
+    Matchups matchups = buildMatchups(options);
+    auto store = SolutionStore::open(options.store);
+    std::size_t owned = matchups.total / options.shardCount +
+                        (options.shard < matchups.total % options.shardCount ? 1 : 0);
+    std::cout << matchups.total << " matchups, " << owned << " in shard " << options.shard << "/"
+              << options.shardCount << ", " << options.threads << " threads\n";
+
+    std::atomic<std::size_t> next{options.shard};
+    std::atomic<std::size_t> solved{0};
+    std::atomic<std::size_t> skipped{0};
+    std::mutex reportMutex;
+    auto started = std::chrono::steady_clock::now();
+    auto lastReport = started;
+    // The first error a worker hits stops the others and is rethrown after
+    // they are joined, so main() reports it instead of std::terminate.
+    std::stop_source stopAll;
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto solveShard = [&]() {
+        BattleSimulator simulator;
+        while (!stopAll.stop_requested()) {
+            std::size_t index = next.fetch_add(options.shardCount);
+            if (index >= matchups.total) {
+                return;
+            }
+            auto [attackers, defenders] = matchups.at(index);
+            StateKey key = BattleSimulator::matchupKey(*attackers, *defenders);
+            BattleSummary summary;
+            if (store->find(key, summary)) {
+                skipped.fetch_add(1);
+                continue;
+            }
+            store->insert(key, simulator.simulate(*attackers, *defenders, stopAll.get_token()));
+            std::size_t done = solved.fetch_add(1) + 1;
+            if (done % 512 == 0) {
+                store->flush();
+                std::lock_guard<std::mutex> lock(reportMutex);
+                auto now = std::chrono::steady_clock::now();
+                if (now - lastReport > std::chrono::seconds(5)) {
+                    lastReport = now;
+                    double seconds = std::chrono::duration<double>(now - started).count();
+                    std::cout << "  " << done + skipped.load() << "/" << owned << " (" << done / seconds
+                              << " solves/s)\n" << std::flush;
+                }
+            }
+        }
+    };
+    auto worker = [&]() {
+        try {
+            solveShard();
+        } catch (const SimulationCancelled&) {
+            // Stopped because another worker failed.
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+            stopAll.request_stop();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < options.threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    store->flush();
+    store->compact();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << solved.load() << " solved, " << skipped.load() << " already stored in " << seconds << " s; "
+              << store->size() << " entries in " << options.store << "\n";
+    return 0;
+}
+
+int merge(const std::string& output, const std::vector<std::string>& inputs) {
+    auto store = SolutionStore::open(output);
+    for (const std::string& input : inputs) {
+        store->merge(SolutionStore(input));
+    }
+    store->compact();
+    std::cout << store->size() << " entries in " << output << "\n";
+    return 0;
+}
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " <store> [--max-ships N] [--upgrades A,B,...|none] [--attackers HUM,...]"
+                 " [--defenders ORI,...] [--threads N] [--shard i/n] [--catalog file]\n"
+              << "       " << program << " --merge <store> <input>...\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    try {
+        if (std::string_view(argv[1]) == "--merge") {
+            if (argc < 4) {
+                usage(argv[0]);
+                return 2;
+            }
+            return merge(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+        }
+        Options options;
+        options.store = argv[1];
+        for (int i = 2; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--max-ships") {
+                options.maxShips = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--upgrades") {
+                options.upgrades = value == "none" ? std::vector<std::string>{} : splitList(value);
+            } else if (arg == "--attackers") {
+                options.attackers = parseFactions(value);
+            } else if (arg == "--defenders") {
+                options.defenders = parseFactions(value);
+            } else if (arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--shard") {
+                size_t slash = value.find('/');
+                if (slash == std::string::npos) {
+                    throw std::runtime_error("--shard expects i/n");
+                }
+                options.shard = std::stoul(value.substr(0, slash));
+                options.shardCount = std::stoul(value.substr(slash + 1));
+                if (options.shardCount == 0 || options.shard >= options.shardCount) {
+                    throw std::runtime_error("--shard expects 0 <= i < n");
+                }
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        return run(options);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+}
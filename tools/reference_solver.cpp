@@ -0,0 +1,331 @@
+#include "reference_solver.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <optional>
+
+namespace eclipse::reference {
+
+namespace {
+struct Weapon {
+    int dice = 0;
+    int dieSides = 6;
+    int baseToHit = 6;
+    int initiative = 1;
+
+    auto operator<=>(const Weapon&) const = default;
+};
+
+struct Ship {
+    int hull = 0;
+    int computer = 0;
+    int shield = 0;
+    bool fluxShield = false;
+    ShipClass shipClass = ShipClass::Other;
+    std::vector<Weapon> weapons;
+    std::vector<Weapon> missiles;
+
+    auto operator<=>(const Ship&) const = default;
+};
+
+using Fleet = std::vector<Ship>;
+
+struct State {
+    Fleet humans;
+    Fleet aliens;
+    bool missilesResolved = false;
+
+    auto operator<=>(const State&) const = default;
+};
+
+struct Result {
+    double humanWin = 0.0;
+    double alienWin = 0.0;
+    double draw = 0.0;
+    double expectedRounds = 0.0;
+};
+
+using Memo = std::map<State, Result>;
+
+int totalDice(const Ship& ship) {
+    int dice = 0;
+    for (const Weapon& weapon : ship.weapons) {
+        dice += weapon.dice;
+    }
+    return dice;
+}
+
+bool battleCompare(const Ship& a, const Ship& b) {
+    if (a.hull != b.hull) return a.hull > b.hull;
+    if (totalDice(a) != totalDice(b)) return totalDice(a) > totalDice(b);
+    if (a.computer != b.computer) return a.computer > b.computer;
+    if (a.shield != b.shield) return a.shield > b.shield;
+    if (a.fluxShield != b.fluxShield) return a.fluxShield;
+    return static_cast<int>(a.shipClass) < static_cast<int>(b.shipClass);
+}
+
+bool damageCompare(const Ship& a, const Ship& b) {
+    if (a.hull != b.hull) return a.hull < b.hull;
+    if (totalDice(a) != totalDice(b)) return totalDice(a) < totalDice(b);
+    if (a.computer != b.computer) return a.computer < b.computer;
+    return a.shield < b.shield;
+}
+
+void canonicalize(State& state) {
+    std::stable_sort(state.humans.begin(), state.humans.end(), battleCompare);
+    std::stable_sort(state.aliens.begin(), state.aliens.end(), battleCompare);
+}
+
+// The defender shields dice are scored against: the fleet's rounded mean, or
+// every distinct shield value in ascending order.
+std::vector<int> targetShields(const Fleet& defenders, ShieldModel shields) {
+    std::vector<int> values;
+    if (shields == ShieldModel::PerTarget) {
+        for (const Ship& ship : defenders) {
+            values.push_back(ship.shield);
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    } else {
+        double sum = 0.0;
+        for (const Ship& ship : defenders) {
+            sum += ship.shield;
+        }
+        values.push_back(static_cast<int>(std::round(sum / static_cast<double>(defenders.size()))));
+    }
+    return values;
+}
+
+// Distribution of one volley, as the number of dice in each category: a die
+// of category k beats the k lowest target shields and no others.
+std::map<std::vector<int>, double> rollVolley(const Fleet& attackers,
+                                              const std::vector<int>& shields,
+                                              bool missiles,
+                                              std::optional<int> initiative) {
+    std::map<std::vector<int>, double> distribution{{std::vector<int>(shields.size() + 1, 0), 1.0}};
+    for (const Ship& ship : attackers) {
+        for (const Weapon& weapon : missiles ? ship.missiles : ship.weapons) {
+            if (initiative && weapon.initiative != *initiative) {
+                continue;
+            }
+            int maxRoll = std::max(weapon.dieSides, 2);
+            std::vector<double> category(shields.size() + 1, 0.0);
+            for (int roll = 1; roll <= maxRoll; ++roll) {
+                std::size_t beaten = 0;
+                for (int shield : shields) {
+                    int needed = std::clamp(weapon.baseToHit - ship.computer + shield, 2, maxRoll);
+                    beaten += roll >= needed ? 1 : 0;
+                }
+                category[beaten] += 1.0 / maxRoll;
+            }
+            for (int die = 0; die < weapon.dice; ++die) {
+                std::map<std::vector<int>, double> next;
+                for (const auto& [counts, probability] : distribution) {
+                    for (std::size_t k = 0; k < category.size(); ++k) {
+                        if (category[k] > 0.0) {
+                            std::vector<int> more = counts;
+                            ++more[k];
+                            next[more] += probability * category[k];
+                        }
+                    }
+                }
+                distribution.swap(next);
+            }
+        }
+    }
+    return distribution;
+}
+
+// Ships soak up hits smallest first. A ship takes only dice that beat its
+// shield, the least versatile first, and its flux shield stops one damage.
+Fleet applyDice(const Fleet& defenders, const std::vector<int>& shields, std::vector<int> counts) {
+    Fleet targets = defenders;
+    std::stable_sort(targets.begin(), targets.end(), damageCompare);
+    Fleet survivors;
+    for (Ship ship : targets) {
+        std::size_t lowest = 1;
+        if (shields.size() > 1) {
+            lowest = static_cast<std::size_t>(std::find(shields.begin(), shields.end(), ship.shield) - shields.begin()) + 1;
+        }
+        int reachable = 0;
+        for (std::size_t k = lowest; k < counts.size(); ++k) {
+            reachable += counts[k];
+        }
+        int damage = std::min(reachable, ship.hull);
+        if (ship.fluxShield && damage > 0) {
+            --damage;
+        }
+        ship.hull -= damage;
+        for (std::size_t k = lowest; damage > 0; ++k) {
+            int taken = std::min(damage, counts[k]);
+            counts[k] -= taken;
+            damage -= taken;
+        }
+        if (ship.hull > 0) {
+            survivors.push_back(ship);
+        }
+    }
+    std::stable_sort(survivors.begin(), survivors.end(), battleCompare);
+    return survivors;
+}
+
+// Both fleets fire at once, each at the fleet as it stood before the volley.
+std::map<State, double> exchange(const State& state, bool missiles, std::optional<int> initiative,
+                                 ShieldModel model) {
+    std::vector<int> atAliens = targetShields(state.aliens, model);
+    std::vector<int> atHumans = targetShields(state.humans, model);
+    auto humanDice = rollVolley(state.humans, atAliens, missiles, initiative);
+    auto alienDice = rollVolley(state.aliens, atHumans, missiles, initiative);
+    std::map<State, double> outcomes;
+    for (const auto& [humanCounts, humanProbability] : humanDice) {
+        for (const auto& [alienCounts, alienProbability] : alienDice) {
+            State next = state;
+            next.aliens = applyDice(state.aliens, atAliens, humanCounts);
+            next.humans = applyDice(state.humans, atHumans, alienCounts);
+            outcomes[next] += humanProbability * alienProbability;
+        }
+    }
+    return outcomes;
+}
+
+std::map<State, double> roundOutcomes(const State& state, ShieldModel model) {
+    std::vector<int> initiatives;
+    for (const Fleet* fleet : {&state.humans, &state.aliens}) {
+        for (const Ship& ship : *fleet) {
+            for (const Weapon& weapon : ship.weapons) {
+                initiatives.push_back(weapon.initiative);
+            }
+        }
+    }
+    std::sort(initiatives.begin(), initiatives.end(), std::greater<>());
+    initiatives.erase(std::unique(initiatives.begin(), initiatives.end()), initiatives.end());
+
+    std::map<State, double> current{{state, 1.0}};
+    for (int initiative : initiatives) {
+        std::map<State, double> next;
+        for (const auto& [from, probability] : current) {
+            if (from.humans.empty() || from.aliens.empty()) {
+                next[from] += probability;
+                continue;
+            }
+            for (const auto& [to, step] : exchange(from, false, initiative, model)) {
+                next[to] += probability * step;
+            }
+        }
+        current.swap(next);
+    }
+    return current;
+}
+
+Result solveState(const State& state, ShieldModel model, Memo& memo) {
+    if (state.humans.empty() && state.aliens.empty()) {
+        return {0.0, 0.0, 1.0, 0.0};
+    }
+    if (state.aliens.empty()) {
+        return {1.0, 0.0, 0.0, 0.0};
+    }
+    if (state.humans.empty()) {
+        return {0.0, 1.0, 0.0, 0.0};
+    }
+    if (auto it = memo.find(state); it != memo.end()) {
+        return it->second;
+    }
+
+    bool missilePhase = !state.missilesResolved;
+    std::map<State, double> outcomes;
+    if (missilePhase) {
+        for (const auto& [volleyed, probability] : exchange(state, true, std::nullopt, model)) {
+            State next = volleyed;
+            for (Fleet* fleet : {&next.humans, &next.aliens}) {
+                for (Ship& ship : *fleet) {
+                    ship.missiles.clear();
+                }
+            }
+            next.missilesResolved = true;
+            outcomes[next] += probability;
+        }
+    } else {
+        outcomes = roundOutcomes(state, model);
+    }
+
+    Result sum;
+    double progress = 0.0;
+    for (const auto& [next, probability] : outcomes) {
+        if (probability <= 0.0 || next == state) {
+            continue;
+        }
+        Result child = solveState(next, model, memo);
+        progress += probability;
+        sum.humanWin += probability * child.humanWin;
+        sum.alienWin += probability * child.alienWin;
+        sum.draw += probability * child.draw;
+        sum.expectedRounds += probability * child.expectedRounds;
+    }
+    Result result{0.0, 0.0, 1.0, 0.0};  // a stalemate counts as a draw
+    if (progress > std::numeric_limits<double>::epsilon()) {
+        result = {sum.humanWin / progress, sum.alienWin / progress, sum.draw / progress,
+                  ((missilePhase ? 0.0 : 1.0) + sum.expectedRounds) / progress};
+    }
+    memo.emplace(state, result);
+    return result;
+}
+
+Ship makeShip(const ShipLoadout& loadout) {
+    Ship ship;
+    const ShipDesign* design = loadout.design();
+    ShipDerivedStats stats = loadout.derivedStats();
+    ship.hull = std::max(1, stats.hull);
+    ship.computer = stats.computer;
+    ship.shield = stats.shield;
+    ship.shipClass = design ? design->shipClass : ShipClass::Other;
+    if (design && design->baseDice > 0) {
+        ship.weapons.push_back({design->baseDice, design->baseWeaponDieSides, design->baseWeaponHit,
+                                design->baseWeaponInitiative + stats.initiativeBonus});
+    }
+    for (const ModuleSpec* module : loadout.activeModules()) {
+        ship.fluxShield = ship.fluxShield || module->grantsFluxShield;
+        if (module->dice <= 0) {
+            continue;
+        }
+        if (module->missile) {
+            ship.missiles.push_back({module->dice, module->weaponDieSides, module->baseToHit, module->weaponInitiative});
+        } else {
+            ship.weapons.push_back({module->dice, module->weaponDieSides, module->baseToHit,
+                                    module->weaponInitiative + stats.initiativeBonus});
+        }
+    }
+    return ship;
+}
+
+Fleet makeFleet(const std::vector<ShipLoadout>& loadouts) {
+    Fleet fleet;
+    std::array<int, 5> counts{};
+    for (const ShipLoadout& loadout : loadouts) {
+        if (!loadout.isValid()) {
+            continue;
+        }
+        ShipClass shipClass = loadout.design() ? loadout.design()->shipClass : ShipClass::Other;
+        int& count = counts[static_cast<std::size_t>(shipClass)];
+        if (count < shipClassLimit(shipClass)) {
+            ++count;
+            fleet.push_back(makeShip(loadout));
+        }
+    }
+    return fleet;
+}
+}  // namespace
+
+BattleSummary solve(const std::vector<ShipLoadout>& humans,
+                    const std::vector<ShipLoadout>& aliens,
+                    ShieldModel shields) {
+    State state{makeFleet(humans), makeFleet(aliens), false};
+    canonicalize(state);
+    Memo memo;
+    Result result = solveState(state, shields, memo);
+    return {result.humanWin, result.alienWin, result.draw, result.expectedRounds};
+}
+
+}  // namespace eclipse::reference
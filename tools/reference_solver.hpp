@@ -0,0 +1,26 @@
+#pragma once
+
+// Frozen reference solver for eclipse_difftest.
+//
+// A deliberately plain port of the original recursive solver, kept apart from
+// BattleSimulator so that optimizations of the production solver (pooled dice
+// columns, shield levels, packed hit vectors, the memo plumbing) are diffed
+// against an independent implementation of the same rules. It shares no code
+// with src/game/battle_simulator.cpp beyond the catalog's derived ship stats.
+// Do not optimize it: its job is to stay obviously correct.
+
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/types.hpp"
+
+namespace eclipse::reference {
+
+// Exact outcome of the battle under the given shield model. With PerTarget
+// every die is scored against each defender's own shield, and a ship only
+// takes the dice that beat its shield, the least versatile first.
+BattleSummary solve(const std::vector<ShipLoadout>& humans,
+                    const std::vector<ShipLoadout>& aliens,
+                    ShieldModel shields = ShieldModel::Averaged);
+
+}  // namespace eclipse::reference
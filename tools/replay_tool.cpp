@@ -0,0 +1,171 @@
+// Replays a workload captured with `eclipse_sim --record <file>` against the
+// current build.
+//
+//   eclipse_replay <log> [--repeat N] [--tolerance X] [--solution-store file]
+//                  [--catalog file] [--quiet]
+//
+// Every request is solved again by a fresh simulator (best of --repeat runs) and
+// its probabilities compared with the captured ones. Requests that were
+// cancelled or failed when captured are solved and timed too, but have no
+// result to compare and stay out of the speedup. Prints one line per request
+// with both timings and state counts, then totals. Exits with 1 if any result
+// differs by more than --tolerance.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "game/battle_simulator.hpp"
+#include "game/fleet_codec.hpp"
+#include "game/solution_store.hpp"
+#include "game/tech_catalog.hpp"
+#include "game/workload_log.hpp"
+
+using namespace eclipse;
+
+namespace {
+struct Options {
+    std::string log;
+    int repeat = 1;
+    double tolerance = 1e-9;
+    std::shared_ptr<SolutionStore> store;
+    bool quiet = false;
+};
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " <log> [--repeat N] [--tolerance X] [--solution-store file] [--catalog file] [--quiet]\n";
+}
+
+double difference(const BattleSummary& a, const BattleSummary& b) {
+    return std::max({std::abs(a.humanWin - b.humanWin), std::abs(a.alienWin - b.alienWin), std::abs(a.draw - b.draw),
+                     std::abs(a.expectedRounds - b.expectedRounds)});
+}
+
+int run(const Options& options) {
+    Workload workload = loadWorkload(options.log);
+    if (workload.catalog != catalogFingerprint()) {
+        std::cerr << "warning: log was captured under a different catalog; pass the same --catalog\n";
+    }
+
+    double recordedTotal = 0.0;
+    double replayedTotal = 0.0;
+    double logSpeedup = 0.0;
+    std::size_t compared = 0;
+    std::size_t mismatches = 0;
+    std::size_t index = 0;
+    for (const WorkloadEntry& entry : workload.entries) {
+        BattleSummary summary;
+        SolveStats stats;
+        std::string error;
+        double best = 0.0;
+        for (int run = 0; run < options.repeat; ++run) {
+            BattleSimulator simulator(options.store);
+            auto started = std::chrono::steady_clock::now();
+            try {
+                summary = simulator.simulate(entry.matchup.humans, entry.matchup.aliens);
+            } catch (const std::exception& failure) {
+                // Only a request that failed when captured may fail again.
+                if (entry.outcome != WorkloadOutcome::Error) {
+                    throw;
+                }
+                error = failure.what();
+            }
+            double elapsed =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+            best = run == 0 ? elapsed : std::min(best, elapsed);
+            stats = simulator.lastStats();
+        }
+        bool finished = entry.outcome == WorkloadOutcome::Ok;
+        double delta = finished ? difference(summary, entry.summary) : 0.0;
+        bool matches = delta <= options.tolerance;
+        mismatches += matches ? 0 : 1;
+        double speedup = entry.milliseconds / std::max(best, 1e-3);
+        if (finished) {
+            recordedTotal += entry.milliseconds;
+            replayedTotal += best;
+            logSpeedup += std::log(std::max(speedup, 1e-9));
+            ++compared;
+        }
+
+        if (!options.quiet || !matches) {
+            char line[256];
+            if (finished) {
+                std::snprintf(line, sizeof(line), "#%zu %s  %.3f ms -> %.3f ms (x%.2f)  states %llu -> %llu", index,
+                              matches ? "ok" : "MISMATCH", entry.milliseconds, best, speedup,
+                              static_cast<unsigned long long>(entry.stats.statesExpanded),
+                              static_cast<unsigned long long>(stats.statesExpanded));
+            } else {
+                std::snprintf(line, sizeof(line), "#%zu %s  stopped after %.3f ms, replayed %.3f ms  states %llu -> %llu",
+                              index, entry.outcome == WorkloadOutcome::Cancelled ? "cancelled" : "error",
+                              entry.milliseconds, best, static_cast<unsigned long long>(entry.stats.statesExpanded),
+                              static_cast<unsigned long long>(stats.statesExpanded));
+            }
+            std::cout << line;
+            if (!error.empty()) {
+                std::cout << "  (" << error << ")";
+            }
+            if (!matches) {
+                std::cout << "  max delta " << delta << "\n    " << formatMatchup(entry.matchup);
+            }
+            std::cout << "\n";
+        }
+        ++index;
+    }
+
+    std::size_t count = workload.entries.size();
+    std::cout << count << " requests (" << count - compared << " cancelled or failed), " << mismatches
+              << " mismatches; recorded " << recordedTotal << " ms, replayed " << replayedTotal << " ms";
+    if (compared > 0) {
+        std::cout << " (geometric mean speedup x" << std::exp(logSpeedup / static_cast<double>(compared)) << ")";
+    }
+    std::cout << "\n";
+    return mismatches == 0 ? 0 : 1;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+    try {
+        Options options;
+        options.log = argv[1];
+        for (int i = 2; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--quiet") {
+                options.quiet = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--repeat") {
+                options.repeat = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--tolerance") {
+                options.tolerance = std::stod(value);
+            } else if (arg == "--solution-store") {
+                options.store = SolutionStore::open(value);
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        return run(options);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,132 @@
+// Cost of retreat-aware solving on representative fleets.
+//
+//   eclipse_retreat_bench [--ships N] [--threshold X] [--escape-value X]
+//                         [--repeat N] [--catalog file]
+//
+// Every faction's line-up of up to N ships (cycling through its valid default
+// designs) fights every other faction's. Each
+// matchup is solved without retreats and then with threshold and optimal
+// policies for either side; the tool prints the total time and states
+// expanded per policy pair relative to the no-retreat solve.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/tech_catalog.hpp"
+#include "line_up.hpp"
+
+using namespace eclipse;
+
+namespace {
+struct Options {
+    int ships = 3;
+    double threshold = 0.25;
+    double escapeValue = 0.5;
+    int repeat = 3;
+};
+
+struct PolicyPair {
+    const char* name;
+    RetreatPolicy humans;
+    RetreatPolicy aliens;
+};
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--ships N] [--threshold X] [--escape-value X] [--repeat N] [--catalog file]\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--ships") {
+                options.ships = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--threshold") {
+                options.threshold = std::stod(value);
+            } else if (arg == "--escape-value") {
+                options.escapeValue = std::stod(value);
+            } else if (arg == "--repeat") {
+                options.repeat = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+
+    RetreatPolicy never;
+    RetreatPolicy threshold{RetreatRule::Threshold, options.threshold, options.escapeValue};
+    RetreatPolicy optimal{RetreatRule::Optimal, options.threshold, options.escapeValue};
+    const std::array<PolicyPair, 5> pairs{{
+        {"never", never, never},
+        {"threshold/never", threshold, never},
+        {"optimal/never", optimal, never},
+        {"never/optimal", never, optimal},
+        {"optimal/optimal", optimal, optimal},
+    }};
+    const Faction factions[] = {Faction::Human, Faction::Eridani, Faction::Planta, Faction::Orion};
+
+    std::array<double, pairs.size()> milliseconds{};
+    std::array<std::uint64_t, pairs.size()> states{};
+    std::array<double, pairs.size()> humanValue{};
+    int matchups = 0;
+    for (Faction attacker : factions) {
+        for (Faction defender : factions) {
+            if (attacker == defender) {
+                continue;
+            }
+            std::vector<ShipLoadout> humans = lineUp(attacker, options.ships);
+            std::vector<ShipLoadout> aliens = lineUp(defender, options.ships);
+            if (humans.empty() || aliens.empty()) {
+                continue;
+            }
+            ++matchups;
+            for (size_t p = 0; p < pairs.size(); ++p) {
+                double best = 0.0;
+                RetreatSummary summary;
+                BattleSimulator simulator;
+                for (int run = 0; run < options.repeat; ++run) {
+                    auto started = std::chrono::steady_clock::now();
+                    summary = simulator.simulate(humans, aliens, pairs[p].humans, pairs[p].aliens);
+                    double elapsed =
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+                    best = run == 0 ? elapsed : std::min(best, elapsed);
+                }
+                milliseconds[p] += best;
+                states[p] += simulator.lastStats().statesExpanded;
+                humanValue[p] += summary.humanWin + summary.alienRetreat + options.escapeValue * summary.humanRetreat;
+            }
+        }
+    }
+
+    std::cout << matchups << " matchups of up to " << options.ships << " ships per side\n";
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        char line[160];
+        std::snprintf(line, sizeof(line), "%-16s %9.2f ms  x%5.2f  %9llu states  human value %.4f", pairs[p].name,
+                      milliseconds[p], milliseconds[p] / std::max(milliseconds[0], 1e-6),
+                      static_cast<unsigned long long>(states[p]), humanValue[p] / matchups);
+        std::cout << line << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// Ranks every single-slot change to one fleet by how much it moves the odds.
+//
+//   eclipse_sensitivity [--matchup "<fleet> vs <fleet>"] [--side humans|aliens]
+//                       [--top N] [--all] [--threads N] [--catalog file]
+//
+// Prints the baseline win chances, then the --top best and worst changes to the
+// chosen side's fleet with their win-chance deltas (--all prints every one), and
+// how many distinct variant battles were solved and how long it took. Changes
+// that would leave a ship invalid are skipped unless --all is given.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/fleet_codec.hpp"
+#include "game/slot_sensitivity.hpp"
+#include "game/tech_catalog.hpp"
+
+using namespace eclipse;
+
+namespace {
+constexpr const char* kDefaultMatchup = "HUM_CRU HUM_INT HUM_INT vs ORI_CRU ORI_INT";
+
+struct Options {
+    std::string matchup = kDefaultMatchup;
+    std::size_t top = 10;
+    bool all = false;
+    SensitivityOptions sensitivity;
+};
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--matchup \"<fleet> vs <fleet>\"] [--side humans|aliens] [--top N] [--all] [--threads N]"
+                 " [--catalog file]\n";
+}
+
+void printChange(const SlotChange& change) {
+    std::printf("  %+7.2f%%  ship %zu slot %zu: %s -> %s\n", change.delta * 100.0, change.ship, change.slot,
+                change.before ? std::string(change.before->id).c_str() : "(blueprint)",
+                change.after ? std::string(change.after->id).c_str() : "(blueprint)");
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    Matchup matchup;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--all") {
+                options.all = true;
+                options.sensitivity.requireValid = false;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--matchup") {
+                options.matchup = value;
+            } else if (arg == "--side" && (value == "humans" || value == "aliens")) {
+                options.sensitivity.side = value == "humans" ? BattleSide::Humans : BattleSide::Aliens;
+            } else if (arg == "--top") {
+                options.top = static_cast<std::size_t>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--threads") {
+                options.sensitivity.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        matchup = parseMatchup(options.matchup);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    SensitivityReport report;
+    try {
+        report = slotSensitivity(matchup.humans, matchup.aliens, options.sensitivity);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    std::printf("%s\nbaseline: human %.4f  alien %.4f  draw %.4f\n", formatMatchup(matchup).c_str(),
+                report.baseline.humanWin, report.baseline.alienWin, report.baseline.draw);
+    const std::vector<SlotChange>& changes = report.changes;
+    if (options.all || changes.size() <= 2 * options.top) {
+        for (const SlotChange& change : changes) {
+            printChange(change);
+        }
+    } else {
+        std::printf("best:\n");
+        for (std::size_t i = 0; i < options.top; ++i) {
+            printChange(changes[i]);
+        }
+        std::printf("worst:\n");
+        for (std::size_t i = changes.size() - options.top; i < changes.size(); ++i) {
+            printChange(changes[i]);
+        }
+    }
+    std::printf("%zu changes, %zu distinct battles solved in %.1f ms\n", changes.size(), report.solved, elapsed);
+    return 0;
+}
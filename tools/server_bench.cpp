@@ -0,0 +1,277 @@
+// Throughput benchmark for eclipse_server.
+//
+//   eclipse_server_bench [--unix path | --tcp port] [--connections N] [--requests N]
+//                        [--window N] [--distinct N] [--max-ships N] [--deadline-ms N]
+//                        [--seed N]
+//
+// Builds --distinct random matchups of default designs, then drives the server
+// from --connections client threads, each keeping up to --window requests in
+// flight, until --requests have been answered. Reports throughput, latency
+// percentiles and the server's own counters.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "game/tech_catalog.hpp"
+#include "server/protocol.hpp"
+
+using namespace eclipse;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string unixPath = "/tmp/eclipse_sim.sock";
+    int tcpPort = 0;
+    int connections = 16;
+    int requests = 10000;
+    int window = 32;
+    int distinct = 500;
+    int maxShips = 3;
+    std::uint32_t deadlineMs = 0;
+    unsigned seed = 1;
+};
+
+int connectTo(const Options& options) {
+    int fd = -1;
+    if (options.tcpPort > 0) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(options.tcpPort));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+    } else {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, options.unixPath.c_str(), sizeof(address.sun_path) - 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+    }
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    throw std::runtime_error(std::string("cannot connect: ") + std::strerror(errno));
+}
+
+void sendAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t count = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (count <= 0) {
+            throw std::runtime_error("connection lost while sending");
+        }
+        data.remove_prefix(static_cast<size_t>(count));
+    }
+}
+
+std::vector<ShipLoadout> randomFleet(Faction faction, int maxShips, std::mt19937& random) {
+    auto designs = TechCatalog::factionDesigns(faction);
+    std::uniform_int_distribution<int> size(1, maxShips);
+    std::uniform_int_distribution<size_t> pick(0, designs.size() - 1);
+    std::vector<ShipLoadout> fleet;
+    int target = size(random);
+    int starbases = 0;
+    while (static_cast<int>(fleet.size()) < target) {
+        const ShipDesign* design = designs[pick(random)];
+        if (design->shipClass == ShipClass::Starbase && starbases++ > 0) {
+            continue;
+        }
+        fleet.emplace_back(design);
+    }
+    return fleet;
+}
+
+std::vector<std::string> buildMatchups(const Options& options) {
+    std::mt19937 random(options.seed);
+    const Faction factions[] = {Faction::Human, Faction::Eridani, Faction::Planta, Faction::Orion};
+    std::uniform_int_distribution<int> faction(0, 3);
+    std::vector<std::string> lines;
+    for (int i = 0; i < options.distinct; ++i) {
+        auto humans = randomFleet(factions[faction(random)], options.maxShips, random);
+        auto aliens = randomFleet(factions[faction(random)], options.maxShips, random);
+        std::string line = protocol::formatSolveRequest("", options.deadlineMs, humans, aliens);
+        lines.push_back(line.substr(1));  // drop the empty id; each send prefixes its own
+    }
+    return lines;
+}
+
+struct Tally {
+    std::mutex mutex;
+    std::vector<double> latencies;
+    std::size_t ok = 0;
+    std::size_t timeouts = 0;
+    std::size_t errors = 0;
+};
+
+void runClient(const Options& options, const std::vector<std::string>& matchups, int quota, unsigned seed,
+               Tally& tally) {
+    int fd = connectTo(options);
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<size_t> pick(0, matchups.size() - 1);
+    std::vector<Clock::time_point> sentAt(static_cast<size_t>(quota));
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(quota));
+    std::size_t ok = 0;
+    std::size_t timeouts = 0;
+    std::size_t errors = 0;
+    int sent = 0;
+    int received = 0;
+    std::string buffer;
+    char chunk[16384];
+    while (received < quota) {
+        std::string batch;
+        while (sent < quota && sent - received < options.window) {
+            sentAt[static_cast<size_t>(sent)] = Clock::now();
+            batch += std::to_string(sent) + " " + matchups[pick(random)];
+            ++sent;
+        }
+        if (!batch.empty()) {
+            sendAll(fd, batch);
+        }
+        ssize_t count = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0) {
+            ::close(fd);
+            throw std::runtime_error("connection closed by server");
+        }
+        buffer.append(chunk, static_cast<size_t>(count));
+        size_t start = 0;
+        for (size_t end = buffer.find('\n'); end != std::string::npos; end = buffer.find('\n', start)) {
+            std::string_view line(buffer.data() + start, end - start);
+            start = end + 1;
+            size_t space = line.find(' ');
+            int id = std::atoi(std::string(line.substr(0, space)).c_str());
+            std::string_view status = line.substr(space + 1, 2);
+            if (status == "ok") {
+                ++ok;
+            } else if (status == "ti") {
+                ++timeouts;
+            } else {
+                ++errors;
+            }
+            if (id >= 0 && id < quota) {
+                latencies.push_back(
+                    std::chrono::duration<double, std::milli>(Clock::now() - sentAt[static_cast<size_t>(id)]).count());
+            }
+            ++received;
+        }
+        buffer.erase(0, start);
+    }
+    ::close(fd);
+    std::lock_guard<std::mutex> lock(tally.mutex);
+    tally.latencies.insert(tally.latencies.end(), latencies.begin(), latencies.end());
+    tally.ok += ok;
+    tally.timeouts += timeouts;
+    tally.errors += errors;
+}
+
+std::string serverStats(const Options& options) {
+    int fd = connectTo(options);
+    sendAll(fd, "bench stats\n");
+    std::string reply;
+    char chunk[1024];
+    while (reply.find('\n') == std::string::npos) {
+        ssize_t count = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0) {
+            break;
+        }
+        reply.append(chunk, static_cast<size_t>(count));
+    }
+    ::close(fd);
+    return reply;
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--unix") {
+            options.unixPath = value;
+        } else if (arg == "--tcp") {
+            options.tcpPort = std::atoi(value.c_str());
+        } else if (arg == "--connections") {
+            options.connections = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--requests") {
+            options.requests = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--window") {
+            options.window = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--distinct") {
+            options.distinct = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--max-ships") {
+            options.maxShips = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--deadline-ms") {
+            options.deadlineMs = static_cast<std::uint32_t>(std::max(0, std::atoi(value.c_str())));
+        } else if (arg == "--seed") {
+            options.seed = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else {
+            std::cerr << "unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+
+    try {
+        std::vector<std::string> matchups = buildMatchups(options);
+        Tally tally;
+        std::vector<std::thread> clients;
+        std::atomic<bool> failed{false};
+        auto started = Clock::now();
+        for (int c = 0; c < options.connections; ++c) {
+            int quota = options.requests / options.connections + (c < options.requests % options.connections ? 1 : 0);
+            clients.emplace_back([&, quota, c] {
+                try {
+                    runClient(options, matchups, quota, options.seed * 7919u + static_cast<unsigned>(c), tally);
+                } catch (const std::exception& error) {
+                    std::cerr << "client " << c << ": " << error.what() << "\n";
+                    failed = true;
+                }
+            });
+        }
+        for (std::thread& client : clients) {
+            client.join();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+        std::sort(tally.latencies.begin(), tally.latencies.end());
+
+        std::cout << tally.latencies.size() << " responses in " << seconds << " s: "
+                  << static_cast<double>(tally.latencies.size()) / seconds << " req/s\n"
+                  << "  ok " << tally.ok << ", timeout " << tally.timeouts << ", error " << tally.errors << "\n"
+                  << "  latency ms p50 " << percentile(tally.latencies, 0.50) << "  p90 "
+                  << percentile(tally.latencies, 0.90) << "  p99 " << percentile(tally.latencies, 0.99) << "  max "
+                  << percentile(tally.latencies, 1.0) << "\n"
+                  << "  server: " << serverStats(options);
+        return failed ? 1 : 0;
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+}
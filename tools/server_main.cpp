@@ -0,0 +1,96 @@
+// Local simulation server; see include/server/protocol.hpp for the wire format.
+//
+//   eclipse_server [--unix path] [--tcp port] [--threads N] [--deadline-ms N]
+//                  [--cache-entries N] [--solution-store file] [--catalog file]
+//
+// Listens on /tmp/eclipse_sim.sock when neither --unix nor --tcp is given.
+// SIGINT/SIGTERM shut the server down after in-flight solves are cancelled.
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "game/solution_store.hpp"
+#include "game/tech_catalog.hpp"
+#include "server/simulation_server.hpp"
+
+using namespace eclipse;
+
+namespace {
+SimulationServer* activeServer = nullptr;
+
+void handleSignal(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--unix path] [--tcp port] [--threads N] [--deadline-ms N] [--cache-entries N]"
+                 " [--solution-store file] [--catalog file]\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    ServerOptions options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--unix") {
+                options.unixPath = value;
+            } else if (arg == "--tcp") {
+                options.tcpPort = std::atoi(value.c_str());
+            } else if (arg == "--threads") {
+                options.threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--deadline-ms") {
+                options.defaultDeadline = std::chrono::milliseconds(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--cache-entries") {
+                options.cacheCapacity = std::stoull(value);
+            } else if (arg == "--solution-store") {
+                options.store = SolutionStore::open(value);
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        if (options.unixPath.empty() && options.tcpPort == 0) {
+            options.unixPath = "/tmp/eclipse_sim.sock";
+        }
+
+        SimulationServer server(options);
+        server.listen();
+        activeServer = &server;
+        std::signal(SIGINT, handleSignal);
+        std::signal(SIGTERM, handleSignal);
+        std::cout << "listening";
+        if (!options.unixPath.empty()) {
+            std::cout << " on " << options.unixPath;
+        }
+        if (server.tcpPort() > 0) {
+            std::cout << " on 127.0.0.1:" << server.tcpPort();
+        }
+        std::cout << std::endl;
+        server.run();
+        activeServer = nullptr;
+
+        ServerStats stats = server.stats();
+        std::cout << stats.requests << " requests, " << stats.cacheHits << " cache hits, " << stats.coalesced
+                  << " coalesced, " << stats.solved << " solved, " << stats.timeouts << " timeouts\n";
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
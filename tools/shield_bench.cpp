@@ -0,0 +1,130 @@
+// Cost and effect of per-target shields against the averaged approximation.
+//
+//   eclipse_shield_bench [--matchups file] [--repeat N] [--catalog file]
+//
+// Solves every matchup with ShieldModel::Averaged and ShieldModel::PerTarget
+// (best of --repeat runs each) and prints both timings and state counts, the
+// slowdown, and how far the averaged win chances are off. Without --matchups
+// a built-in set is used: fleets mixing shield values, where the models
+// differ, and uniform fleets, where per-target solving must cost nothing
+// extra. --matchups takes a saved matchup file in either fleet_codec format.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/battle_simulator.hpp"
+#include "game/fleet_codec.hpp"
+#include "game/tech_catalog.hpp"
+
+using namespace eclipse;
+
+namespace {
+const char* const kBuiltinMatchups[] = {
+    "HUM_CRU HUM_INT[3=GAUSS_SHIELD] HUM_INT[3=GAUSS_SHIELD] vs ORI_CRU ORI_CRU ORI_INT",
+    "ORI_CRU ORI_INT[3=GAUSS_SHIELD] ORI_INT vs HUM_CRU HUM_CRU HUM_INT[3=GAUSS_SHIELD]",
+    "ORI_DRE ORI_CRU ORI_INT[3=GAUSS_SHIELD] ORI_INT[3=GAUSS_SHIELD] vs HUM_CRU HUM_CRU HUM_INT[3=GAUSS_SHIELD] HUM_INT",
+    "ERI_CRU ERI_CRU ERI_INT[3=GAUSS_SHIELD] ERI_INT vs ORI_DRE ORI_INT[3=GAUSS_SHIELD] ORI_INT",
+    "HUM_CRU HUM_INT vs ORI_CRU ORI_INT",
+    "HUM_CRU HUM_CRU HUM_INT HUM_INT vs ERI_CRU ERI_CRU ERI_INT ERI_INT",
+    "ORI_DRE ORI_CRU ORI_INT ORI_INT vs HUM_CRU HUM_CRU HUM_INT HUM_INT",
+};
+
+struct Options {
+    std::string matchups;
+    int repeat = 3;
+};
+
+struct Timed {
+    BattleSummary summary;
+    SolveStats stats;
+    double milliseconds = 0.0;
+};
+
+Timed solve(const Matchup& matchup, ShieldModel model, int repeat) {
+    Timed timed;
+    for (int run = 0; run < repeat; ++run) {
+        BattleSimulator simulator;
+        simulator.setShieldModel(model);
+        auto started = std::chrono::steady_clock::now();
+        timed.summary = simulator.simulate(matchup.humans, matchup.aliens);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        timed.milliseconds = run == 0 ? elapsed : std::min(timed.milliseconds, elapsed);
+        timed.stats = simulator.lastStats();
+    }
+    return timed;
+}
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program << " [--matchups file] [--repeat N] [--catalog file]\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<Matchup> matchups;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--matchups") {
+                options.matchups = value;
+            } else if (arg == "--repeat") {
+                options.repeat = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        if (options.matchups.empty()) {
+            for (const char* text : kBuiltinMatchups) {
+                matchups.push_back(parseMatchup(text));
+            }
+        } else {
+            matchups = loadMatchups(options.matchups);
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+
+    double averagedTotal = 0.0;
+    double perTargetTotal = 0.0;
+    double worstError = 0.0;
+    for (size_t i = 0; i < matchups.size(); ++i) {
+        Timed averaged = solve(matchups[i], ShieldModel::Averaged, options.repeat);
+        Timed perTarget = solve(matchups[i], ShieldModel::PerTarget, options.repeat);
+        averagedTotal += averaged.milliseconds;
+        perTargetTotal += perTarget.milliseconds;
+        double error = std::max(std::abs(averaged.summary.humanWin - perTarget.summary.humanWin),
+                                std::abs(averaged.summary.alienWin - perTarget.summary.alienWin));
+        worstError = std::max(worstError, error);
+
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "#%zu averaged %8.2f ms %6llu states | per-target %8.2f ms %6llu states | x%5.2f  "
+                      "human %.4f -> %.4f (off by %.4f)",
+                      i, averaged.milliseconds, static_cast<unsigned long long>(averaged.stats.statesExpanded),
+                      perTarget.milliseconds, static_cast<unsigned long long>(perTarget.stats.statesExpanded),
+                      perTarget.milliseconds / std::max(averaged.milliseconds, 1e-3), averaged.summary.humanWin,
+                      perTarget.summary.humanWin, error);
+        std::cout << line << "\n    " << formatMatchup(matchups[i]) << "\n";
+    }
+    std::cout << matchups.size() << " matchups: averaged " << averagedTotal << " ms, per-target " << perTargetTotal
+              << " ms (x" << perTargetTotal / std::max(averagedTotal, 1e-3) << "), largest win-chance error "
+              << worstError << "\n";
+    return 0;
+}
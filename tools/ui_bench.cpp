@@ -0,0 +1,388 @@
+// Headless frame-time benchmark of the fleet builder UI.
+//
+//   eclipse_ui_bench [--script file] [--loops N] [--ships N] [--size WxH]
+//                    [--screenshot file.bmp] [--hud] [--catalog file]
+//
+// Renders with SDL's software renderer into an offscreen surface (the dummy
+// video driver, so no display is needed) while replaying a script of
+// interactions. Every event is handed to the UI and, if it changed anything,
+// a frame is drawn and presented; the tool reports frame-time percentiles,
+// event-handling time (which includes simulations, solved inline) and draw
+// calls per frame. --hud draws every frame with the performance overlay up, to
+// measure what leaving it on costs.
+//
+// Script lines, with sides "human" or "alien" and zero-based indices:
+//   drag <palette entry> <side> <ship> <slot> [steps]   palette to slot, with mouse motion
+//   cycle <side> <ship> <+1|-1>                          design arrows
+//   toggle <side> <ship>
+//   remove <side> <ship> <slot>                          right click
+//   category <index>                                     open the dropdown and pick
+//   move <steps>                                         mouse motion with nothing dragged
+//   simulate
+//   matrix                                               M: show or hide the matchup matrix
+//   values                                               V: rank modules and tint the palette
+// Blank lines and lines starting with '#' are ignored.
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "game/tech_catalog.hpp"
+#include "render/bitmap_font.hpp"
+#include "ui/fleet_builder.hpp"
+
+using namespace eclipse;
+
+namespace {
+constexpr const char* kDefaultScript = R"(# A short editing session: install, swap and remove modules, change designs
+# and run a simulation.
+drag 0 human 0 0
+drag 1 human 1 2
+cycle human 2 +1
+cycle human 2 -1
+toggle alien 1
+toggle alien 1
+move 12
+category 1
+drag 0 alien 0 1
+category 0
+drag 2 alien 1 0
+remove human 0 0
+# The default Terran dreadnought is short on energy; bench it for the solve.
+toggle human 2
+simulate
+toggle human 2
+)";
+
+struct Options {
+    std::string script;
+    int loops = 20;
+    std::size_t ships = 3;
+    int width = 1280;
+    int height = 720;
+    std::string screenshot;
+    bool hud = false;
+};
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--script file] [--loops N] [--ships N] [--size WxH] [--screenshot file.bmp] [--hud]"
+                 " [--catalog file]\n";
+}
+
+struct Recorder {
+    FleetBuilder& builder;
+    SDL_Renderer* renderer;
+    std::vector<double> frames;
+    std::vector<double> events;
+    std::vector<int> drawCalls;
+    int simulations = 0;  // simulate lines that produced a result
+
+    void send(const SDL_Event& event) {
+        auto started = std::chrono::steady_clock::now();
+        builder.handleEvent(event);
+        auto handled = std::chrono::steady_clock::now();
+        events.push_back(std::chrono::duration<double, std::milli>(handled - started).count());
+        if (builder.needsRedraw()) {
+            builder.render(renderer);
+            SDL_RenderPresent(renderer);
+            frames.push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - handled).count());
+            drawCalls.push_back(builder.lastDrawCalls());
+        }
+    }
+
+    void button(Uint32 type, Uint8 which, SDL_Point at) {
+        SDL_Event event{};
+        event.type = type;
+        event.button.button = which;
+        event.button.x = at.x;
+        event.button.y = at.y;
+        send(event);
+    }
+
+    void key(SDL_Keycode sym) {
+        SDL_Event event{};
+        event.type = SDL_KEYDOWN;
+        event.key.keysym.sym = sym;
+        send(event);
+    }
+
+    void click(SDL_Point at, Uint8 which = SDL_BUTTON_LEFT) {
+        button(SDL_MOUSEBUTTONDOWN, which, at);
+        button(SDL_MOUSEBUTTONUP, which, at);
+    }
+
+    void motion(SDL_Point from, SDL_Point to, int steps) {
+        for (int step = 1; step <= steps; ++step) {
+            SDL_Event event{};
+            event.type = SDL_MOUSEMOTION;
+            event.motion.x = from.x + (to.x - from.x) * step / steps;
+            event.motion.y = from.y + (to.y - from.y) * step / steps;
+            send(event);
+        }
+    }
+};
+
+FleetSide parseSide(const std::string& text) {
+    if (text == "human") {
+        return FleetSide::Human;
+    }
+    if (text == "alien") {
+        return FleetSide::Alien;
+    }
+    throw std::runtime_error("expected 'human' or 'alien', got '" + text + "'");
+}
+
+SDL_Point require(std::optional<SDL_Point> point, const char* what) {
+    if (!point) {
+        throw std::runtime_error(std::string(what) + " is out of range");
+    }
+    return *point;
+}
+
+// Runs one script line. Targets are resolved against the current layout, so a
+// line that names a missing slot fails rather than clicking empty space.
+void runLine(Recorder& recorder, const std::string& line) {
+    std::istringstream in(line);
+    std::string command;
+    in >> command;
+    FleetBuilder& builder = recorder.builder;
+    if (command == "drag") {
+        std::size_t entry = 0, ship = 0, slot = 0;
+        std::string side;
+        int steps = 8;
+        in >> entry >> side >> ship >> slot;
+        if (!in) {
+            throw std::runtime_error("usage: drag <palette entry> <side> <ship> <slot> [steps]");
+        }
+        if (!(in >> steps)) {
+            steps = 8;
+        }
+        SDL_Point from = require(builder.paletteCenter(entry), "palette entry");
+        SDL_Point to = require(builder.slotCenter(parseSide(side), ship, slot), "slot");
+        recorder.button(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_LEFT, from);
+        recorder.motion(from, to, std::max(1, steps));
+        recorder.button(SDL_MOUSEBUTTONUP, SDL_BUTTON_LEFT, to);
+    } else if (command == "cycle") {
+        std::string side;
+        std::size_t ship = 0;
+        int delta = 0;
+        in >> side >> ship >> delta;
+        if (!in || delta == 0) {
+            throw std::runtime_error("usage: cycle <side> <ship> <+1|-1>");
+        }
+        recorder.click(require(builder.arrowCenter(parseSide(side), ship, delta), "ship"));
+    } else if (command == "toggle") {
+        std::string side;
+        std::size_t ship = 0;
+        in >> side >> ship;
+        if (!in) {
+            throw std::runtime_error("usage: toggle <side> <ship>");
+        }
+        recorder.click(require(builder.toggleCenter(parseSide(side), ship), "ship"));
+    } else if (command == "remove") {
+        std::string side;
+        std::size_t ship = 0, slot = 0;
+        in >> side >> ship >> slot;
+        if (!in) {
+            throw std::runtime_error("usage: remove <side> <ship> <slot>");
+        }
+        recorder.click(require(builder.slotCenter(parseSide(side), ship, slot), "slot"), SDL_BUTTON_RIGHT);
+    } else if (command == "category") {
+        std::size_t index = 0;
+        in >> index;
+        if (!in) {
+            throw std::runtime_error("usage: category <index>");
+        }
+        recorder.click(builder.dropdownCenter());
+        recorder.click(require(builder.categoryCenter(index), "category"));
+    } else if (command == "move") {
+        int steps = 0;
+        in >> steps;
+        if (!in) {
+            throw std::runtime_error("usage: move <steps>");
+        }
+        recorder.motion({0, 0}, builder.simulateCenter(), std::max(1, steps));
+    } else if (command == "simulate") {
+        recorder.click(builder.simulateCenter());
+        recorder.simulations += builder.summaryReady() ? 1 : 0;
+    } else if (command == "matrix") {
+        recorder.key(SDLK_m);
+    } else if (command == "values") {
+        recorder.key(SDLK_v);
+    } else {
+        throw std::runtime_error("unknown command '" + command + "'");
+    }
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(values.size())));
+    return values[std::clamp<std::size_t>(rank, 1, values.size()) - 1];
+}
+
+std::string summarize(const std::vector<double>& values) {
+    char line[160];
+    std::snprintf(line, sizeof(line), "p50 %.3f  p90 %.3f  p99 %.3f  max %.3f ms", percentile(values, 0.50),
+                  percentile(values, 0.90), percentile(values, 0.99), percentile(values, 1.0));
+    return line;
+}
+
+int run(const Options& options, const std::vector<std::string>& script) {
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        throw std::runtime_error(std::string("Failed to init SDL: ") + SDL_GetError());
+    }
+    SDL_Surface* surface =
+        SDL_CreateRGBSurfaceWithFormat(0, options.width, options.height, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer) {
+        std::string error = SDL_GetError();
+        if (surface) {
+            SDL_FreeSurface(surface);
+        }
+        SDL_Quit();
+        throw std::runtime_error("Failed to create software renderer: " + error);
+    }
+
+    FleetBuilderOptions builderOptions;
+    builderOptions.shipsPerSide = options.ships;
+    builderOptions.backgroundSolves = false;
+    int status = 0;
+    {
+        FleetBuilder builder(std::move(builderOptions));
+        builder.setHudVisible(options.hud);
+        Recorder recorder{builder, renderer, {}, {}, {}, 0};
+        builder.render(renderer);
+        SDL_RenderPresent(renderer);
+        try {
+            for (int loop = 0; loop < options.loops; ++loop) {
+                for (std::size_t i = 0; i < script.size(); ++i) {
+                    if (script[i].empty()) {
+                        continue;
+                    }
+                    try {
+                        runLine(recorder, script[i]);
+                    } catch (const std::exception& error) {
+                        throw std::runtime_error("script line " + std::to_string(i + 1) + ": " + error.what());
+                    }
+                }
+            }
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << "\n";
+            status = 1;
+        }
+
+        if (status == 0) {
+            double drawCallTotal = 0.0;
+            for (int calls : recorder.drawCalls) {
+                drawCallTotal += calls;
+            }
+            int drawCallMax = recorder.drawCalls.empty()
+                                  ? 0
+                                  : *std::max_element(recorder.drawCalls.begin(), recorder.drawCalls.end());
+            std::cout << recorder.frames.size() << " frames from " << recorder.events.size() << " events over "
+                      << options.loops << " loops, " << options.ships << " ships per side, " << options.width
+                      << "x" << options.height << " software renderer" << (options.hud ? ", overlay on" : "") << "\n";
+            std::cout << "frame  " << summarize(recorder.frames) << "\n";
+            std::cout << "event  " << summarize(recorder.events) << "\n";
+            char line[120];
+            std::snprintf(line, sizeof(line), "draw calls per frame: mean %.2f  max %d",
+                          recorder.drawCalls.empty() ? 0.0 : drawCallTotal / recorder.drawCalls.size(),
+                          drawCallMax);
+            std::cout << line << "\n";
+            std::cout << recorder.simulations << " simulations completed\n";
+            if (!options.screenshot.empty() && SDL_SaveBMP(surface, options.screenshot.c_str()) != 0) {
+                std::cerr << "Failed to write " << options.screenshot << ": " << SDL_GetError() << "\n";
+                status = 1;
+            }
+        }
+    }
+
+    BitmapFont::instance().releaseAtlas();
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    SDL_Quit();
+    return status;
+}
+
+// Comments and blank lines become empty entries so that errors can report
+// the line number in the file.
+std::vector<std::string> scriptLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            line.clear();
+        }
+        lines.push_back(line);
+    }
+    return lines;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg == "--hud") {
+                options.hud = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 2;
+            }
+            std::string value = argv[++i];
+            if (arg == "--script") {
+                std::ifstream in(value);
+                if (!in) {
+                    throw std::runtime_error("Cannot open script '" + value + "'");
+                }
+                std::ostringstream text;
+                text << in.rdbuf();
+                options.script = text.str();
+            } else if (arg == "--loops") {
+                options.loops = std::max(1, std::atoi(value.c_str()));
+            } else if (arg == "--ships") {
+                options.ships = static_cast<std::size_t>(std::max(1, std::atoi(value.c_str())));
+            } else if (arg == "--size") {
+                if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2 ||
+                    options.width <= 0 || options.height <= 0) {
+                    usage(argv[0]);
+                    return 2;
+                }
+            } else if (arg == "--screenshot") {
+                options.screenshot = value;
+            } else if (arg == "--catalog") {
+                TechCatalog::loadFromFile(value);
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        return run(options, scriptLines(options.script.empty() ? kDefaultScript : options.script));
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+}